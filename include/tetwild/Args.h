@@ -68,9 +68,29 @@ struct Args {
     // Maximum number of mesh optimization iterations
     int max_num_passes = 80;
 
+    // Renumber the vertices and tets along a Hilbert curve between two passes, once the fraction of tet slots
+    // that are free or have been reassigned since the last renumbering exceeds this threshold (<= 0 to disable)
+    double reorder_thres = 0.5;
+
     // Sample points at voxel centers for initial Delaunay triangulation
     bool not_use_voxel_stuffing = false;
 
+    // Traverse the wide layout of the envelope AABB trees (4 children per node, boxes tested at once)
+    // instead of the binary one, see GEO::MeshFacetsAABBWithEps::set_wide_layout()
+    bool use_wide_envelope_tree = false;
+
+    // Test the faces against the union of prisms around the input facets with exact predicates
+    // instead of sampling them, see PrismEnvelope
+    bool use_exact_envelope = false;
+
+    // Answer most envelope point queries from a sparse voxel grid over the band of the input surface,
+    // built during the preprocessing, before falling back to the AABB tree, see EnvelopeGrid
+    bool use_envelope_grid = false;
+
+    // Decide most of the energy checks of the collapses and swaps from float bounds of the energies,
+    // the energies in double are only computed when the bounds cannot decide, see AMIPSScreenBatch
+    bool use_energy_screening = false;
+
     // Use Laplacian smoothing on the faces/vertices covering an open boundary after the mesh optimization step (post-processing)
     bool smooth_open_boundary = false;
 
@@ -86,6 +106,8 @@ struct Args {
     std::string postfix = "_";
     std::string csv_file = "";
     int save_mid_result = -1; // save intermediate result
+    bool benchmark_envelope_tree = false; // time the envelope queries on both layouts of the input surface tree
+    bool validate_energy_cache = false; // recompute the energies of the unchanged tets too, and count the cached ones that differ
 
     bool is_quiet = false;
 };
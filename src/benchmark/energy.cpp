@@ -0,0 +1,170 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+//usage: TetWild_bench_energy [n_tets] [n_rounds]
+//times the batched AMIPS energy of random tets with the orientation filter, with each kernel the cpu supports,
+//against the scalar path, then the float bounds of the energy screening
+
+#include <tetwild/AMIPSEnergy.h>
+#include <tetwild/CGALTypes.h>
+#include <igl/Timer.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#ifdef TETWILD_WITH_ISPC
+#include <ispc/energy.h>
+#endif
+
+using namespace tetwild;
+
+namespace {
+struct Result {
+    double time;
+    double max_rel_error;
+    double sum;//of the finite energies
+};
+
+Result run(const std::function<void()>& f, const std::vector<double>& E, const std::vector<double>& E_ref, int n_rounds) {
+    igl::Timer timer;
+    timer.start();
+    for (int r = 0; r < n_rounds; r++)
+        f();
+    Result res = {timer.getElapsedTime(), 0, 0};
+    for (size_t i = 0; i < E.size(); i++) {
+        if (std::isfinite(E[i]))
+            res.sum += E[i];
+        if (E[i] != E_ref[i])
+            res.max_rel_error = std::max(res.max_rel_error, std::abs(E[i] - E_ref[i]) / std::abs(E_ref[i]));
+    }
+    return res;
+}
+
+void print(const char* name, const Result& res, double ref_time) {
+    std::printf("%-8s %10.4fs  x%6.2f  max rel error %.3g  (sum %.17g)\n",
+                name, res.time, ref_time / res.time, res.max_rel_error, res.sum);
+}
+
+//the decided orientations have to be the ones of the exact predicate
+void printOrientations(const std::array<std::vector<double>, 12>& coords, const std::vector<double>& O) {
+    int n_failed = 0, n_wrong = 0;
+    for (size_t i = 0; i < O.size(); i++) {
+        if (O[i] == 0) {
+            n_failed++;
+            continue;
+        }
+        std::array<Point_3f, 4> ps;
+        for (int j = 0; j < 4; j++)
+            ps[j] = Point_3f(coords[j * 3][i], coords[j * 3 + 1][i], coords[j * 3 + 2][i]);
+        CGAL::Orientation ori = CGAL::orientation(ps[0], ps[1], ps[2], ps[3]);
+        if (ori != (O[i] > 0 ? CGAL::POSITIVE : CGAL::NEGATIVE))
+            n_wrong++;
+    }
+    std::printf("  orientation filter failed on %d tets, %d wrong\n", n_failed, n_wrong);
+}
+}
+
+int main(int argc, char* argv[]) {
+    const int n = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int n_rounds = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    //regular tets perturbed, scaled over a range of sizes as in a mesh being optimized, with a few degenerate ones
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> noise(-0.3, 0.3);
+    std::uniform_real_distribution<double> log_scale(-4, 1);
+    const std::array<double, 12> regular = {{0, 0, 0, 1, 0, 0, 0.5, std::sqrt(3) / 2, 0,
+                                             0.5, std::sqrt(3) / 6, std::sqrt(6) / 3}};
+    std::array<std::vector<double>, 12> coords;
+    for (int k = 0; k < 12; k++)
+        coords[k].resize(n);
+    for (int i = 0; i < n; i++) {
+        const double s = std::pow(10, log_scale(gen));
+        for (int k = 0; k < 12; k++)
+            coords[k][i] = 10 + s * (regular[k] + noise(gen));
+        if (i % 1000 == 0) {
+            for (int k = 9; k < 12; k++)
+                coords[k][i] = coords[k - 9][i];
+        }
+    }
+    std::array<const double*, 12> T;
+    for (int k = 0; k < 12; k++)
+        T[k] = coords[k].data();
+
+    std::printf("%d tets x %d rounds, cpu supports %s\n", n, n_rounds, getSimdLevelName(getSupportedSimdLevel()));
+    //with the orientation filter, as in LocalOperations::calTetQualities()
+    std::vector<double> E_ref(n), E(n), O(n);
+    setSimdLevel(SimdLevel::SCALAR);
+    Result ref = run([&]() { comformalAMIPSEnergy_batch(T.data(), E_ref.data(), O.data(), n); }, E_ref, E_ref,
+                     n_rounds);
+    print("scalar", ref, ref.time);
+    printOrientations(coords, O);
+
+    for (SimdLevel level: {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > getSupportedSimdLevel())
+            break;
+        setSimdLevel(level);
+        Result res = run([&]() { comformalAMIPSEnergy_batch(T.data(), E.data(), O.data(), n); }, E, E_ref, n_rounds);
+        print(getSimdLevelName(level), res, ref.time);
+        if (res.max_rel_error > AMIPS_SIMD_TOLERANCE)
+            std::printf("  above the tolerance %g\n", AMIPS_SIMD_TOLERANCE);
+        printOrientations(coords, O);
+    }
+
+    //the float screening of the same tets, whose bounds have to hold the cubes of the energies of the scalar path
+    AMIPSScreenBatch screen;
+    screen.resize(n);
+    std::array<double, 12> t;
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < 12; k++)
+            t[k] = coords[k][i];
+        screen.setTet(i, t.data());
+    }
+    for (SimdLevel level: {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > getSupportedSimdLevel())
+            break;
+        setSimdLevel(level);
+        igl::Timer timer;
+        timer.start();
+        for (int r = 0; r < n_rounds; r++)
+            screen.computeBounds();
+        const double time = timer.getElapsedTime();
+        int n_bounded = 0, n_wrong = 0;
+        for (int i = 0; i < n; i++) {
+            const double e = E_ref[i];
+            if (!std::isfinite(e) || e <= 0)//state.MAX_ENERGY in the mesh
+                continue;
+            if (std::isfinite(screen.upperCube(i)))
+                n_bounded++;
+            if (!(screen.lowerCube(i) <= e * e * e && e * e * e <= screen.upperCube(i)))
+                n_wrong++;
+        }
+        std::printf("%-8s %10.4fs  x%6.2f  float bounds, %d with an upper bound, %d wrong\n",
+                    getSimdLevelName(level), time, ref.time / time, n_bounded, n_wrong);
+    }
+    setSimdLevel(getSupportedSimdLevel());
+
+#ifdef TETWILD_WITH_ISPC
+    std::array<std::vector<double>, 12> ispc_coords = coords;//the ispc kernel takes non-const arrays
+    Result res = run([&]() {
+        ispc::energy_ispc(ispc_coords[0].data(), ispc_coords[1].data(), ispc_coords[2].data(), ispc_coords[3].data(),
+                          ispc_coords[4].data(), ispc_coords[5].data(), ispc_coords[6].data(), ispc_coords[7].data(),
+                          ispc_coords[8].data(), ispc_coords[9].data(), ispc_coords[10].data(),
+                          ispc_coords[11].data(), E.data(), O.data(), n);
+    }, E, E_ref, n_rounds);
+    print("ISPC", res, ref.time);
+    printOrientations(coords, O);
+#endif
+
+    return 0;
+}
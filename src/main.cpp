@@ -107,6 +107,7 @@ int main(int argc, char *argv[]) {
     app.add_option("--stage", args.stage, "Run pipeline in stage STAGE. (integer, optional, default: 1)");
     app.add_option("--filter-energy", args.filter_energy_thres, "Stop mesh improvement when the maximum energy is smaller than ENERGY. (double, optional, default: 10)");
     app.add_option("--max-pass", args.max_num_passes, "Do PASS mesh improvement passes in maximum. (integer, optional, default: 80)");
+    app.add_option("--reorder-thres", args.reorder_thres, "Renumber the mesh between passes when the fraction of reassigned tet slots exceeds THRES, <= 0 to disable. (double, optional, default: 0.5)");
     app.add_option("--targeted-num-v", args.target_num_vertices, "Output tetmesh that contains TV vertices. (integer, optional, tolerance: 5%)");
     app.add_option("--bg-mesh", args.background_mesh, "Background tetmesh BGMESH in .msh format for applying sizing field. (string, optional)");
     app.add_option("--log", log_filename, "Log info to given file.");
@@ -115,6 +116,12 @@ int main(int argc, char *argv[]) {
 
     app.add_flag("--no-voxel", args.not_use_voxel_stuffing, "Use voxel stuffing before BSP subdivision.");
     app.add_flag("--is-laplacian", args.smooth_open_boundary, "Do Laplacian smoothing for the surface of output on the holes of input (optional)");
+    app.add_flag("--wide-bvh", args.use_wide_envelope_tree, "Use the wide layout of the envelope AABB trees. (optional)");
+    app.add_flag("--exact-envelope", args.use_exact_envelope, "Test the faces against the envelope exactly instead of sampling them. (optional)");
+    app.add_flag("--envelope-grid", args.use_envelope_grid, "Filter the envelope point queries with a voxel grid around the input surface. (optional)");
+    app.add_flag("--energy-screening", args.use_energy_screening, "Screen the energies of the collapses and swaps in float before computing them in double. (optional)");
+    app.add_flag("--benchmark-bvh", args.benchmark_envelope_tree, "Log the timings of the envelope queries on the binary and the wide layouts. (optional)");
+    app.add_flag("--validate-energy-cache", args.validate_energy_cache, "Recompute the energies of all the tets and log the cached ones that are out of date. (optional)");
     app.add_flag("-q,--is-quiet", args.is_quiet, "Mute console output. (optional)");
 
     try {
@@ -0,0 +1,319 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/AMIPSEnergy.h>
+#include <tetwild/AMIPSEnergyKernel.h>
+#include <tetwild/LocalOperations.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(TETWILD_WITH_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace tetwild {
+
+namespace {
+SimdLevel detectSimdLevel() {
+#if !defined(TETWILD_WITH_SIMD)
+    return SimdLevel::SCALAR;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int n_ids = info[0];
+    __cpuid(info, 1);
+    if (!(info[3] & (1 << 26)))
+        return SimdLevel::SCALAR;
+    //the ymm/zmm registers must also be saved by the os
+    const bool has_xsave = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+    const unsigned long long xcr0 = has_xsave ? _xgetbv(0) : 0;
+    if (n_ids < 7 || (xcr0 & 0x6) != 0x6)
+        return SimdLevel::SSE2;
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6)
+        return SimdLevel::AVX512;
+    if (info[1] & (1 << 5))
+        return SimdLevel::AVX2;
+    return SimdLevel::SSE2;
+#else
+    //also checks that the os saves the registers
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::SSE2;
+    return SimdLevel::SCALAR;
+#endif
+}
+
+//one double, for the orientation filter of the tail of the batches
+struct V {
+    static const int WIDTH = 1;
+    double v;
+
+    V() {}
+    V(double x): v(x) {}
+
+    static V load(const double* p) { return *p; }
+    void store(double* p) const { *p = v; }
+};
+
+inline V operator+(V a, V b) { return a.v + b.v; }
+inline V operator-(V a, V b) { return a.v - b.v; }
+inline V operator*(V a, V b) { return a.v * b.v; }
+inline V operator-(V a) { return -a.v; }
+inline V abs(V x) { return std::fabs(x.v); }
+inline V min(V x, V y) { return x.v < y.v ? x.v : y.v; }
+inline V max(V x, V y) { return x.v > y.v ? x.v : y.v; }
+inline V selectLess(V a, V b, V x, V y) { return a.v < b.v ? x : y; }
+
+//one float, for the tail of the screening batches
+struct F {
+    static const int WIDTH = 1;
+    float v;
+
+    F() {}
+    F(float x): v(x) {}
+
+    static F load(const float* p) { return *p; }
+    void store(float* p) const { *p = v; }
+};
+
+inline F operator+(F a, F b) { return a.v + b.v; }
+inline F operator-(F a, F b) { return a.v - b.v; }
+inline F operator*(F a, F b) { return a.v * b.v; }
+inline F operator/(F a, F b) { return a.v / b.v; }
+inline F abs(F x) { return std::fabs(x.v); }
+inline F min(F x, F y) { return x.v < y.v ? x.v : y.v; }
+inline F max(F x, F y) { return x.v > y.v ? x.v : y.v; }
+inline F selectLess(F a, F b, F x, F y) { return a.v < b.v ? x : y; }
+
+std::atomic<int>& currentSimdLevel() {
+    static std::atomic<int> level(static_cast<int>(getSupportedSimdLevel()));
+    return level;
+}
+}
+
+SimdLevel getSupportedSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel getSimdLevel() {
+    return SimdLevel(currentSimdLevel().load(std::memory_order_relaxed));
+}
+
+void setSimdLevel(SimdLevel level) {
+    currentSimdLevel().store(std::min(int(level), int(getSupportedSimdLevel())), std::memory_order_relaxed);
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE2:
+            return "SSE2";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+    }
+}
+
+void comformalAMIPSEnergy_batch(const double* const* T, double* E, double* O, int n) {
+    int n_simd = 0;
+#ifdef TETWILD_WITH_SIMD
+    switch (getSimdLevel()) {
+        case SimdLevel::SSE2:
+            n_simd = comformalAMIPSEnergy_sse2(T, E, O, n);
+            break;
+        case SimdLevel::AVX2:
+            n_simd = comformalAMIPSEnergy_avx2(T, E, O, n);
+            break;
+        case SimdLevel::AVX512:
+            n_simd = comformalAMIPSEnergy_avx512(T, E, O, n);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    //the tail of the batch, and the tets the kernels leave to the scalar path with a non finite energy,
+    //their orientation filter is already done
+    std::array<double, 12> t;
+    for (int i = 0; i < n; i++) {
+        if (i < n_simd && std::isfinite(E[i]))
+            continue;
+        for (int k = 0; k < 12; k++)
+            t[k] = T[k][i];
+        E[i] = LocalOperations::comformalAMIPSEnergy_new(t.data());
+        if (i >= n_simd && O != nullptr) {
+            std::array<V, 12> p;
+            std::copy(t.begin(), t.end(), p.begin());
+            orientationFilterLanes(p.data()).store(O + i);
+        }
+    }
+}
+
+void comformalAMIPSNewton_batch(const double* const* T, double* E, double* const* J, double* const* H, int n) {
+    int n_simd = 0;
+#ifdef TETWILD_WITH_SIMD
+    switch (getSimdLevel()) {
+        case SimdLevel::SSE2:
+            n_simd = comformalAMIPSNewton_sse2(T, E, J, H, n);
+            break;
+        case SimdLevel::AVX2:
+            n_simd = comformalAMIPSNewton_avx2(T, E, J, H, n);
+            break;
+        case SimdLevel::AVX512:
+            n_simd = comformalAMIPSNewton_avx512(T, E, J, H, n);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    std::array<double, 12> t;
+    std::array<double, 3> J_1;
+    std::array<double, 9> H_1;
+    for (int i = 0; i < n; i++) {
+        if (i < n_simd) {
+            bool is_finite = std::isfinite(E[i]);
+            for (int k = 0; k < 3; k++)
+                is_finite = is_finite && std::isfinite(J[k][i]);
+            for (int k = 0; k < 9; k++)
+                is_finite = is_finite && std::isfinite(H[k][i]);
+            if (is_finite)
+                continue;
+        }
+        for (int k = 0; k < 12; k++)
+            t[k] = T[k][i];
+        E[i] = LocalOperations::comformalAMIPSEnergy_new(t.data());
+        LocalOperations::comformalAMIPSJacobian_new(t.data(), J_1.data());
+        LocalOperations::comformalAMIPSHessian_new(t.data(), H_1.data());
+        for (int k = 0; k < 3; k++)
+            J[k][i] = J_1[k];
+        for (int k = 0; k < 9; k++)
+            H[k][i] = H_1[k];
+    }
+}
+
+void comformalAMIPSCubeBounds_batch(const float* const* D, float* lower, float* upper, int n) {
+    int n_simd = 0;
+#ifdef TETWILD_WITH_SIMD
+    switch (getSimdLevel()) {
+        case SimdLevel::SSE2:
+            n_simd = comformalAMIPSCubeBounds_sse2(D, lower, upper, n);
+            break;
+        case SimdLevel::AVX2:
+            n_simd = comformalAMIPSCubeBounds_avx2(D, lower, upper, n);
+            break;
+        case SimdLevel::AVX512:
+            n_simd = comformalAMIPSCubeBounds_avx512(D, lower, upper, n);
+            break;
+        default:
+            break;
+    }
+#endif
+
+    //the same expressions on one lane, there is no NaN to redo
+    std::array<const float*, 10> D_tail;
+    for (int k = 0; k < 10; k++)
+        D_tail[k] = D[k] + n_simd;
+    comformalAMIPSCubeBoundsKernel<F>(D_tail.data(), lower + n_simd, upper + n_simd, n - n_simd);
+}
+
+void AMIPSBatch::resize(int n_tets) {
+    n = n_tets;
+    for (int k = 0; k < 12; k++)
+        coords[k].resize(n);
+    energies.resize(n);
+    orientations.resize(n);
+}
+
+void AMIPSBatch::computeEnergies() {
+#ifdef TETWILD_WITH_ISPC
+    ispc::energy_ispc(coords[0].data(), coords[1].data(), coords[2].data(), coords[3].data(), coords[4].data(),
+                      coords[5].data(), coords[6].data(), coords[7].data(), coords[8].data(),
+                      coords[9].data(), coords[10].data(), coords[11].data(), energies.data(), orientations.data(), n);
+#else
+    std::array<const double*, 12> T;
+    for (int k = 0; k < 12; k++)
+        T[k] = coords[k].data();
+    comformalAMIPSEnergy_batch(T.data(), energies.data(), orientations.data(), n);
+#endif
+}
+
+void AMIPSBatch::computeNewtonSystem(double& energy, double* J, double* H) {
+    std::array<const double*, 12> T;
+    for (int k = 0; k < 12; k++)
+        T[k] = coords[k].data();
+    std::array<double*, 3> J_ptrs;
+    for (int k = 0; k < 3; k++) {
+        jacobians[k].resize(n);
+        J_ptrs[k] = jacobians[k].data();
+    }
+    std::array<double*, 9> H_ptrs;
+    for (int k = 0; k < 9; k++) {
+        hessians[k].resize(n);
+        H_ptrs[k] = hessians[k].data();
+    }
+    comformalAMIPSNewton_batch(T.data(), energies.data(), J_ptrs.data(), H_ptrs.data(), n);
+
+    //in the order of the tets, as the scalar loop did
+    energy = 0;
+    std::fill(J, J + 3, 0.0);
+    std::fill(H, H + 9, 0.0);
+    for (int i = 0; i < n; i++) {
+        energy += energies[i];
+        for (int k = 0; k < 3; k++)
+            J[k] += jacobians[k][i];
+        for (int k = 0; k < 9; k++)
+            H[k] += hessians[k][i];
+    }
+}
+
+void AMIPSScreenBatch::resize(int n_tets) {
+    n = n_tets;
+    for (int k = 0; k < 10; k++)
+        edges[k].resize(n);
+    lowers.resize(n);
+    uppers.resize(n);
+}
+
+void AMIPSScreenBatch::setTet(int i, const double* T) {
+    std::array<double, 9> e;
+    double max_e = 0, max_x = 0;
+    for (int k = 0; k < 9; k++) {
+        e[k] = T[k + 3] - T[k % 3];
+        max_e = std::max(max_e, std::abs(e[k]));
+    }
+    for (int k = 0; k < 12; k++)
+        max_x = std::max(max_x, std::abs(T[k]));
+    //max_e scaled into [0.5, 1)
+    int exp;
+    std::frexp(max_e, &exp);
+    const double scale = std::ldexp(1.0, -exp);
+    for (int k = 0; k < 9; k++)
+        edges[k][i] = float(e[k] * scale);
+    edges[9][i] = float(max_x * scale);
+}
+
+void AMIPSScreenBatch::computeBounds() {
+    std::array<const float*, 10> D;
+    for (int k = 0; k < 10; k++)
+        D[k] = edges[k].data();
+    comformalAMIPSCubeBounds_batch(D.data(), lowers.data(), uppers.data(), n);
+}
+
+} // namespace tetwild
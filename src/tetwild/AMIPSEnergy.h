@@ -0,0 +1,105 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+namespace tetwild {
+
+///instruction sets of the batched energy kernels, the best one the cpu supports is used by default
+///the SIMD kernels are only compiled on x86 with TETWILD_WITH_SIMD
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+///the best level of the cpu, from CPUID
+SimdLevel getSupportedSimdLevel();
+SimdLevel getSimdLevel();
+///clamped to the supported level, to compare the kernels
+void setSimdLevel(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
+
+///max relative difference between the SIMD kernels and LocalOperations::comformalAMIPSEnergy_new(), 1.5e-15 measured
+///the polynomial part is evaluated in the same order without fma, only the cube root differs, see AMIPSEnergyKernel.h
+///the tets with a zero, infinite or out of range volume get the scalar energy, bit for bit
+const double AMIPS_SIMD_TOLERANCE = 1e-14;
+
+///AMIPS energy of n tets in SoA layout, T[k][i] is the coordinate k of the tet i ordered as in
+///LocalOperations::comformalAMIPSEnergy_new(), the layout of the ISPC kernel
+///if O is not null, O[i] is the static filter of CGAL::orientation() of the tet i from the same loads: 1 if it is
+///surely POSITIVE, -1 if it is surely NEGATIVE, 0 if the filter fails
+void comformalAMIPSEnergy_batch(const double* const* T, double* E, double* O, int n);
+///with the jacobians and hessians with respect to the first vertex, J[k][i] and H[k][i] are the coordinate k of
+///the ones of the tet i as in LocalOperations::comformalAMIPSJacobian_new() and comformalAMIPSHessian_new()
+void comformalAMIPSNewton_batch(const double* const* T, double* E, double* const* J, double* const* H, int n);
+///float bounds of the cubes of the energies of comformalAMIPSEnergy_batch(), D[k][i] is the coordinate k of the edges
+///of the tet i then its largest coordinate as set by AMIPSScreenBatch::setTet(), 4/8/16 tets at once with SSE2/AVX2/AVX-512
+///the SIMD levels give the same bounds
+void comformalAMIPSCubeBounds_batch(const float* const* D, float* lower, float* upper, int n);
+
+///tets gathered for the batched energy
+class AMIPSBatch {
+public:
+    void resize(int n_tets);
+    int size() const { return n; }
+
+    void setTet(int i, const double* T) {
+        for (int k = 0; k < 12; k++)
+            coords[k][i] = T[k];
+    }
+
+    ///with the ISPC kernel if TETWILD_WITH_ISPC is defined, the SIMD ones otherwise
+    void computeEnergies();
+    double energy(int i) const { return energies[i]; }
+    ///1/-1 if CGAL::orientation() of the tet is surely POSITIVE/NEGATIVE, 0 if the exact predicate has to decide,
+    ///computed with the energies
+    int orientationFilter(int i) const { return int(orientations[i]); }
+
+    ///sums of the energies, jacobians and hessians of the tets, with respect to their first vertex,
+    ///the terms of the newton step of the vertex whose one ring is gathered with the vertex first in each tet
+    void computeNewtonSystem(double& energy, double* J, double* H);
+
+private:
+    int n = 0;
+    std::array<std::vector<double>, 12> coords;
+    std::vector<double> energies;
+    std::vector<double> orientations;
+    std::array<std::vector<double>, 3> jacobians;
+    std::array<std::vector<double>, 9> hessians;
+};
+
+///tets gathered for the screening of their energies in float, lowerCube(i) <= E^3 <= upperCube(i) for the energy E
+///of the tet i computed in double, so that most comparisons of the energies are decided without them
+///the energy is invariant by translation and scaling, the edges are taken from the first vertex and scaled by a
+///power of two in double before they are rounded to float
+class AMIPSScreenBatch {
+public:
+    void resize(int n_tets);
+    int size() const { return n; }
+
+    void setTet(int i, const double* T);
+
+    void computeBounds();
+    double lowerCube(int i) const { return lowers[i]; }
+    ///infinite when the energy in double may be state.MAX_ENERGY or is not well conditioned
+    double upperCube(int i) const { return uppers[i]; }
+
+private:
+    int n = 0;
+    std::array<std::vector<float>, 10> edges;//and the largest coordinate
+    std::vector<float> lowers;
+    std::vector<float> uppers;
+};
+
+} // namespace tetwild
@@ -0,0 +1,425 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <limits>
+
+///the kernel is written once for a vector type V of width V::WIDTH, defined in an unnamed namespace by each
+///AMIPSEnergy_<isa>.cpp, which is compiled with the flags of its instruction set and only includes this file
+///V provides load/store, the arithmetic operators with the division and:
+///  hiWord(x): the high 32 bits of each double of x, as a double
+///  fromHiWord(h): the doubles of high 32 bits h and low 32 bits 0
+///  selectInRange(x, lo, hi, e): e where lo <= x <= hi, NaN elsewhere
+///  abs(x), min(x, y), max(x, y): y where x or y is NaN
+///  selectLess(a, b, x, y): x where a < b, y elsewhere
+///the screening kernel is written for a vector type F of floats of width F::WIDTH, with load/store, the arithmetic
+///operators and:
+///  abs(x), min(x, y), max(x, y): y where x or y is NaN
+///  selectLess(a, b, x, y): x where a < b, y elsewhere
+
+namespace tetwild {
+
+int comformalAMIPSEnergy_sse2(const double* const* T, double* E, double* O, int n);
+int comformalAMIPSEnergy_avx2(const double* const* T, double* E, double* O, int n);
+int comformalAMIPSEnergy_avx512(const double* const* T, double* E, double* O, int n);
+int comformalAMIPSNewton_sse2(const double* const* T, double* E, double* const* J, double* const* H, int n);
+int comformalAMIPSNewton_avx2(const double* const* T, double* E, double* const* J, double* const* H, int n);
+int comformalAMIPSNewton_avx512(const double* const* T, double* E, double* const* J, double* const* H, int n);
+int comformalAMIPSCubeBounds_sse2(const float* const* D, float* lower, float* upper, int n);
+int comformalAMIPSCubeBounds_avx2(const float* const* D, float* lower, float* upper, int n);
+int comformalAMIPSCubeBounds_avx512(const float* const* D, float* lower, float* upper, int n);
+
+namespace {
+//the range of the squared determinant in which the cube root below is valid, the others go to the scalar path
+const double MIN_SQ_DET = 1e-290;
+const double MAX_SQ_DET = 1e290;
+
+//x^(-0.333333333333333) of the scalar path, for MIN_SQ_DET <= x <= MAX_SQ_DET
+template<typename V>
+V invCubeRoot(const V& x) {
+    //log2(x) is about hi / 2^20 - 1023 for the high word hi of x, the guess is within 10%
+    const V hi = hiWord(x);
+    V y = fromHiWord(V(4.0 / 3 * 1023 * (1 << 20)) - hi * V(1.0 / 3));
+    //newton, the error is squared at each step
+    for (int k = 0; k < 5; k++)
+        y = y * (V(4.0) - x * (y * y * y)) * V(1.0 / 3);
+    //x^(1/3 - 0.333333333333333) = 1 + (1/3 - 0.333333333333333) * ln(x), at 1e-17 of the exponent of pow()
+    const V log2_x = hi * V(1.0 / (1 << 20)) - V(1023.0);
+    return y * (V(1.0) + V((1.0 / 3 - 0.333333333333333) * 0.693147180559945) * log2_x);
+}
+
+//the static filter of CGAL::orientation() in Epick, for the differences of coordinates whose largest absolute values
+//are in [MIN_ORIENTATION_DIFF, MAX_ORIENTATION_DIFF), the error of the determinant is below
+//ORIENTATION_EPS * maxx * maxy * maxz
+const double ORIENTATION_EPS = 5.1107127829973299e-15;
+const double MIN_ORIENTATION_DIFF = 1e-97;
+const double MAX_ORIENTATION_DIFF = 1e102;
+
+//unit roundoff of float
+const float FLOAT_U = 1.0f / (1 << 24);
+//relative error of the double path on a tet whose largest coordinate is m times its largest edge: the expressions
+//of LocalOperations::comformalAMIPSEnergy_new() are in absolute coordinates, their cancellation costs about
+//1e-13 m^2 on the numerator and 3e-13 m on the determinant, see AMIPSScreenBatch
+const float DOUBLE_PATH_SLACK = 1.0f / (1LL << 37);
+//the lower bounds are clamped below the overflow of float
+const float MAX_LOWER_CUBE = 1e30f;
+}
+
+///the expressions are the ones of LocalOperations::comformalAMIPSEnergy_new(), comformalAMIPSJacobian_new() and
+///comformalAMIPSHessian_new(), in the same order, on the lanes of V
+///the lanes out of the range of invCubeRoot() are NaN
+template<typename V>
+V comformalAMIPSEnergyLanes(const V* helper_0) {
+    V helper_1 = helper_0[2];
+    V helper_2 = helper_0[11];
+    V helper_3 = helper_0[0];
+    V helper_4 = helper_0[3];
+    V helper_5 = helper_0[9];
+    V helper_6 = 0.577350269189626 * helper_3 - 1.15470053837925 * helper_4 + 0.577350269189626 * helper_5;
+    V helper_7 = helper_0[1];
+    V helper_8 = helper_0[4];
+    V helper_9 = helper_0[7];
+    V helper_10 = helper_0[10];
+    V helper_11 = 0.408248290463863 * helper_10 + 0.408248290463863 * helper_7 + 0.408248290463863 * helper_8 -
+                  1.22474487139159 * helper_9;
+    V helper_12 = 0.577350269189626 * helper_10 + 0.577350269189626 * helper_7 - 1.15470053837925 * helper_8;
+    V helper_13 = helper_0[6];
+    V helper_14 = -1.22474487139159 * helper_13 + 0.408248290463863 * helper_3 + 0.408248290463863 * helper_4 +
+                  0.408248290463863 * helper_5;
+    V helper_15 = helper_0[5];
+    V helper_16 = helper_0[8];
+    V helper_17 = 0.408248290463863 * helper_1 + 0.408248290463863 * helper_15 - 1.22474487139159 * helper_16 +
+                  0.408248290463863 * helper_2;
+    V helper_18 = 0.577350269189626 * helper_1 - 1.15470053837925 * helper_15 + 0.577350269189626 * helper_2;
+    V helper_19 = 0.5 * helper_13 + 0.5 * helper_4;
+    V helper_20 = 0.5 * helper_8 + 0.5 * helper_9;
+    V helper_21 = 0.5 * helper_15 + 0.5 * helper_16;
+    V det = (helper_1 - helper_2) * (helper_11 * helper_6 - helper_12 * helper_14) -
+            (-helper_10 + helper_7) * (-helper_14 * helper_18 + helper_17 * helper_6) +
+            (helper_3 - helper_5) * (-helper_11 * helper_18 + helper_12 * helper_17);
+    V sq_det = det * det;
+    V e = -(helper_1 * (-1.5 * helper_1 + 0.5 * helper_2 + helper_21) +
+            helper_10 * (-1.5 * helper_10 + helper_20 + 0.5 * helper_7) +
+            helper_13 * (-1.5 * helper_13 + 0.5 * helper_3 + 0.5 * helper_4 + 0.5 * helper_5) +
+            helper_15 * (0.5 * helper_1 - 1.5 * helper_15 + 0.5 * helper_16 + 0.5 * helper_2) +
+            helper_16 * (0.5 * helper_1 + 0.5 * helper_15 - 1.5 * helper_16 + 0.5 * helper_2) +
+            helper_2 * (0.5 * helper_1 - 1.5 * helper_2 + helper_21) +
+            helper_3 * (helper_19 - 1.5 * helper_3 + 0.5 * helper_5) +
+            helper_4 * (0.5 * helper_13 + 0.5 * helper_3 - 1.5 * helper_4 + 0.5 * helper_5) +
+            helper_5 * (helper_19 + 0.5 * helper_3 - 1.5 * helper_5) +
+            helper_7 * (0.5 * helper_10 + helper_20 - 1.5 * helper_7) +
+            helper_8 * (0.5 * helper_10 + 0.5 * helper_7 - 1.5 * helper_8 + 0.5 * helper_9) +
+            helper_9 * (0.5 * helper_10 + 0.5 * helper_7 + 0.5 * helper_8 - 1.5 * helper_9)) *
+          invCubeRoot(sq_det);
+    return selectInRange(sq_det, MIN_SQ_DET, MAX_SQ_DET, e);
+}
+
+///1 where CGAL::orientation() of the tet is surely POSITIVE, -1 where it is surely NEGATIVE, 0 where the static
+///filter fails and the exact predicate has to decide
+template<typename V>
+V orientationFilterLanes(const V* p) {
+    const V pqx = p[3] - p[0], pqy = p[4] - p[1], pqz = p[5] - p[2];
+    const V prx = p[6] - p[0], pry = p[7] - p[1], prz = p[8] - p[2];
+    const V psx = p[9] - p[0], psy = p[10] - p[1], psz = p[11] - p[2];
+    const V maxx = max(abs(pqx), max(abs(prx), abs(psx)));
+    const V maxy = max(abs(pqy), max(abs(pry), abs(psy)));
+    const V maxz = max(abs(pqz), max(abs(prz), abs(psz)));
+    //CGAL::determinant(pqx, pqy, pqz, prx, pry, prz, psx, psy, psz)
+    const V m01 = pqx * pry - prx * pqy;
+    const V m02 = pqx * psy - psx * pqy;
+    const V m12 = prx * psy - psx * pry;
+    const V det = m01 * psz - m02 * prz + m12 * pqz;
+    const V eps = V(ORIENTATION_EPS) * maxx * maxy * maxz;
+    const V sign = selectLess(eps, det, V(1.0), selectLess(det, -eps, V(-1.0), V(0.0)));
+    //out of the range, eps may underflow or det overflow
+    const V min_diff = min(maxx, min(maxy, maxz)), max_diff = max(maxx, max(maxy, maxz));
+    return selectLess(min_diff, V(MIN_ORIENTATION_DIFF), V(0.0),
+                      selectLess(max_diff, V(MAX_ORIENTATION_DIFF), sign, V(0.0)));
+}
+
+template<typename V>
+void comformalAMIPSJacobianLanes(const V* helper_0, V* result_0) {
+    V helper_1 = helper_0[1];
+    V helper_2 = helper_0[10];
+    V helper_3 = helper_1 - helper_2;
+    V helper_4 = helper_0[0];
+    V helper_5 = helper_0[3];
+    V helper_6 = helper_0[9];
+    V helper_7 = 0.577350269189626*helper_4 - 1.15470053837925*helper_5 + 0.577350269189626*helper_6;
+    V helper_8 = helper_0[2];
+    V helper_9 = 0.408248290463863*helper_8;
+    V helper_10 = helper_0[5];
+    V helper_11 = 0.408248290463863*helper_10;
+    V helper_12 = helper_0[8];
+    V helper_13 = 1.22474487139159*helper_12;
+    V helper_14 = helper_0[11];
+    V helper_15 = 0.408248290463863*helper_14;
+    V helper_16 = helper_11 - helper_13 + helper_15 + helper_9;
+    V helper_17 = 0.577350269189626*helper_8;
+    V helper_18 = 1.15470053837925*helper_10;
+    V helper_19 = 0.577350269189626*helper_14;
+    V helper_20 = helper_17 - helper_18 + helper_19;
+    V helper_21 = helper_0[6];
+    V helper_22 = -1.22474487139159*helper_21 + 0.408248290463863*helper_4 + 0.408248290463863*helper_5 + 0.408248290463863*helper_6;
+    V helper_23 = helper_16*helper_7 - helper_20*helper_22;
+    V helper_24 = -helper_14 + helper_8;
+    V helper_25 = 0.408248290463863*helper_1;
+    V helper_26 = helper_0[4];
+    V helper_27 = 0.408248290463863*helper_26;
+    V helper_28 = helper_0[7];
+    V helper_29 = 1.22474487139159*helper_28;
+    V helper_30 = 0.408248290463863*helper_2;
+    V helper_31 = helper_25 + helper_27 - helper_29 + helper_30;
+    V helper_32 = helper_31*helper_7;
+    V helper_33 = 0.577350269189626*helper_1;
+    V helper_34 = 1.15470053837925*helper_26;
+    V helper_35 = 0.577350269189626*helper_2;
+    V helper_36 = helper_33 - helper_34 + helper_35;
+    V helper_37 = helper_22*helper_36;
+    V helper_38 = helper_4 - helper_6;
+    V helper_39 = helper_23*helper_3 - helper_24*(helper_32 - helper_37) - helper_38*(helper_16*helper_36 - helper_20*helper_31);
+    V sq_det = helper_39 * helper_39;
+    V helper_40 = invCubeRoot(sq_det);
+    V helper_41 = 0.707106781186548*helper_10 - 0.707106781186548*helper_12;
+    V helper_42 = 0.707106781186548*helper_26 - 0.707106781186548*helper_28;
+    V helper_43 = 0.5*helper_21 + 0.5*helper_5;
+    V helper_44 = 0.5*helper_26 + 0.5*helper_28;
+    V helper_45 = 0.5*helper_10 + 0.5*helper_12;
+    V helper_46 = 0.666666666666667*(helper_1*(-1.5*helper_1 + 0.5*helper_2 + helper_44) + helper_10*(-1.5*helper_10 + 0.5*helper_12 + 0.5*helper_14 + 0.5*helper_8) + helper_12*(0.5*helper_10 - 1.5*helper_12 + 0.5*helper_14 + 0.5*helper_8) + helper_14*(-1.5*helper_14 + helper_45 + 0.5*helper_8) + helper_2*(0.5*helper_1 - 1.5*helper_2 + helper_44) + helper_21*(-1.5*helper_21 + 0.5*helper_4 + 0.5*helper_5 + 0.5*helper_6) + helper_26*(0.5*helper_1 + 0.5*helper_2 - 1.5*helper_26 + 0.5*helper_28) + helper_28*(0.5*helper_1 + 0.5*helper_2 + 0.5*helper_26 - 1.5*helper_28) + helper_4*(-1.5*helper_4 + helper_43 + 0.5*helper_6) + helper_5*(0.5*helper_21 + 0.5*helper_4 - 1.5*helper_5 + 0.5*helper_6) + helper_6*(0.5*helper_4 + helper_43 - 1.5*helper_6) + helper_8*(0.5*helper_14 + helper_45 - 1.5*helper_8))/helper_39;
+    V helper_47 = -0.707106781186548*helper_21 + 0.707106781186548*helper_5;
+    result_0[0] = selectInRange(sq_det, MIN_SQ_DET, MAX_SQ_DET, -helper_40*(1.0*helper_21 - 3.0*helper_4 + helper_46*(helper_41*(-helper_1 + helper_2) - helper_42*(helper_14 - helper_8) - (-helper_17 + helper_18 - helper_19)*(-helper_25 - helper_27 + helper_29 - helper_30) + (-helper_33 + helper_34 - helper_35)*(-helper_11 + helper_13 - helper_15 - helper_9)) + 1.0*helper_5 + 1.0*helper_6));
+    result_0[1] = selectInRange(sq_det, MIN_SQ_DET, MAX_SQ_DET, helper_40*(3.0*helper_1 - 1.0*helper_2 - 1.0*helper_26 - 1.0*helper_28 + helper_46*(helper_23 + helper_24*helper_47 - helper_38*helper_41)));
+    result_0[2] = selectInRange(sq_det, MIN_SQ_DET, MAX_SQ_DET, helper_40*(-1.0*helper_10 - 1.0*helper_12 - 1.0*helper_14 + helper_46*(-helper_3*helper_47 - helper_32 + helper_37 + helper_38*helper_42) + 3.0*helper_8));
+}
+
+template<typename V>
+void comformalAMIPSHessianLanes(const V* helper_0, V* result_0) {
+    V helper_1 = helper_0[2];
+    V helper_2 = helper_0[11];
+    V helper_3 = helper_1 - helper_2;
+    V helper_4 = helper_0[0];
+    V helper_5 = 0.577350269189626*helper_4;
+    V helper_6 = helper_0[3];
+    V helper_7 = 1.15470053837925*helper_6;
+    V helper_8 = helper_0[9];
+    V helper_9 = 0.577350269189626*helper_8;
+    V helper_10 = helper_5 - helper_7 + helper_9;
+    V helper_11 = helper_0[1];
+    V helper_12 = 0.408248290463863*helper_11;
+    V helper_13 = helper_0[4];
+    V helper_14 = 0.408248290463863*helper_13;
+    V helper_15 = helper_0[7];
+    V helper_16 = 1.22474487139159*helper_15;
+    V helper_17 = helper_0[10];
+    V helper_18 = 0.408248290463863*helper_17;
+    V helper_19 = helper_12 + helper_14 - helper_16 + helper_18;
+    V helper_20 = helper_10*helper_19;
+    V helper_21 = 0.577350269189626*helper_11;
+    V helper_22 = 1.15470053837925*helper_13;
+    V helper_23 = 0.577350269189626*helper_17;
+    V helper_24 = helper_21 - helper_22 + helper_23;
+    V helper_25 = 0.408248290463863*helper_4;
+    V helper_26 = 0.408248290463863*helper_6;
+    V helper_27 = helper_0[6];
+    V helper_28 = 1.22474487139159*helper_27;
+    V helper_29 = 0.408248290463863*helper_8;
+    V helper_30 = helper_25 + helper_26 - helper_28 + helper_29;
+    V helper_31 = helper_24*helper_30;
+    V helper_32 = helper_3*(helper_20 - helper_31);
+    V helper_33 = helper_4 - helper_8;
+    V helper_34 = 0.408248290463863*helper_1;
+    V helper_35 = helper_0[5];
+    V helper_36 = 0.408248290463863*helper_35;
+    V helper_37 = helper_0[8];
+    V helper_38 = 1.22474487139159*helper_37;
+    V helper_39 = 0.408248290463863*helper_2;
+    V helper_40 = helper_34 + helper_36 - helper_38 + helper_39;
+    V helper_41 = helper_24*helper_40;
+    V helper_42 = 0.577350269189626*helper_1;
+    V helper_43 = 1.15470053837925*helper_35;
+    V helper_44 = 0.577350269189626*helper_2;
+    V helper_45 = helper_42 - helper_43 + helper_44;
+    V helper_46 = helper_19*helper_45;
+    V helper_47 = helper_41 - helper_46;
+    V helper_48 = helper_33*helper_47;
+    V helper_49 = helper_11 - helper_17;
+    V helper_50 = helper_10*helper_40;
+    V helper_51 = helper_30*helper_45;
+    V helper_52 = helper_50 - helper_51;
+    V helper_53 = helper_49*helper_52;
+    V helper_54 = helper_32 + helper_48 - helper_53;
+    V helper_55 = (helper_54 * helper_54);
+    V helper_56 = invCubeRoot(helper_55);
+    V helper_57 = 1.0*helper_27 - 3.0*helper_4 + 1.0*helper_6 + 1.0*helper_8;
+    V helper_58 = 0.707106781186548*helper_13;
+    V helper_59 = 0.707106781186548*helper_15;
+    V helper_60 = helper_58 - helper_59;
+    V helper_61 = helper_3*helper_60;
+    V helper_62 = 0.707106781186548*helper_35 - 0.707106781186548*helper_37;
+    V helper_63 = helper_49*helper_62;
+    V helper_64 = helper_47 + helper_61 - helper_63;
+    V helper_65 = 1.33333333333333/helper_54;
+    V helper_66 = 1.0/helper_55;
+    V helper_67 = 0.5*helper_27 + 0.5*helper_6;
+    V helper_68 = -1.5*helper_4 + helper_67 + 0.5*helper_8;
+    V helper_69 = 0.5*helper_4 + helper_67 - 1.5*helper_8;
+    V helper_70 = -1.5*helper_27 + 0.5*helper_4 + 0.5*helper_6 + 0.5*helper_8;
+    V helper_71 = 0.5*helper_27 + 0.5*helper_4 - 1.5*helper_6 + 0.5*helper_8;
+    V helper_72 = 0.5*helper_13 + 0.5*helper_15;
+    V helper_73 = -1.5*helper_11 + 0.5*helper_17 + helper_72;
+    V helper_74 = 0.5*helper_11 - 1.5*helper_17 + helper_72;
+    V helper_75 = 0.5*helper_11 + 0.5*helper_13 - 1.5*helper_15 + 0.5*helper_17;
+    V helper_76 = 0.5*helper_11 - 1.5*helper_13 + 0.5*helper_15 + 0.5*helper_17;
+    V helper_77 = 0.5*helper_35 + 0.5*helper_37;
+    V helper_78 = -1.5*helper_1 + 0.5*helper_2 + helper_77;
+    V helper_79 = 0.5*helper_1 - 1.5*helper_2 + helper_77;
+    V helper_80 = 0.5*helper_1 + 0.5*helper_2 + 0.5*helper_35 - 1.5*helper_37;
+    V helper_81 = 0.5*helper_1 + 0.5*helper_2 - 1.5*helper_35 + 0.5*helper_37;
+    V helper_82 = helper_1*helper_78 + helper_11*helper_73 + helper_13*helper_76 + helper_15*helper_75 + helper_17*helper_74 + helper_2*helper_79 + helper_27*helper_70 + helper_35*helper_81 + helper_37*helper_80 + helper_4*helper_68 + helper_6*helper_71 + helper_69*helper_8;
+    V helper_83 = 0.444444444444444*helper_66*helper_82;
+    V helper_84 = helper_66*helper_82;
+    V helper_85 = -helper_32 - helper_48 + helper_53;
+    V helper_86 = 1.0/helper_85;
+    V helper_87 = helper_86*invCubeRoot(helper_85 * helper_85);
+    V helper_88 = 0.707106781186548*helper_6;
+    V helper_89 = 0.707106781186548*helper_27;
+    V helper_90 = helper_88 - helper_89;
+    V helper_91 = 0.666666666666667*helper_10*helper_40 + 0.666666666666667*helper_3*helper_90 - 0.666666666666667*helper_30*helper_45 - 0.666666666666667*helper_33*helper_62;
+    V helper_92 = -3.0*helper_11 + 1.0*helper_13 + 1.0*helper_15 + 1.0*helper_17;
+    V helper_93 = -helper_11 + helper_17;
+    V helper_94 = -helper_1 + helper_2;
+    V helper_95 = -helper_21 + helper_22 - helper_23;
+    V helper_96 = -helper_34 - helper_36 + helper_38 - helper_39;
+    V helper_97 = -helper_42 + helper_43 - helper_44;
+    V helper_98 = -helper_12 - helper_14 + helper_16 - helper_18;
+    V helper_99 = -0.666666666666667*helper_60*helper_94 + 0.666666666666667*helper_62*helper_93 + 0.666666666666667*helper_95*helper_96 - 0.666666666666667*helper_97*helper_98;
+    V helper_100 = helper_3*helper_90;
+    V helper_101 = helper_33*helper_62;
+    V helper_102 = helper_100 - helper_101 + helper_52;
+    V helper_103 = -helper_60*helper_94 + helper_62*helper_93 + helper_95*helper_96 - helper_97*helper_98;
+    V helper_104 = 0.444444444444444*helper_102*helper_103*helper_82*helper_86 + helper_57*helper_91 - helper_92*helper_99;
+    V helper_105 = 1.85037170770859e-17*helper_1*helper_78 + 1.85037170770859e-17*helper_11*helper_73 + 1.85037170770859e-17*helper_13*helper_76 + 1.85037170770859e-17*helper_15*helper_75 + 1.85037170770859e-17*helper_17*helper_74 + 1.85037170770859e-17*helper_2*helper_79 + 1.85037170770859e-17*helper_27*helper_70 + 1.85037170770859e-17*helper_35*helper_81 + 1.85037170770859e-17*helper_37*helper_80 + 1.85037170770859e-17*helper_4*helper_68 + 1.85037170770859e-17*helper_6*helper_71 + 1.85037170770859e-17*helper_69*helper_8;
+    V helper_106 = helper_64*helper_82*helper_86;
+    V helper_107 = -0.666666666666667*helper_10*helper_19 + 0.666666666666667*helper_24*helper_30 + 0.666666666666667*helper_33*helper_60 - 0.666666666666667*helper_49*helper_90;
+    V helper_108 = -3.0*helper_1 + 1.0*helper_2 + 1.0*helper_35 + 1.0*helper_37;
+    V helper_109 = -helper_20 + helper_31 + helper_33*helper_60 - helper_49*helper_90;
+    V helper_110 = 0.444444444444444*helper_109*helper_82*helper_86;
+    V helper_111 = helper_103*helper_110 + helper_107*helper_57 - helper_108*helper_99;
+    V helper_112 = -helper_4 + helper_8;
+    V helper_113 = -helper_88 + helper_89;
+    V helper_114 = -helper_5 + helper_7 - helper_9;
+    V helper_115 = -helper_25 - helper_26 + helper_28 - helper_29;
+    V helper_116 = helper_82*helper_86*(helper_112*helper_62 + helper_113*helper_94 + helper_114*helper_96 - helper_115*helper_97);
+    V helper_117 = -helper_100 + helper_101 - helper_50 + helper_51;
+    V helper_118 = -helper_102*helper_110 + helper_107*helper_92 + helper_108*helper_91;
+    V helper_119 = helper_82*helper_86*(helper_112*(-helper_58 + helper_59) - helper_113*helper_93 - helper_114*helper_98 + helper_115*helper_95);
+    result_0[0] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_56*(helper_57*helper_64*helper_65 - (helper_64 * helper_64)*helper_83 + 0.666666666666667*helper_64*helper_84*(-helper_41 + helper_46 - helper_61 + helper_63) + 3.0));
+    result_0[1] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(helper_104 - helper_105*helper_35 + helper_106*helper_91));
+    result_0[2] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(helper_106*helper_107 + helper_111));
+    result_0[3] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(helper_104 + helper_116*helper_99));
+    result_0[4] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_56*(-(helper_117 * helper_117)*helper_83 + helper_117*helper_65*helper_92 + helper_117*helper_84*helper_91 + 3.0));
+    result_0[5] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(-helper_105*helper_6 - helper_107*helper_116 + helper_118));
+    result_0[6] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(-helper_105*helper_13 + helper_111 + helper_119*helper_99));
+    result_0[7] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_87*(helper_118 - helper_119*helper_91));
+    result_0[8] = selectInRange(helper_55, MIN_SQ_DET, MAX_SQ_DET, helper_56*(-helper_108*helper_109*helper_65 - 1.11111111111111*(helper_109 * helper_109)*helper_84 + 3.0));
+}
+
+///bounds of the cube of the energy E = S / (2 det^2)^(1/3) / 2 of a tet, S the sum of its squared edge lengths and det
+///the determinant of its edges d[0..9) from its first vertex, from the float rounding of the edges scaled to at most 1
+///and d[9] the largest coordinate of the tet with the same scale
+///they include the error of the double path, the upper bound is infinite where the tet may be flipped or the error
+///of the double path may be large
+template<typename F>
+void comformalAMIPSCubeBoundsLanes(const F* d, F& lower, F& upper) {
+    const F ax = d[0], ay = d[1], az = d[2];
+    const F bx = d[3], by = d[4], bz = d[5];
+    const F cx = d[6], cy = d[7], cz = d[8];
+    const F m = d[9];
+    //the edges between the other vertices lose at most 2u of the longest one in float
+    const F fx = bx - ax, fy = by - ay, fz = bz - az;
+    const F gx = cx - ax, gy = cy - ay, gz = cz - az;
+    const F hx = cx - bx, hy = cy - by, hz = cz - bz;
+    const F S = ax * ax + ay * ay + az * az + bx * bx + by * by + bz * bz + cx * cx + cy * cy + cz * cz
+                + fx * fx + fy * fy + fz * fz + gx * gx + gy * gy + gz * gz + hx * hx + hy * hy + hz * hz;
+    const F det = ax * (by * cz - bz * cy) + ay * (bz * cx - bx * cz) + az * (bx * cy - by * cx);
+    //the error of det is below 8u of the sum of the absolute values of its terms
+    const F det_abs = abs(ax) * (abs(by * cz) + abs(bz * cy)) + abs(ay) * (abs(bz * cx) + abs(bx * cz))
+                      + abs(az) * (abs(bx * cy) + abs(by * cx));
+
+    const F r_S = F(64 * FLOAT_U) + F(DOUBLE_PATH_SLACK) * (m * m) / S;
+    const F err_det = F(16 * FLOAT_U) * det_abs + F(DOUBLE_PATH_SLACK) * m + F(1e-30f);//and the underflow of the edges
+    const F S_lo = max(S - S * r_S, F(0.0f));
+    const F S_hi = S + S * r_S;
+    const F det_lo = det - err_det;
+    const F det_hi = abs(det) + err_det;
+
+    //32u covers the rounding of the expressions below
+    const F lo = S_lo * S_lo * S_lo / (F(16.0f) * det_hi * det_hi) * F(1 - 32 * FLOAT_U);
+    lower = min(max(lo, F(0.0f)), F(MAX_LOWER_CUBE));
+    const F hi = S_hi * S_hi * S_hi / (F(16.0f) * det_lo * det_lo) * F(1 + 32 * FLOAT_U);
+    const F inf = F(std::numeric_limits<float>::infinity());
+    upper = selectLess(err_det, F(0.5f) * det, selectLess(r_S, F(0.5f), hi, inf), inf);
+}
+
+///the energies of the first tets by groups of V::WIDTH, with the orientation filter of the same loads if O is not
+///null, returns the number of tets done
+template<typename V>
+int comformalAMIPSEnergyKernel(const double* const* T, double* E, double* O, int n) {
+    int i = 0;
+    for (; i + V::WIDTH <= n; i += V::WIDTH) {
+        V helper_0[12];
+        for (int k = 0; k < 12; k++)
+            helper_0[k] = V::load(T[k] + i);
+        comformalAMIPSEnergyLanes(helper_0).store(E + i);
+        if (O != nullptr)
+            orientationFilterLanes(helper_0).store(O + i);
+    }
+    return i;
+}
+
+///the energies, jacobians and hessians of the first tets by groups of V::WIDTH, returns the number of tets done
+///J[k][i] and H[k][i] are the coordinate k of the jacobian/hessian of the tet i
+template<typename V>
+int comformalAMIPSNewtonKernel(const double* const* T, double* E, double* const* J, double* const* H, int n) {
+    int i = 0;
+    for (; i + V::WIDTH <= n; i += V::WIDTH) {
+        V helper_0[12];
+        for (int k = 0; k < 12; k++)
+            helper_0[k] = V::load(T[k] + i);
+        comformalAMIPSEnergyLanes(helper_0).store(E + i);
+        V J_1[3], H_1[9];
+        comformalAMIPSJacobianLanes(helper_0, J_1);
+        comformalAMIPSHessianLanes(helper_0, H_1);
+        for (int k = 0; k < 3; k++)
+            J_1[k].store(J[k] + i);
+        for (int k = 0; k < 9; k++)
+            H_1[k].store(H[k] + i);
+    }
+    return i;
+}
+
+///the bounds of the first tets by groups of F::WIDTH, D[k][i] is the coordinate k of the input of the tet i
+///to comformalAMIPSCubeBoundsLanes(), returns the number of tets done
+template<typename F>
+int comformalAMIPSCubeBoundsKernel(const float* const* D, float* lower, float* upper, int n) {
+    int i = 0;
+    for (; i + F::WIDTH <= n; i += F::WIDTH) {
+        F d[10];
+        for (int k = 0; k < 10; k++)
+            d[k] = F::load(D[k] + i);
+        F lo, hi;
+        comformalAMIPSCubeBoundsLanes(d, lo, hi);
+        lo.store(lower + i);
+        hi.store(upper + i);
+    }
+    return i;
+}
+
+} // namespace tetwild
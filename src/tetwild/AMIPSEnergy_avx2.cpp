@@ -0,0 +1,96 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+//compiled with -mavx2, only includes the headers of the kernel, see AMIPSEnergyKernel.h
+#include <immintrin.h>
+
+namespace {
+struct V {
+    static const int WIDTH = 4;
+    __m256d v;
+
+    V() {}
+    V(__m256d x): v(x) {}
+    V(double a): v(_mm256_set1_pd(a)) {}
+
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+};
+
+inline V operator+(V a, V b) { return _mm256_add_pd(a.v, b.v); }
+inline V operator-(V a, V b) { return _mm256_sub_pd(a.v, b.v); }
+inline V operator*(V a, V b) { return _mm256_mul_pd(a.v, b.v); }
+inline V operator/(V a, V b) { return _mm256_div_pd(a.v, b.v); }
+inline V operator-(V a) { return _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)); }
+
+inline V hiWord(V x) {
+    __m256i hi = _mm256_permutevar8x32_epi32(_mm256_castpd_si256(x.v), _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7));
+    return _mm256_cvtepi32_pd(_mm256_castsi256_si128(hi));
+}
+
+inline V fromHiWord(V h) {
+    return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm256_cvttpd_epi32(h.v)), 32));
+}
+
+inline V selectInRange(V x, double lo, double hi, V e) {
+    __m256d m = _mm256_and_pd(_mm256_cmp_pd(x.v, _mm256_set1_pd(lo), _CMP_GE_OQ),
+                              _mm256_cmp_pd(x.v, _mm256_set1_pd(hi), _CMP_LE_OQ));
+    return _mm256_blendv_pd(_mm256_castsi256_pd(_mm256_set1_epi64x(0x7ff8000000000000LL)), e.v, m);
+}
+
+inline V abs(V x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x.v); }
+inline V min(V x, V y) { return _mm256_min_pd(x.v, y.v); }
+inline V max(V x, V y) { return _mm256_max_pd(x.v, y.v); }
+
+inline V selectLess(V a, V b, V x, V y) {
+    return _mm256_blendv_pd(y.v, x.v, _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ));
+}
+
+struct F {
+    static const int WIDTH = 8;
+    __m256 v;
+
+    F() {}
+    F(__m256 x): v(x) {}
+    F(float a): v(_mm256_set1_ps(a)) {}
+
+    static F load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline F operator+(F a, F b) { return _mm256_add_ps(a.v, b.v); }
+inline F operator-(F a, F b) { return _mm256_sub_ps(a.v, b.v); }
+inline F operator*(F a, F b) { return _mm256_mul_ps(a.v, b.v); }
+inline F operator/(F a, F b) { return _mm256_div_ps(a.v, b.v); }
+inline F abs(F x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x.v); }
+inline F min(F x, F y) { return _mm256_min_ps(x.v, y.v); }
+inline F max(F x, F y) { return _mm256_max_ps(x.v, y.v); }
+
+inline F selectLess(F a, F b, F x, F y) {
+    return _mm256_blendv_ps(y.v, x.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ));
+}
+}
+
+#include <tetwild/AMIPSEnergyKernel.h>
+
+namespace tetwild {
+
+int comformalAMIPSEnergy_avx2(const double* const* T, double* E, double* O, int n) {
+    return comformalAMIPSEnergyKernel<V>(T, E, O, n);
+}
+
+int comformalAMIPSNewton_avx2(const double* const* T, double* E, double* const* J, double* const* H, int n) {
+    return comformalAMIPSNewtonKernel<V>(T, E, J, H, n);
+}
+
+int comformalAMIPSCubeBounds_avx2(const float* const* D, float* lower, float* upper, int n) {
+    return comformalAMIPSCubeBoundsKernel<F>(D, lower, upper, n);
+}
+
+} // namespace tetwild
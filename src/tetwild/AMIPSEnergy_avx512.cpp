@@ -0,0 +1,106 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+//compiled with -mavx512f, only includes the headers of the kernel, see AMIPSEnergyKernel.h
+//the avx-512 intrinsics of gcc start from registers initialized from themselves
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+struct V {
+    static const int WIDTH = 8;
+    __m512d v;
+
+    V() {}
+    V(__m512d x): v(x) {}
+    V(double a): v(_mm512_set1_pd(a)) {}
+
+    static V load(const double* p) { return _mm512_loadu_pd(p); }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+};
+
+inline V operator+(V a, V b) { return _mm512_add_pd(a.v, b.v); }
+inline V operator-(V a, V b) { return _mm512_sub_pd(a.v, b.v); }
+inline V operator*(V a, V b) { return _mm512_mul_pd(a.v, b.v); }
+inline V operator/(V a, V b) { return _mm512_div_pd(a.v, b.v); }
+inline V operator-(V a) {
+    return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a.v), _mm512_set1_epi64(0x8000000000000000LL)));
+}
+
+inline V hiWord(V x) {
+    return _mm512_cvtepi32_pd(_mm512_cvtepi64_epi32(_mm512_srli_epi64(_mm512_castpd_si512(x.v), 32)));
+}
+
+inline V fromHiWord(V h) {
+    return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_cvtepu32_epi64(_mm512_cvttpd_epi32(h.v)), 32));
+}
+
+inline V selectInRange(V x, double lo, double hi, V e) {
+    __mmask8 m = _mm512_cmp_pd_mask(x.v, _mm512_set1_pd(lo), _CMP_GE_OQ)
+                 & _mm512_cmp_pd_mask(x.v, _mm512_set1_pd(hi), _CMP_LE_OQ);
+    return _mm512_mask_blend_pd(m, _mm512_castsi512_pd(_mm512_set1_epi64(0x7ff8000000000000LL)), e.v);
+}
+
+inline V abs(V x) { return _mm512_abs_pd(x.v); }
+inline V min(V x, V y) { return _mm512_min_pd(x.v, y.v); }
+inline V max(V x, V y) { return _mm512_max_pd(x.v, y.v); }
+
+inline V selectLess(V a, V b, V x, V y) {
+    return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ), y.v, x.v);
+}
+
+struct F {
+    static const int WIDTH = 16;
+    __m512 v;
+
+    F() {}
+    F(__m512 x): v(x) {}
+    F(float a): v(_mm512_set1_ps(a)) {}
+
+    static F load(const float* p) { return _mm512_loadu_ps(p); }
+    void store(float* p) const { _mm512_storeu_ps(p, v); }
+};
+
+inline F operator+(F a, F b) { return _mm512_add_ps(a.v, b.v); }
+inline F operator-(F a, F b) { return _mm512_sub_ps(a.v, b.v); }
+inline F operator*(F a, F b) { return _mm512_mul_ps(a.v, b.v); }
+inline F operator/(F a, F b) { return _mm512_div_ps(a.v, b.v); }
+inline F abs(F x) { return _mm512_abs_ps(x.v); }
+inline F min(F x, F y) { return _mm512_min_ps(x.v, y.v); }
+inline F max(F x, F y) { return _mm512_max_ps(x.v, y.v); }
+
+inline F selectLess(F a, F b, F x, F y) {
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ), y.v, x.v);
+}
+}
+
+#include <tetwild/AMIPSEnergyKernel.h>
+
+namespace tetwild {
+
+int comformalAMIPSEnergy_avx512(const double* const* T, double* E, double* O, int n) {
+    return comformalAMIPSEnergyKernel<V>(T, E, O, n);
+}
+
+int comformalAMIPSNewton_avx512(const double* const* T, double* E, double* const* J, double* const* H, int n) {
+    return comformalAMIPSNewtonKernel<V>(T, E, J, H, n);
+}
+
+int comformalAMIPSCubeBounds_avx512(const float* const* D, float* lower, float* upper, int n) {
+    return comformalAMIPSCubeBoundsKernel<F>(D, lower, upper, n);
+}
+
+} // namespace tetwild
@@ -0,0 +1,97 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+//compiled with -msse2, only includes the headers of the kernel, see AMIPSEnergyKernel.h
+#include <emmintrin.h>
+
+namespace {
+struct V {
+    static const int WIDTH = 2;
+    __m128d v;
+
+    V() {}
+    V(__m128d x): v(x) {}
+    V(double a): v(_mm_set1_pd(a)) {}
+
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+};
+
+inline V operator+(V a, V b) { return _mm_add_pd(a.v, b.v); }
+inline V operator-(V a, V b) { return _mm_sub_pd(a.v, b.v); }
+inline V operator*(V a, V b) { return _mm_mul_pd(a.v, b.v); }
+inline V operator/(V a, V b) { return _mm_div_pd(a.v, b.v); }
+inline V operator-(V a) { return _mm_xor_pd(a.v, _mm_set1_pd(-0.0)); }
+
+inline V hiWord(V x) {
+    return _mm_cvtepi32_pd(_mm_shuffle_epi32(_mm_castpd_si128(x.v), _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+inline V fromHiWord(V h) {
+    return _mm_castsi128_pd(_mm_unpacklo_epi32(_mm_setzero_si128(), _mm_cvttpd_epi32(h.v)));
+}
+
+inline V selectInRange(V x, double lo, double hi, V e) {
+    __m128d m = _mm_and_pd(_mm_cmpge_pd(x.v, _mm_set1_pd(lo)), _mm_cmple_pd(x.v, _mm_set1_pd(hi)));
+    __m128d nan = _mm_castsi128_pd(_mm_set1_epi64x(0x7ff8000000000000LL));
+    return _mm_or_pd(_mm_and_pd(m, e.v), _mm_andnot_pd(m, nan));
+}
+
+inline V abs(V x) { return _mm_andnot_pd(_mm_set1_pd(-0.0), x.v); }
+inline V min(V x, V y) { return _mm_min_pd(x.v, y.v); }
+inline V max(V x, V y) { return _mm_max_pd(x.v, y.v); }
+
+inline V selectLess(V a, V b, V x, V y) {
+    __m128d m = _mm_cmplt_pd(a.v, b.v);
+    return _mm_or_pd(_mm_and_pd(m, x.v), _mm_andnot_pd(m, y.v));
+}
+
+struct F {
+    static const int WIDTH = 4;
+    __m128 v;
+
+    F() {}
+    F(__m128 x): v(x) {}
+    F(float a): v(_mm_set1_ps(a)) {}
+
+    static F load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline F operator+(F a, F b) { return _mm_add_ps(a.v, b.v); }
+inline F operator-(F a, F b) { return _mm_sub_ps(a.v, b.v); }
+inline F operator*(F a, F b) { return _mm_mul_ps(a.v, b.v); }
+inline F operator/(F a, F b) { return _mm_div_ps(a.v, b.v); }
+inline F abs(F x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x.v); }
+inline F min(F x, F y) { return _mm_min_ps(x.v, y.v); }
+inline F max(F x, F y) { return _mm_max_ps(x.v, y.v); }
+
+inline F selectLess(F a, F b, F x, F y) {
+    __m128 m = _mm_cmplt_ps(a.v, b.v);
+    return _mm_or_ps(_mm_and_ps(m, x.v), _mm_andnot_ps(m, y.v));
+}
+}
+
+#include <tetwild/AMIPSEnergyKernel.h>
+
+namespace tetwild {
+
+int comformalAMIPSEnergy_sse2(const double* const* T, double* E, double* O, int n) {
+    return comformalAMIPSEnergyKernel<V>(T, E, O, n);
+}
+
+int comformalAMIPSNewton_sse2(const double* const* T, double* E, double* const* J, double* const* H, int n) {
+    return comformalAMIPSNewtonKernel<V>(T, E, J, H, n);
+}
+
+int comformalAMIPSCubeBounds_sse2(const float* const* D, float* lower, float* upper, int n) {
+    return comformalAMIPSCubeBoundsKernel<F>(D, lower, upper, n);
+}
+
+} // namespace tetwild
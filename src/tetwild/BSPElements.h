@@ -11,15 +11,15 @@
 
 #ifndef NEW_GTET_BSPELEMENTS_H
 #define NEW_GTET_BSPELEMENTS_H
+#include <tetwild/FlatSet.h>
 #include <vector>
-#include <unordered_set>
 
 namespace tetwild {
 
 class BSPEdge{
 public:
     std::vector<int> vertices;
-    std::unordered_set<int> conn_faces;
+    FlatSet conn_faces;
 
     BSPEdge(){}
     BSPEdge(int v1, int v2){
@@ -31,8 +31,8 @@ class BSPFace{
 public:
     std::vector<int> vertices;
     std::vector<int> edges;
-    std::unordered_set<int> conn_nodes;
-    std::unordered_set<int> div_faces;
+    FlatSet conn_nodes;
+    FlatSet div_faces;
 
     int matched_f_id=-1;
 };
@@ -41,7 +41,7 @@ class BSPtreeNode{
 public:
     bool is_leaf=false;
     std::vector<int> faces;
-    std::unordered_set<int> div_faces;
+    FlatSet div_faces;
 };
 
 } // namespace tetwild
@@ -262,7 +262,7 @@ void BSPSubdivision::subdivideBSPNodes() {
                 nodes[*it].faces.push_back(new_f_id);
             }
             ///re-assign divfaces for pos_face & neg_face
-            std::unordered_set<int> tmp_df_ids = faces[old_f_id].div_faces;
+            FlatSet tmp_df_ids = faces[old_f_id].div_faces;
             for(auto it=tmp_df_ids.begin(); it!=tmp_df_ids.end();it++) {
                 int side = divfaceSide(pln, div_faces[*it], div_vertices);
                 if (side == DIVFACE_POS)
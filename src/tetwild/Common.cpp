@@ -35,7 +35,12 @@ void addRecord(const MeshRecord& record, const Args &args, const State &state) {
     f << record.op << "," << record.timing << "," << record.n_v << "," << record.n_t << ","
       << record.min_min_d_angle << "," << record.avg_min_d_angle << ","
       << record.max_max_d_angle << "," << record.avg_max_d_angle << ","
-      << record.max_energy << "," << record.avg_energy << "\n";
+      << record.max_energy << "," << record.avg_energy << ","
+      << record.envelope.n_calls << "," << record.envelope.n_out << ","
+      << record.envelope.n_samples << "," << record.envelope.n_samples_queried << ","
+      << record.envelope.n_grid_decided << "," << record.envelope.n_packets << ","
+      << record.envelope.n_hint_hits << "," << record.envelope.n_nodes << ","
+      << record.envelope.n_leaves << "\n";
     f.close();
 }
 
@@ -139,6 +144,47 @@ void setIntersection(const std::unordered_set<int>& s1, const std::unordered_set
 #endif
 }
 
+bool isHaveCommonEle(const ConnTets& v1, const ConnTets& v2) {
+    if (v2.size() < v1.size()) {
+        return isHaveCommonEle(v2, v1);
+    }
+    for (int x : v1) {
+        if (v2.count(x)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void setIntersection(const ConnTets& s1, const ConnTets& s2, std::vector<int>& s) {
+    if (s2.size() < s1.size()) { setIntersection(s2, s1, s); return; }
+    s.clear();
+    s.reserve(s1.size());
+    for (int x : s1) {
+        if (s2.count(x)) {
+            s.push_back(x);
+        }
+    }
+    std::sort(s.begin(), s.end());
+}
+
+void setIntersection(const ConnTets& s1, const ConnTets& s2, std::unordered_set<int>& s) {
+    std::vector<int> tmp;
+    setIntersection(s1, s2, tmp);
+    s.clear();
+    s.insert(tmp.begin(), tmp.end());
+}
+
+void setIntersection(const ConnTets& s1, const std::unordered_set<int>& s2, std::unordered_set<int>& s) {
+    std::unordered_set<int> tmp;//s2 and s may be the same set
+    for (int x : s1) {
+        if (s2.count(x)) {
+            tmp.insert(x);
+        }
+    }
+    s.swap(tmp);
+}
+
 
 void sampleTriangle(const std::array<GEO::vec3, 3>& vs, std::vector<GEO::vec3>& ps, const double sampling_dist) {
     double sqrt3_2 = std::sqrt(3) / 2;
@@ -254,4 +300,137 @@ void sampleTriangle(const std::array<GEO::vec3, 3>& vs, std::vector<GEO::vec3>&
 //    }
 }
 
+
+void TriangleSampler::init(const std::array<GEO::vec3, 3>& vs, const double sampling_dist) {
+    //same samples as sampleTriangle(), the vertices of the triangle being probes
+    runs.clear();
+    n_probes = 0;
+    probe_i = 0;
+    run_i = 0;
+    k = -1;
+
+    double sqrt3_2 = std::sqrt(3) / 2;
+    std::array<double, 3> ls;
+    for (int i = 0; i < 3; i++) {
+        ls[i] = GEO::length2(vs[i] - vs[(i + 1) % 3]);
+    }
+    int max_i = std::max_element(ls.begin(), ls.end()) - ls.begin();
+    GEO::vec3 v0 = vs[max_i];
+    GEO::vec3 v1 = vs[(max_i + 1) % 3];
+    GEO::vec3 v2 = vs[(max_i + 2) % 3];
+    probes[n_probes++] = v0;
+    probes[n_probes++] = v1;
+    probes[n_probes++] = v2;
+
+    double N = sqrt(ls[max_i]) / sampling_dist;
+    if (N <= 1) {
+        level = -1;
+        return;
+    }
+    if (N == int(N))
+        N -= 1;
+    probes[n_probes++] = (1.0 / 3) * (v0 + v1 + v2);
+
+    GEO::vec3 n_v0v1 = GEO::normalize(v1 - v0);
+    runs.push_back({v0, n_v0v1 * sampling_dist, 1, int(N) + 1, NO_ROW});
+
+    double h = GEO::distance(GEO::dot((v2 - v0), (v1 - v0)) * (v1 - v0) / ls[max_i] + v0, v2);
+    int M = h / (sqrt3_2 * sampling_dist);
+    if (M >= 1) {
+        GEO::vec3 n_v0v2 = GEO::normalize(v2 - v0);
+        GEO::vec3 n_v1v2 = GEO::normalize(v2 - v1);
+        double sin_v0 = GEO::length(GEO::cross((v2 - v0), (v1 - v0))) / (GEO::distance(v0, v2) * GEO::distance(v0, v1));
+        double tan_v0 = GEO::length(GEO::cross((v2 - v0), (v1 - v0))) / GEO::dot((v2 - v0), (v1 - v0));
+        double sin_v1 = GEO::length(GEO::cross((v2 - v1), (v0 - v1))) / (GEO::distance(v1, v2) * GEO::distance(v0, v1));
+
+        for (int m = 1; m <= M; m++) {
+            int n = sqrt3_2 / tan_v0 * m + 0.5;
+            int n1 = sqrt3_2 / tan_v0 * m;
+            if (m % 2 == 0 && n == n1) {
+                n += 1;
+            }
+            GEO::vec3 v0_m = v0 + m * sqrt3_2 * sampling_dist / sin_v0 * n_v0v2;
+            GEO::vec3 v1_m = v1 + m * sqrt3_2 * sampling_dist / sin_v1 * n_v1v2;
+            if (GEO::distance(v0_m, v1_m) <= sampling_dist)
+                break;
+
+            double delta_d = ((n + (m % 2) / 2.0) - m * sqrt3_2 / tan_v0) * sampling_dist;
+            GEO::vec3 v = v0_m + delta_d * n_v0v1;
+            int N1 = GEO::distance(v, v1_m) / sampling_dist;
+            int row_level = 0;
+            while (((m >> row_level) & 1) == 0)
+                row_level++;
+            runs.push_back({v, n_v0v1 * sampling_dist, 0, N1 + 1, row_level});
+        }
+
+        //sample edges
+        for (int j = 1; j < 3; j++) {
+            const GEO::vec3& a = vs[(max_i + j) % 3];
+            const GEO::vec3& b = vs[(max_i + j + 1) % 3];
+            double N2 = sqrt(ls[(max_i + j) % 3]) / sampling_dist;
+            if (N2 > 1) {
+                if (N2 == int(N2))
+                    N2 -= 1;
+                runs.push_back({a, GEO::normalize(b - a) * sampling_dist, 1, int(N2) + 1, NO_ROW});
+            }
+        }
+    }
+
+    int max_index = runs.size();
+    for (const Run& r: runs)
+        max_index = std::max(max_index, r.end - 1);
+    level = 0;
+    while ((2 << level) <= max_index)
+        level++;
+}
+
+int TriangleSampler::next(GEO::vec3* ps, int n) {
+    int cnt = 0;
+    while (cnt < n) {
+        if (probe_i < n_probes) {
+            ps[cnt++] = probes[probe_i++];
+            continue;
+        }
+        if (level < 0)
+            break;
+        if (run_i == runs.size()) {
+            level--;
+            run_i = 0;
+            continue;
+        }
+
+        const Run& r = runs[run_i];
+        if (k < 0) {
+            //the sample k of the row r is at level min(tz(r), tz(k)) (trailing zeros), the first row and the edges
+            //have no row level, so that their samples are spread over all the levels
+            int s = 1 << level;
+            if (r.row_level == level) {
+                k = 0;
+                stride = s;
+            } else if (r.row_level > level) {
+                k = s;
+                stride = 2 * s;
+            } else {
+                run_i++;
+                continue;
+            }
+        }
+        if (k >= r.end) {
+            run_i++;
+            k = -1;
+            continue;
+        }
+        ps[cnt++] = r.start + double(k) * r.step;
+        k += stride;
+    }
+    return cnt;
+}
+
+int TriangleSampler::count() const {
+    int cnt = n_probes;
+    for (const Run& r: runs)
+        cnt += std::max(r.end - r.first, 0);
+    return cnt;
+}
+
 } // namespace tetwild
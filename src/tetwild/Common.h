@@ -12,7 +12,9 @@
 #pragma once
 
 #include <tetwild/ForwardDecls.h>
+#include <tetwild/ConnTets.h>
 #include <geogram/basic/geometry.h>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 
@@ -25,8 +27,46 @@ void pausee();
 bool isHaveCommonEle(const std::unordered_set<int>& v1, const std::unordered_set<int>& v2);
 void setIntersection(const std::unordered_set<int>& s1, const std::unordered_set<int>& s2, std::unordered_set<int>& s);
 void setIntersection(const std::unordered_set<int>& s1, const std::unordered_set<int>& s2, std::vector<int>& s);
+bool isHaveCommonEle(const ConnTets& v1, const ConnTets& v2);
+void setIntersection(const ConnTets& s1, const ConnTets& s2, std::vector<int>& s);
+void setIntersection(const ConnTets& s1, const ConnTets& s2, std::unordered_set<int>& s);
+void setIntersection(const ConnTets& s1, const std::unordered_set<int>& s2, std::unordered_set<int>& s);
 void sampleTriangle(const std::array<GEO::vec3, 3>& vs, std::vector<GEO::vec3>& ps, double sampling_dist);
 
+///lazy version of sampleTriangle(), generating the samples from coarse to fine: the vertices and the centroid,
+///then the samples at every 2^L rows and columns of the lattice for decreasing L, each sample once
+///a test over all the samples can stop at the first one that fails, before the others are generated
+class TriangleSampler {
+public:
+    void init(const std::array<GEO::vec3, 3>& vs, double sampling_dist);
+    ///writes up to n next samples to ps, returns how many, 0 once all are generated
+    int next(GEO::vec3* ps, int n);
+    int count() const;
+
+private:
+    static const int NO_ROW = std::numeric_limits<int>::max();
+
+    ///the samples start + k * step for first <= k < end
+    struct Run {
+        GEO::vec3 start;
+        GEO::vec3 step;
+        int first;
+        int end;
+        int row_level;//number of trailing zeros of the row index, NO_ROW for the first row and the edges
+    };
+
+    std::array<GEO::vec3, 4> probes;
+    int n_probes = 0;
+    std::vector<Run> runs;
+
+    //position of the next sample
+    int probe_i = 0;
+    int level = -1;
+    int run_i = 0;
+    int k = -1;
+    int stride = 1;
+};
+
 void addRecord(const MeshRecord& record, const Args &args, const State &state);
 
 } // namespace tetwild
@@ -0,0 +1,94 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace tetwild {
+
+///vertex-to-tet adjacency of a single vertex
+///the ids are stored unordered in a small inline array, and moved to the heap only when the one-ring is large
+///insert/erase/count are linear scans over a few contiguous ints, erase swaps with the last element
+class ConnTets {
+public:
+    static const int INLINE_SIZE = 24;//a vertex has ~20 adjacent tets on average
+
+    typedef int* iterator;
+    typedef const int* const_iterator;
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size(); }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size(); }
+
+    int size() const { return heap.empty() ? n_inline : (int) heap.size(); }
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        n_inline = 0;
+        std::vector<int>().swap(heap);
+    }
+
+    const_iterator find(int t_id) const { return std::find(begin(), end(), t_id); }
+    iterator find(int t_id) { return std::find(begin(), end(), t_id); }
+    int count(int t_id) const { return find(t_id) != end() ? 1 : 0; }
+
+    void insert(int t_id) {
+        if (count(t_id))
+            return;
+        if (heap.empty() && n_inline < INLINE_SIZE) {
+            buf[n_inline++] = t_id;
+            return;
+        }
+        if (heap.empty()) {
+            heap.reserve(2 * INLINE_SIZE);
+            heap.assign(buf.begin(), buf.begin() + n_inline);
+            n_inline = 0;
+        }
+        heap.push_back(t_id);
+    }
+
+    template<typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    void erase(const_iterator it) {
+        if (it == end())
+            return;
+        int *p = data() + (it - data());
+        *p = *(end() - 1);
+        if (heap.empty())
+            n_inline--;
+        else
+            heap.pop_back();
+    }
+
+    int erase(int t_id) {
+        const_iterator it = find(t_id);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+private:
+    int* data() { return heap.empty() ? buf.data() : heap.data(); }
+    const int* data() const { return heap.empty() ? buf.data() : heap.data(); }
+
+    std::array<int, INLINE_SIZE> buf;
+    int n_inline = 0;
+    std::vector<int> heap;//non-empty iff the ids overflowed the inline buffer
+};
+
+} // namespace tetwild
@@ -0,0 +1,81 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Jeremie Dumas <jeremie.dumas@ens-lyon.org>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Created by Jeremie Dumas on 09/04/18.
+//
+
+#include <tetwild/DistanceQuery.h>
+#include <tetwild/ProgressHandler.h>
+#include <igl/Timer.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace tetwild {
+
+void benchmarkEnvelopeTree(GEO::MeshFacetsAABBWithEps& tree, const GEO::Mesh& M, double eps_2) {
+    const int packet_size = GEO::MeshFacetsAABBWithEps::PACKET_SIZE;
+    const int n = std::min((int) M.facets.nb(), 100000);
+    const double eps = std::sqrt(eps_2);
+
+    //fixed seed, so that the runs compare the same queries
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> bary(0, 1);
+    std::uniform_real_distribution<double> offset(-1.5 * eps, 1.5 * eps);
+    std::vector<GEO::vec3> ps;
+    ps.reserve(n * packet_size);
+    for (int i = 0; i < n; i++) {
+        GEO::index_t f = GEO::index_t((long long) i * M.facets.nb() / n);
+        const GEO::vec3& p1 = GEO::Geom::mesh_vertex(M, M.facets.vertex(f, 0));
+        const GEO::vec3& p2 = GEO::Geom::mesh_vertex(M, M.facets.vertex(f, 1));
+        const GEO::vec3& p3 = GEO::Geom::mesh_vertex(M, M.facets.vertex(f, 2));
+        for (int k = 0; k < packet_size; k++) {
+            double a = bary(gen);
+            double b = bary(gen);
+            if (a + b > 1) {
+                a = 1 - a;
+                b = 1 - b;
+            }
+            GEO::vec3 o(offset(gen), offset(gen), offset(gen));
+            ps.push_back(p1 + a * (p2 - p1) + b * (p3 - p1) + o);
+        }
+    }
+
+    const bool is_wide = tree.is_wide_layout();
+    igl::Timer timer;
+    for (bool wide : {false, true}) {
+        tree.set_wide_layout(wide);
+
+        int n_out = 0;
+        timer.start();
+        for (const GEO::vec3& p : ps) {
+            GEO::vec3 nearest_point;
+            double sq_dist;
+            tree.facet_in_envelope(p, eps_2, nearest_point, sq_dist);
+            if (sq_dist > eps_2)
+                n_out++;
+        }
+        double point_time = timer.getElapsedTime();
+
+        int n_packets_out = 0;
+        timer.start();
+        for (int i = 0; i < ps.size(); i += packet_size) {
+            GEO::index_t hint_facet = GEO::NO_FACET;
+            if (tree.points_in_envelope(&ps[i], packet_size, eps_2, hint_facet) < packet_size)
+                n_packets_out++;
+        }
+        double packet_time = timer.getElapsedTime();
+
+        ProgressHandler::Info("envelope tree, {} layout: {} points {}s ({} out), {} packets {}s ({} out)",
+                              wide ? "wide" : "binary", ps.size(), point_time, n_out, n, packet_time, n_packets_out);
+    }
+    tree.set_wide_layout(is_wide);
+}
+
+} // namespace tetwild
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <tetwild/geogram/mesh_AABB.h>
 #include <string>
 #include <geogram/mesh/mesh.h>
 #include <geogram/mesh/mesh_geometry.h>
@@ -38,4 +39,8 @@ inline void get_point_facet_nearest_point(
     );
 }
 
+///times the same envelope queries on the binary and the wide layouts of the tree, and logs both
+///the queries are PACKET_SIZE points per sampled facet of M, within about 1.5 eps of it
+void benchmarkEnvelopeTree(GEO::MeshFacetsAABBWithEps& tree, const GEO::Mesh& M, double eps_2);
+
 } // namespace tetwild
@@ -77,7 +77,7 @@ void EdgeCollapser::init() {
     counter = 0;
     suc_counter = 0;
     breakdown_timing = {{0, 0, 0, 0, 0}};
-    breakdown_timing0 = {{0, 0}};
+    envelope_query.resetStats();
 }
 
 void EdgeCollapser::collapse() {
@@ -202,8 +202,9 @@ void EdgeCollapser::collapse() {
 //        }
 //        logger().debug("{} {} {} {}", cnt_flip, cnt_quality, cnt_envelop, cnt_suc);
 
-        ProgressHandler::Debug("{}: {}s", breakdown_name0[id_sampling], breakdown_timing0[id_sampling]);
-        ProgressHandler::Debug("{}: {}s", breakdown_name0[id_aabb], breakdown_timing0[id_aabb]);
+        for (int i = 0; i < envelope_query.breakdown_timing.size(); i++)
+            ProgressHandler::Debug("{}: {}s", envelope_query.breakdown_name[i], envelope_query.breakdown_timing[i]);
+        ProgressHandler::Debug("Envelop_cache: {} hits / {} queries", envelope_query.cache.hitCount(), envelope_query.cache.queryCount());
         ProgressHandler::Debug("----");
         for (int i = 0; i < breakdown_timing.size(); i++)
             ProgressHandler::Debug("{}: {}s", breakdown_name[i], breakdown_timing[i]);
@@ -284,7 +285,7 @@ void EdgeCollapser::postProcess() {
 int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
     bool is_edge_too_short = false;
     bool is_edge_degenerate = false;
-    double length = sqrt(CGAL::squared_distance(tet_vertices[v1_id].posf, tet_vertices[v2_id].posf));
+    double length = sqrt(vertex_store.squaredDistance(v1_id, v2_id));
     if(length == 0) {
         is_edge_degenerate = true;
     }
@@ -297,19 +298,19 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
 //    }
 
     //check isolated
-    if(tet_vertices[v1_id].is_on_surface && isIsolated(v1_id)) {
-        tet_vertices[v1_id].is_on_surface = false;
-        tet_vertices[v1_id].is_on_boundary = false;
+    if(vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) && isIsolated(v1_id)) {
+        vertex_store.set(v1_id, TetVertexStore::ON_SURFACE, false);
+        vertex_store.set(v1_id, TetVertexStore::ON_BOUNDARY, false);
         tet_vertices[v1_id].on_fixed_vertex = -1;
         tet_vertices[v1_id].on_face.clear();
         tet_vertices[v1_id].on_edge.clear();
     }
     if(!isBoundaryPoint(v1_id))
-        tet_vertices[v1_id].is_on_boundary = false;
+        vertex_store.set(v1_id, TetVertexStore::ON_BOUNDARY, false);
 
     //check boundary
-    if(tet_vertices[v1_id].is_on_boundary && !tet_vertices[v2_id].is_on_boundary)
-        if(!is_edge_degenerate && isPointOutBoundaryEnvelop(tet_vertices[v2_id].posf)) {
+    if(vertex_store.is(v1_id, TetVertexStore::ON_BOUNDARY) && !vertex_store.is(v2_id, TetVertexStore::ON_BOUNDARY))
+        if(!is_edge_degenerate && isPointOutBoundaryEnvelop(vertex_store.posf(v2_id))) {
 //            if(is_edge_too_short) {
 //                logger().debug("v2 bonndary");
 //                logger().debug("v1 boundary = {}", isPointOutBoundaryEnvelop(tet_vertices[v1_id].posf));
@@ -318,8 +319,8 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
         }
 
     //check envelop
-    if(tet_vertices[v1_id].is_on_surface && !tet_vertices[v2_id].is_on_surface){
-        if(!is_edge_degenerate && isPointOutEnvelop(tet_vertices[v2_id].posf)) {
+    if(vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) && !vertex_store.is(v2_id, TetVertexStore::ON_SURFACE)){
+        if(!is_edge_degenerate && isPointOutEnvelop(vertex_store.posf(v2_id))) {
 //            if(is_edge_too_short) {
 //                logger().debug("v2 envelop");
 //                logger().debug("v1 envelop = {}", isPointOutEnvelop(tet_vertices[v1_id].posf));
@@ -329,17 +330,16 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
     }
 
     //old_t_ids
-    std::vector<int> old_t_ids;
-    old_t_ids.reserve(tet_vertices[v1_id].conn_tets.size());
-    for (auto it = tet_vertices[v1_id].conn_tets.begin(); it != tet_vertices[v1_id].conn_tets.end(); it++)
-        old_t_ids.push_back(*it);
-    std::vector<bool> is_removed(old_t_ids.size(), false);
+    std::vector<int>& old_t_ids = scratch.old_t_ids.get();
+    old_t_ids.insert(old_t_ids.end(), tet_vertices[v1_id].conn_tets.begin(), tet_vertices[v1_id].conn_tets.end());
+    std::vector<bool>& is_removed = scratch.is_removed.get();
+    is_removed.resize(old_t_ids.size(), false);
 
     //new_tets
-    std::vector<std::array<int, 4>> new_tets;
+    std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
     new_tets.reserve(old_t_ids.size());
-    std::unordered_set<int> n12_v_ids;
-    std::vector<int> n12_t_ids;
+    std::vector<int>& n12_v_ids = scratch.n12_v_ids.get();//sorted and unique after the loop
+    std::vector<int>& n12_t_ids = scratch.n12_t_ids.get();
     for (int i = 0; i < old_t_ids.size(); i++) {
         auto it = std::find(tets[old_t_ids[i]].begin(), tets[old_t_ids[i]].end(), v2_id);
         if (it == tets[old_t_ids[i]].end()) {
@@ -351,10 +351,12 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
             is_removed[i] = true;
             for (int j = 0; j < 4; j++)
                 if (tets[old_t_ids[i]][j] != v1_id && tets[old_t_ids[i]][j] != v2_id)
-                    n12_v_ids.insert(tets[old_t_ids[i]][j]);
+                    n12_v_ids.push_back(tets[old_t_ids[i]][j]);
             n12_t_ids.push_back(old_t_ids[i]);
         }
     }
+    std::sort(n12_v_ids.begin(), n12_v_ids.end());
+    n12_v_ids.erase(std::unique(n12_v_ids.begin(), n12_v_ids.end()), n12_v_ids.end());
 
     //check is_valid
     //check 1 //todo: look in details later
@@ -388,13 +390,28 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
 //            logger().debug("flip");
         return FLIP;
     }
-    std::vector<TetQuality> tet_qs;
+    std::vector<TetQuality>& tet_qs = scratch.tet_qs.get();
     igl::Timer tmp_timer;
     tmp_timer.start();
-    calTetQualities(new_tets, tet_qs);
+    //most checks are decided by the float bounds of the energies, the accepted ones get their energies before the update
+    bool is_quality_screened = false;
+    if (energy_type != state.ENERGY_NA && is_check_quality && !is_edge_degenerate && vertex_store.is(v1_id, TetVertexStore::ROUNDED)) {
+        TetQuality old_tq;
+        getCheckQuality(old_t_ids, old_tq);
+        if (is_soft)
+            old_tq.slim_energy = soft_energy;
+        int screen = screenTetQualities(new_tets, old_tq.slim_energy);
+        if (screen == SCREEN_REJECT) {
+            energy_time += tmp_timer.getElapsedTime();
+            return QUALITY;
+        }
+        is_quality_screened = screen == SCREEN_ACCEPT;
+    }
+    if (!is_quality_screened)
+        calTetQualities(new_tets, tet_qs);
     energy_time+=tmp_timer.getElapsedTime();
 
-    if (energy_type != state.ENERGY_NA && is_check_quality) {
+    if (energy_type != state.ENERGY_NA && is_check_quality && !is_quality_screened) {
         TetQuality old_tq, new_tq;
         getCheckQuality(old_t_ids, old_tq);
         getCheckQuality(tet_qs, new_tq);
@@ -405,7 +422,7 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
 //        }
         if(is_soft)
             old_tq.slim_energy = soft_energy;
-        if (!tet_vertices[v1_id].is_rounded) //remove an unroundable vertex anyway
+        if (!vertex_store.is(v1_id, TetVertexStore::ROUNDED)) //remove an unroundable vertex anyway
             new_tq.slim_energy = 0;
         if (!is_edge_degenerate && !new_tq.isBetterOrEqualThan(old_tq, energy_type, state)) {
 //            if (is_edge_too_short)
@@ -415,25 +432,26 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
     }
 
     //check 2.5
-    if (tet_vertices[v1_id].is_on_boundary) {
-        Point_3 old_p = tet_vertices[v1_id].pos;
-        Point_3f old_pf = tet_vertices[v1_id].posf;
-        tet_vertices[v1_id].posf = tet_vertices[v2_id].posf;
-        tet_vertices[v1_id].pos = tet_vertices[v2_id].pos;
+    if (vertex_store.is(v1_id, TetVertexStore::ON_BOUNDARY)) {
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v1_id);
+        Point_3f old_pf = vertex_store.posf(v1_id);
+        uint64_t old_version = vertex_store.versions[v1_id];
+        vertex_store.setPosf(v1_id, vertex_store.posf(v2_id));
+        vertex_store.restorePos(v1_id, vertex_store.savePos(v2_id));
         if (!is_edge_degenerate && isBoundarySlide(v1_id, v2_id, old_pf)) {
-            tet_vertices[v1_id].posf = old_pf;
-            tet_vertices[v1_id].pos = old_p;
+            vertex_store.restorePosf(v1_id, old_pf, old_version);
+            vertex_store.restorePos(v1_id, old_p);
 //            if (is_edge_too_short)
 //                logger().debug("boundary");
             return ENVELOP;
         }
-        tet_vertices[v1_id].posf = old_pf;
-        tet_vertices[v1_id].pos = old_p;
+        vertex_store.restorePosf(v1_id, old_pf, old_version);
+        vertex_store.restorePos(v1_id, old_p);
     }
 
     //check 3
     bool is_envelop_suc = false;
-    if (state.eps != state.EPSILON_NA && state.eps != state.EPSILON_INFINITE && tet_vertices[v1_id].is_on_surface) {
+    if (state.eps != state.EPSILON_NA && state.eps != state.EPSILON_INFINITE && vertex_store.is(v1_id, TetVertexStore::ON_SURFACE)) {
         if (!is_edge_degenerate && !isCollapsable_epsilon(v1_id, v2_id)) {
 //            if (is_edge_too_short)
 //                logger().debug("envelop");
@@ -446,48 +464,50 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
     }
 
 
+    if (is_quality_screened) {
+        tmp_timer.start();
+        calTetQualities(new_tets, tet_qs);
+        energy_time += tmp_timer.getElapsedTime();
+    }
+
     //real update
 //    if(is_edge_too_short)
 //        logger().debug("success");
-    if(tet_vertices[v1_id].is_on_boundary)
-        tet_vertices[v2_id].is_on_boundary=true;
+    if(vertex_store.is(v1_id, TetVertexStore::ON_BOUNDARY)) {
+        vertex_store.set(v2_id, TetVertexStore::ON_BOUNDARY, true);
+    }
 
-    std::vector<std::array<int, 2>> update_sf_t_ids(n12_t_ids.size(), std::array<int, 2>());
-    if (tet_vertices[v1_id].is_on_surface || tet_vertices[v2_id].is_on_surface) {
+    std::vector<std::array<int, 2>>& update_sf_t_ids = scratch.update_sf_t_ids.get();
+    update_sf_t_ids.resize(n12_t_ids.size(), std::array<int, 2>());
+    if (vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) || vertex_store.is(v2_id, TetVertexStore::ON_SURFACE)) {
         for (int i = 0; i < n12_t_ids.size(); i++) {
             for (int j = 0; j < 4; j++) {
-                if (tets[n12_t_ids[i]][j] == v1_id || tets[n12_t_ids[i]][j] == v2_id) {
-                    std::vector<int> ts;
-                    getFaceConnTets(tets[n12_t_ids[i]][(j + 1) % 4], tets[n12_t_ids[i]][(j + 2) % 4],
-                                    tets[n12_t_ids[i]][(j + 3) % 4], ts);
-
-//                    if(ts.size() != 2) {
-//                        logger().debug("ts.size() != 2 but = {}", ts.size());
-//                        logger().debug("v1 info:");
-//                        tet_vertices[v1_id].printInfo();
-//                        logger().debug("v2 info:");
-//                        tet_vertices[v2_id].printInfo();
-//
-//                        tet_vertices[tets[n12_t_ids[i]][(j + 1) % 4]].printInfo();
-//                        tet_vertices[tets[n12_t_ids[i]][(j + 2) % 4]].printInfo();
-//                        tet_vertices[tets[n12_t_ids[i]][(j + 3) % 4]].printInfo();
-//                        pausee();
-//                    }
-
-                    if(tets[n12_t_ids[i]][j] == v1_id)
-                        update_sf_t_ids[i][1] = ts[0] != n12_t_ids[i] ? ts[0] : ts[1];
-                    else
-                        update_sf_t_ids[i][0] = ts[0] != n12_t_ids[i] ? ts[0] : ts[1];
-                }
+                if (tets[n12_t_ids[i]][j] == v1_id)
+                    update_sf_t_ids[i][1] = opp_tets[n12_t_ids[i]][j];
+                else if (tets[n12_t_ids[i]][j] == v2_id)
+                    update_sf_t_ids[i][0] = opp_tets[n12_t_ids[i]][j];
             }
         }
     }
 
-    std::unordered_set<int> n1_v_ids;
+    //the tets across the faces opposite to v1 are outside the one-ring, but their tags are changed as well
+    //-1 across a face of the hull
+    std::vector<int>& sf_t_ids = scratch.t_ids.get();
+    if (vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) || vertex_store.is(v2_id, TetVertexStore::ON_SURFACE)) {
+        for (int i = 0; i < update_sf_t_ids.size(); i++)
+            if (update_sf_t_ids[i][1] >= 0)
+                sf_t_ids.push_back(update_sf_t_ids[i][1]);
+        std::sort(sf_t_ids.begin(), sf_t_ids.end());
+        sf_t_ids.erase(std::unique(sf_t_ids.begin(), sf_t_ids.end()), sf_t_ids.end());
+    }
+    unindexSurfaceTets(old_t_ids);
+    unindexSurfaceTets(sf_t_ids);
+
+    std::vector<int>& n1_v_ids = scratch.n1_v_ids.get();
     int cnt = 0;
     for (int i = 0; i < old_t_ids.size(); i++) {
         if (is_removed[i]) {
-            t_is_removed[old_t_ids[i]] = true;
+            removeTet(old_t_ids[i]);
             for (int j = 0; j < 4; j++)
                 if (tets[old_t_ids[i]][j] != v1_id && tets[old_t_ids[i]][j] != v2_id) {
                     tet_vertices[tets[old_t_ids[i]][j]].conn_tets.erase(
@@ -498,27 +518,34 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
                                                           tet_vertices[v2_id].conn_tets.end(), old_t_ids[i]));
         } else {
             tet_vertices[v2_id].conn_tets.insert(old_t_ids[i]);
-            tet_qualities[old_t_ids[i]] = tet_qs[cnt];
             for (int j = 0; j < 4; j++) {
                 if (tets[old_t_ids[i]][j] != v1_id)
-                    n1_v_ids.insert(tets[old_t_ids[i]][j]);//n12_v_ids would still be inserted
+                    n1_v_ids.push_back(tets[old_t_ids[i]][j]);//n12_v_ids would still be inserted
             }
             tets[old_t_ids[i]] = new_tets[cnt];
+            setTetQuality(old_t_ids[i], tet_qs[cnt]);
             cnt++;
         }
     }
+    std::vector<int>& changed_t_ids = scratch.changed_t_ids.get();
+    for (int i = 0; i < old_t_ids.size(); i++) {
+        if (!is_removed[i])
+            changed_t_ids.push_back(old_t_ids[i]);
+    }
+    updateOppTets(changed_t_ids);
 
 
-    if (tet_vertices[v1_id].is_on_surface || tet_vertices[v2_id].is_on_surface) {
-        tet_vertices[v2_id].is_on_surface = true;
+    if (vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) || vertex_store.is(v2_id, TetVertexStore::ON_SURFACE)) {
+        vertex_store.set(v2_id, TetVertexStore::ON_SURFACE, true);
 
         bool is_check_isolated = false;
         for (int i = 0; i < n12_t_ids.size(); i++) {
             std::array<int, 2> is_sf_fs;
-            std::vector<int> es;
+            std::array<int, 2> es;
+            int es_cnt = 0;
             for (int j = 0; j < 4; j++) {
                 if (tets[n12_t_ids[i]][j] != v1_id && tets[n12_t_ids[i]][j] != v2_id)
-                    es.push_back(tets[n12_t_ids[i]][j]);
+                    es[es_cnt++] = tets[n12_t_ids[i]][j];
                 else if (tets[n12_t_ids[i]][j] == v1_id)
                     is_sf_fs[0] = is_surface_fs[n12_t_ids[i]][j];
                 else
@@ -551,17 +578,20 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
             is_sf_fs[0] += -tmp1;
             is_sf_fs[1] += -tmp0;
 
-            for (int j = 0; j < 4; j++) {
-                int v_id0 = tets[update_sf_t_ids[i][0]][j];
-                if (v_id0 != v2_id && v_id0 != es[0] && v_id0 != es[1])
-                    is_surface_fs[update_sf_t_ids[i][0]][j] = is_sf_fs[0];
-
-                int v_id1 = tets[update_sf_t_ids[i][1]][j];
-                if (v_id1 != v2_id && v_id1 != es[0] && v_id1 != es[1])
-                    is_surface_fs[update_sf_t_ids[i][1]][j] = is_sf_fs[1];
+            for (int k = 0; k < 2; k++) {
+                int t_id = update_sf_t_ids[i][k];
+                if (t_id < 0)//no tet across a face of the hull
+                    continue;
+                for (int j = 0; j < 4; j++) {
+                    int v_id = tets[t_id][j];
+                    if (v_id != v2_id && v_id != es[0] && v_id != es[1])
+                        is_surface_fs[t_id][j] = is_sf_fs[k];
+                }
             }
         }
     }
+    indexSurfaceTets(changed_t_ids);
+    indexSurfaceTets(sf_t_ids);
 
     //update boundary points //todo: Pls figure out a more efficient way
 //    if(tet_vertices[v2_id].is_on_boundary && !isBoundaryPoint(v2_id)) {
@@ -575,7 +605,7 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
 //        }
 //    }
 
-    v_is_removed[v1_id] = true;
+    removeVertex(v1_id);
 
     //update time stamps
     ts++;
@@ -601,18 +631,11 @@ int EdgeCollapser::collapseAnEdge(int v1_id, int v2_id) {
 //    }
 
 //    logger().debug("{}{}jt==tri.end()", n1_v_ids.size(), "->";
-    std::vector<int> n1_v_ids_vec, n12_v_ids_vec;
-    n1_v_ids_vec.reserve(n1_v_ids.size());
-    n12_v_ids_vec.reserve(n12_v_ids.size());
-    for(auto it = n1_v_ids.begin(); it != n1_v_ids.end(); it++)
-        n1_v_ids_vec.push_back(*it);
-    for(auto it = n12_v_ids.begin(); it != n12_v_ids.end(); it++)
-        n12_v_ids_vec.push_back(*it);
-    std::sort(n1_v_ids_vec.begin(), n1_v_ids_vec.end());
-    std::sort(n12_v_ids_vec.begin(), n12_v_ids_vec.end());
-    n1_v_ids.clear();
-    std::set_difference(n1_v_ids_vec.begin(), n1_v_ids_vec.end(),n12_v_ids_vec.begin(), n12_v_ids_vec.end(),
-                        std::inserter(n1_v_ids, n1_v_ids.end()));
+    std::sort(n1_v_ids.begin(), n1_v_ids.end());
+    n1_v_ids.erase(std::unique(n1_v_ids.begin(), n1_v_ids.end()), n1_v_ids.end());
+    n1_v_ids.erase(std::remove_if(n1_v_ids.begin(), n1_v_ids.end(), [&](int v_id) {
+        return std::binary_search(n12_v_ids.begin(), n12_v_ids.end(), v_id);
+    }), n1_v_ids.end());
 
     for (auto it = n1_v_ids.begin(); it != n1_v_ids.end(); it++) {
         double weight = -1;
@@ -661,9 +684,9 @@ bool EdgeCollapser::isCollapsable_cd1(int v1_id, int v2_id) {
     bool is_movable = false;
     if (tet_vertices[v1_id].on_fixed_vertex < -1)
         return false;
-    if (tet_vertices[v1_id].is_on_bbox && !tet_vertices[v2_id].is_on_bbox)
+    if (vertex_store.is(v1_id, TetVertexStore::ON_BBOX) && !vertex_store.is(v2_id, TetVertexStore::ON_BBOX))
         return false;
-    else if (tet_vertices[v1_id].is_on_bbox && tet_vertices[v2_id].is_on_bbox) {
+    else if (vertex_store.is(v1_id, TetVertexStore::ON_BBOX) && vertex_store.is(v2_id, TetVertexStore::ON_BBOX)) {
         if (tet_vertices[v1_id].on_edge.size() == 0) {//inside the face
             is_movable = isHaveCommonEle(tet_vertices[v1_id].on_face, tet_vertices[v2_id].on_face);
         } else {//on the edge
@@ -711,7 +734,7 @@ bool EdgeCollapser::isCollapsable_cd3(int v1_id, int v2_id, double weight) {
     if (!is_limit_length)
         return true;
 
-    double adaptive_scale = (tet_vertices[v1_id].adaptive_scale + tet_vertices[v2_id].adaptive_scale) / 2;
+    double adaptive_scale = (vertex_store.adaptive_scale[v1_id] + vertex_store.adaptive_scale[v2_id]) / 2;
     if (weight < ideal_weight * adaptive_scale * adaptive_scale)
         return true;
 //    if (tet_vertices[v1_id].is_on_surface || tet_vertices[v2_id].is_on_surface) {
@@ -742,7 +765,7 @@ bool EdgeCollapser::isCollapsable_epsilon(int v1_id, int v2_id) {
 //        }
 //    }
 
-    std::vector<std::array<int, 3>> tri_ids;
+    std::vector<std::array<int, 3>>& tri_ids = scratch.tri_ids.get();
     for (auto it = tet_vertices[v1_id].conn_tets.begin(); it != tet_vertices[v1_id].conn_tets.end(); it++) {
         for (int j = 0; j < 4; j++) {
             if (tets[*it][j] != v1_id && is_surface_fs[*it][j] != state.NOT_SURFACE) {
@@ -755,21 +778,19 @@ bool EdgeCollapser::isCollapsable_epsilon(int v1_id, int v2_id) {
     std::sort(tri_ids.begin(), tri_ids.end());
     tri_ids.erase(std::unique(tri_ids.begin(), tri_ids.end()), tri_ids.end());
 
-    std::vector<Triangle_3f> tris;
+    std::vector<Triangle_3f>& tris = scratch.tris.get();
     for (int i = 0; i < tri_ids.size(); i++) {
         if (std::find(tri_ids[i].begin(), tri_ids[i].end(), v2_id) != tri_ids[i].end())
             continue;
         auto jt = std::find(tri_ids[i].begin(), tri_ids[i].end(), v1_id);
         *jt = v2_id;
-        Triangle_3f tri(tet_vertices[tri_ids[i][0]].posf, tet_vertices[tri_ids[i][1]].posf, tet_vertices[tri_ids[i][2]].posf);
+        Triangle_3f tri(vertex_store.posf(tri_ids[i][0]), vertex_store.posf(tri_ids[i][1]), vertex_store.posf(tri_ids[i][2]));
         tris.push_back(tri);
     }
 
     ///note that tris.size() can be 0 when v1 is on the boundary of the surface!!!
-    for (int i = 0; i < tris.size(); i++) {
-        if (isFaceOutEnvelop(tris[i]))
-            return false;
-    }
+    if (isFacesOutEnvelop(tris))
+        return false;
 
     return true;
 }
@@ -12,7 +12,6 @@
 #include <tetwild/EdgeRemover.h>
 #include <tetwild/Common.h>
 #include <tetwild/ProgressHandler.h>
-#include <unordered_map>
 
 namespace tetwild {
 
@@ -41,7 +40,7 @@ void EdgeRemover::init() {
 
     for (unsigned int i = 0; i < edges.size(); i++) {
         std::vector<int> t_ids;
-        setIntersection(tet_vertices[edges[i][0]].conn_tets, tet_vertices[edges[i][1]].conn_tets, t_ids);
+        getEdgeConnTets(edges[i][0], edges[i][1], t_ids);
         addNewEdge(edges[i]);
 //        if (isSwappable_cd1(edges[i])) {
 //            double weight = calEdgeLength(edges[i]);
@@ -54,8 +53,6 @@ void EdgeRemover::init() {
 
     counter = 0;
     suc_counter = 0;
-    t_empty_start = 0;
-    v_empty_start = 0;
 
     equal_buget = 100;
 }
@@ -75,7 +72,7 @@ void EdgeRemover::swap(){
             continue;
         }
 
-        std::vector<int> t_ids;
+        std::vector<int>& t_ids = scratch.t_ids.get();
         if(!isSwappable_cd1(ele.v_ids, t_ids, true)){
             er_queue.pop();
             continue;
@@ -133,7 +130,7 @@ bool EdgeRemover::removeAnEdge_32(int v1_id, int v2_id, const std::vector<int>&
 
     //new_tets
     std::array<int, 2> v_ids;
-    std::vector<std::array<int, 4>> new_tets;
+    std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
     std::array<int, 2> t_ids;
     int cnt = 0;
     for (int i = 0; i < 4; i++) {
@@ -157,12 +154,18 @@ bool EdgeRemover::removeAnEdge_32(int v1_id, int v2_id, const std::vector<int>&
     *it = v_ids[0];
 
     //check is_valid
-    std::vector<TetQuality> tet_qs;
+    std::vector<TetQuality>& tet_qs = scratch.tet_qs.get();
     if(isFlip(new_tets))
         return false;
     TetQuality old_tq, new_tq;
     getCheckQuality(old_t_ids, old_tq);
     tmp_timer.start();
+    if (screenTetQualities(new_tets, old_tq.slim_energy) == SCREEN_REJECT) {
+        energy_time += tmp_timer.getElapsedTime();
+        if (equal_buget > 0)
+            equal_buget--;
+        return false;
+    }
     calTetQualities(new_tets, tet_qs);
     energy_time+=tmp_timer.getElapsedTime();
     getCheckQuality(tet_qs, new_tq);
@@ -176,8 +179,8 @@ bool EdgeRemover::removeAnEdge_32(int v1_id, int v2_id, const std::vector<int>&
     }
 
     //real update
-    std::vector<std::array<int, 3>> fs;
-    std::vector<int> is_sf_fs;
+    std::vector<std::array<int, 3>>& fs = scratch.fs.get();
+    std::vector<int>& is_sf_fs = scratch.is_sf_fs.get();
     for(int i=0;i<old_t_ids.size();i++) {
         for (int j = 0; j < 4; j++) {
             if (tets[old_t_ids[i]][j] == v1_id || tets[old_t_ids[i]][j] == v2_id) {
@@ -190,7 +193,8 @@ bool EdgeRemover::removeAnEdge_32(int v1_id, int v2_id, const std::vector<int>&
         }
     }
 
-    t_is_removed[old_t_ids[0]] = true;
+    unindexSurfaceTets(old_t_ids);
+    removeTet(old_t_ids[0]);
     tets[t_ids[0]] = new_tets[0];//v2
     tets[t_ids[1]] = new_tets[1];//v1
 
@@ -231,27 +235,31 @@ bool EdgeRemover::removeAnEdge_32(int v1_id, int v2_id, const std::vector<int>&
                                                   tet_vertices[v1_id].conn_tets.end(), t_ids[0]));
     tet_vertices[v2_id].conn_tets.erase(std::find(tet_vertices[v2_id].conn_tets.begin(),
                                                   tet_vertices[v2_id].conn_tets.end(), t_ids[1]));
+    std::vector<int>& changed_t_ids = scratch.changed_t_ids.get();
+    changed_t_ids.insert(changed_t_ids.end(), t_ids.begin(), t_ids.end());
+    updateOppTets(changed_t_ids);
+    indexSurfaceTets(changed_t_ids);
 
     for (int i = 0; i < 2; i++) {
-        tet_qualities[t_ids[i]] = tet_qs[i];
+        setTetQuality(t_ids[i], tet_qs[i]);
     }
 
     //repush new edges
     //Note that you need to pop out the current element first!!
-    std::unordered_set<int> n12_v_ids;
-    for(int i=0;i<new_tets.size();i++){
-        for(int j=0;j<4;j++){
-            if(new_tets[i][j]!=v1_id && new_tets[i][j]!=v2_id)
-                n12_v_ids.insert(new_tets[i][j]);
-        }
-    }
-
+//    std::unordered_set<int> n12_v_ids;
+//    for(int i=0;i<new_tets.size();i++){
+//        for(int j=0;j<4;j++){
+//            if(new_tets[i][j]!=v1_id && new_tets[i][j]!=v2_id)
+//                n12_v_ids.insert(new_tets[i][j]);
+//        }
+//    }
+//
 //    for(auto it=n12_v_ids.begin();it!=n12_v_ids.end();it++) {
 //        addNewEdge(std::array<int, 2>({{*it, v1_id}}));
 //        addNewEdge(std::array<int, 2>({{*it, v2_id}}));
 //    }
 
-    std::vector<std::array<int, 2>> es;
+    std::vector<std::array<int, 2>>& es = scratch.es.get();
     es.reserve(new_tets.size()*6);
     for(int i=0;i<new_tets.size();i++) {
         for (int j = 0; j < 3; j++) {
@@ -279,8 +287,7 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
     if (old_t_ids.size() != N)
         return false;
 
-    std::vector<std::array<int, 3>> n12_es;
-    n12_es.reserve(old_t_ids.size());
+    std::array<std::array<int, 3>, N> n12_es;
     for (int i = 0; i < old_t_ids.size(); i++) {
         std::array<int, 3> e;
         int cnt = 0;
@@ -289,15 +296,16 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
                 e[cnt++] = tets[old_t_ids[i]][j];
             }
         e[cnt] = old_t_ids[i];
-        n12_es.push_back(e);
+        n12_es[i] = e;
     }
 
-    std::vector<int> n12_v_ids;
-    std::vector<int> n12_t_ids;
+    std::vector<int>& n12_v_ids = scratch.n12_v_ids.get();
+    std::vector<int>& n12_t_ids = scratch.n12_t_ids.get();
     n12_v_ids.push_back(n12_es[0][0]);
     n12_v_ids.push_back(n12_es[0][1]);
     n12_t_ids.push_back(n12_es[0][2]);
-    std::vector<bool> is_visited(N, false);
+    std::array<bool, N> is_visited;
+    is_visited.fill(false);
     is_visited[0] = true;
     for (int i = 0; i < N - 2; i++) {
         for (int j = 0; j < N; j++) {
@@ -319,17 +327,16 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
     n12_t_ids.push_back(n12_es[std::find(is_visited.begin(), is_visited.end(), false) - is_visited.begin()][2]);
 
     bool is_valid = false;
-    std::vector<std::array<int, 4>> new_tets;
-    new_tets.reserve(4);
-    std::vector<int> tags;
-    std::vector<TetQuality> tet_qs;
+    std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
+    std::vector<int>& tags = scratch.tags.get();
+    std::vector<TetQuality>& tet_qs = scratch.tet_qs.get();
     std::array<int, 2> v_ids;
     TetQuality old_tq, new_tq;
     getCheckQuality(old_t_ids, old_tq);
     for (int i = 0; i < 2; i++) {
-        std::vector<std::array<int, 4>> tmp_new_tets;
-        std::vector<int> tmp_tags;
-        std::vector<TetQuality> tmp_tet_qs;
+        std::vector<std::array<int, 4>>& tmp_new_tets = scratch.tmp_new_tets.get();
+        std::vector<int>& tmp_tags = scratch.tmp_tags.get();
+        std::vector<TetQuality>& tmp_tet_qs = scratch.tmp_tet_qs.get();
         std::array<int, 2> tmp_v_ids;
         tmp_v_ids = {{n12_v_ids[0 + i], n12_v_ids[2 + i]}};
         for (int j = 0; j < old_t_ids.size(); j++) {
@@ -350,6 +357,12 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
         if (isFlip(tmp_new_tets))
             continue;
         tmp_timer.start();
+        if (screenTetQualities(tmp_new_tets, old_tq.slim_energy) == SCREEN_REJECT) {
+            energy_time += tmp_timer.getElapsedTime();
+            if (equal_buget > 0)
+                equal_buget--;
+            return false;
+        }
         calTetQualities(tmp_new_tets, tmp_tet_qs);
         energy_time+=tmp_timer.getElapsedTime();
         getCheckQuality(tmp_tet_qs, new_tq);
@@ -373,8 +386,8 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
         return false;
 
     //real update
-    std::vector<std::array<int, 3>> fs;
-    std::vector<int> is_sf_fs;
+    std::vector<std::array<int, 3>>& fs = scratch.fs.get();
+    std::vector<int>& is_sf_fs = scratch.is_sf_fs.get();
     for (int i = 0; i < old_t_ids.size(); i++) {
         for (int j = 0; j < 4; j++) {
             if (tets[old_t_ids[i]][j] == v1_id || tets[old_t_ids[i]][j] == v2_id) {
@@ -387,6 +400,7 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
         }
     }
 
+    unindexSurfaceTets(old_t_ids);
     for (int j = 0; j < new_tets.size(); j++) {
         if (tags[j] == 0) {
             tet_vertices[v1_id].conn_tets.erase(
@@ -400,8 +414,9 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
             tet_vertices[v_ids[1]].conn_tets.insert(old_t_ids[j]);
         }
         tets[old_t_ids[j]] = new_tets[j];
-        tet_qualities[old_t_ids[j]] = tet_qs[j];
+        setTetQuality(old_t_ids[j], tet_qs[j]);
     }
+    updateOppTets(old_t_ids);
 
     for (int i = 0; i < old_t_ids.size(); i++) {//old_t_ids contains new tets
         for (int j = 0; j < 4; j++) {
@@ -415,9 +430,10 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
             }
         }
     }
+    indexSurfaceTets(old_t_ids);
 
     //repush
-    std::vector<std::array<int, 2>> es;
+    std::vector<std::array<int, 2>>& es = scratch.es.get();
     es.reserve(new_tets.size()*6);
     for (int i = 0; i < new_tets.size(); i++) {
         for (int j = 0; j < 3; j++) {
@@ -456,12 +472,12 @@ bool EdgeRemover::removeAnEdge_44(int v1_id, int v2_id, const std::vector<int>&
 //}
 
 bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>& old_t_ids) {
-    if (old_t_ids.size() != 5)
+    const int N = 5;
+    if (old_t_ids.size() != N)
         return false;
 
     //oriented the n12_v_ids
-    std::vector<std::array<int, 3>> n12_es;
-    n12_es.reserve(old_t_ids.size());
+    std::array<std::array<int, 3>, N> n12_es;
     for (int i = 0; i < old_t_ids.size(); i++) {
         std::array<int, 3> e;
         int cnt = 0;
@@ -470,15 +486,16 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
                 e[cnt++] = tets[old_t_ids[i]][j];
             }
         e[cnt] = old_t_ids[i];
-        n12_es.push_back(e);
+        n12_es[i] = e;
     }
 
-    std::vector<int> n12_v_ids;
-    std::vector<int> n12_t_ids;
+    std::vector<int>& n12_v_ids = scratch.n12_v_ids.get();
+    std::vector<int>& n12_t_ids = scratch.n12_t_ids.get();
     n12_v_ids.push_back(n12_es[0][0]);
     n12_v_ids.push_back(n12_es[0][1]);
     n12_t_ids.push_back(n12_es[0][2]);
-    std::vector<bool> is_visited(5, false);
+    std::array<bool, N> is_visited;
+    is_visited.fill(false);
     is_visited[0] = true;
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 5; j++) {
@@ -503,15 +520,15 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
     //check valid
     TetQuality old_tq, new_tq;
     getCheckQuality(old_t_ids, old_tq);
-    std::unordered_map<int, std::array<TetQuality, 2>> tet_qs;
-    std::unordered_map<int, std::array<std::array<int, 4>, 2>> new_tets;
-    std::vector<bool> is_v_valid(5, true);
+    std::array<std::array<TetQuality, 2>, 2 * N> tet_qs;//i for the side tets, i + 5 for the middle ones
+    std::array<std::array<std::array<int, 4>, 2>, 2 * N> new_tets;
+    std::array<bool, N> is_v_valid;
+    is_v_valid.fill(true);
     for (int i = 0; i < n12_v_ids.size(); i++) {
         if (!is_v_valid[(i + 1) % 5] && !is_v_valid[(i - 1 + 5) % 5])
             continue;
 
-        std::vector<std::array<int, 4>> new_ts;
-        new_ts.reserve(6);
+        std::vector<std::array<int, 4>>& new_ts = scratch.new_tets.get();
         std::array<int, 4> t = tets[n12_t_ids[i]];
         auto it = std::find(t.begin(), t.end(), v1_id);
         *it = n12_v_ids[(i - 1 + 5) % 5];
@@ -527,7 +544,7 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
             continue;
         }
 
-        std::vector<TetQuality> qs;
+        std::vector<TetQuality>& qs = scratch.tet_qs.get();
         tmp_timer.start();
         calTetQualities(new_ts, qs);
         energy_time+=tmp_timer.getElapsedTime();
@@ -554,8 +571,7 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
         if (!is_v_valid[i])
             continue;
 
-        std::vector<std::array<int, 4>> new_ts;
-        new_ts.reserve(6);
+        std::vector<std::array<int, 4>>& new_ts = scratch.new_tets.get();
         std::array<int, 4> t = tets[n12_t_ids[(i + 2) % 5]];
         auto it = std::find(t.begin(), t.end(), v1_id);
         *it = n12_v_ids[i];
@@ -567,8 +583,15 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
         if (isFlip(new_ts))
             continue;
 
-        std::vector<TetQuality> qs;
+        std::vector<TetQuality>& qs = scratch.tet_qs.get();
         tmp_timer.start();
+        //the middle tets alone may already be above the best configuration so far
+        if (screenTetQualities(new_ts, old_tq.slim_energy) == SCREEN_REJECT) {
+            energy_time += tmp_timer.getElapsedTime();
+            if (equal_buget > 0)
+                equal_buget--;
+            continue;
+        }
         calTetQualities(new_ts, qs);
         energy_time+=tmp_timer.getElapsedTime();
         for (int j = 0; j < 2; j++) {
@@ -598,8 +621,8 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
 
     //real update
     //update on surface -- 1
-    std::vector<std::array<int, 3>> fs;
-    std::vector<int> is_sf_fs;
+    std::vector<std::array<int, 3>>& fs = scratch.fs.get();
+    std::vector<int>& is_sf_fs = scratch.is_sf_fs.get();
     for (int i = 0; i < old_t_ids.size(); i++) {
         for (int j = 0; j < 4; j++) {
             if (tets[old_t_ids[i]][j] == v1_id || tets[old_t_ids[i]][j] == v2_id) {
@@ -612,17 +635,18 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
         }
     }
 
-    std::vector<int> new_t_ids = old_t_ids;
+    std::vector<int>& new_t_ids = scratch.new_t_ids.get();
+    new_t_ids.insert(new_t_ids.end(), old_t_ids.begin(), old_t_ids.end());
+    unindexSurfaceTets(old_t_ids);
     getNewTetSlots(1, new_t_ids);
-    t_is_removed[new_t_ids.back()] = false;
     for (int i = 0; i < 2; i++) {
         tets[new_t_ids[i]] = new_tets[(selected_id + 1) % 5][i];
         tets[new_t_ids[i + 2]] = new_tets[(selected_id - 1 + 5) % 5][i];
         tets[new_t_ids[i + 4]] = new_tets[selected_id + 5][i];
 
-        tet_qualities[new_t_ids[i]] = tet_qs[(selected_id + 1) % 5][i];
-        tet_qualities[new_t_ids[i + 2]] = tet_qs[(selected_id - 1 + 5) % 5][i];
-        tet_qualities[new_t_ids[i + 4]] = tet_qs[selected_id + 5][i];
+        setTetQuality(new_t_ids[i], tet_qs[(selected_id + 1) % 5][i]);
+        setTetQuality(new_t_ids[i + 2], tet_qs[(selected_id - 1 + 5) % 5][i]);
+        setTetQuality(new_t_ids[i + 4], tet_qs[selected_id + 5][i]);
     }
 
     //update on_surface -- 2
@@ -657,6 +681,8 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
         for (int j = 0; j < 4; j++)
             tet_vertices[tets[new_t_ids[i]][j]].conn_tets.insert(new_t_ids[i]);
     }
+    updateOppTets(new_t_ids);
+    indexSurfaceTets(new_t_ids);
 
     //repush
 //    addNewEdge(std::array<int, 2>({{n12_v_ids[selected_id], n12_v_ids[(selected_id + 2) % 5]}}));
@@ -667,7 +693,7 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
 //    addNewEdge(std::array<int, 2>({{v2_id, n12_v_ids[(selected_id + 1) % 5]}}));
 //    addNewEdge(std::array<int, 2>({{v2_id, n12_v_ids[(selected_id - 1 + 5) % 5]}}));
 
-    std::vector<std::array<int, 2>> es;
+    std::vector<std::array<int, 2>>& es = scratch.es.get();
     es.reserve(new_t_ids.size()*6);
     for(int i=0;i<new_t_ids.size();i++) {
         for (int j = 0; j < 3; j++) {
@@ -691,8 +717,8 @@ bool EdgeRemover::removeAnEdge_56(int v1_id, int v2_id, const std::vector<int>&
 }
 
 bool EdgeRemover::isSwappable_cd1(const std::array<int, 2>& v_ids){
-    std::vector<int> t_ids;
-    setIntersection(tet_vertices[v_ids[0]].conn_tets, tet_vertices[v_ids[1]].conn_tets, t_ids);
+    std::vector<int>& t_ids = scratch.edge_t_ids.get();
+    getEdgeConnTets(v_ids[0], v_ids[1], t_ids);
 
     if(isEdgeOnSurface(v_ids[0], v_ids[1], t_ids))
         return false;
@@ -704,7 +730,7 @@ bool EdgeRemover::isSwappable_cd1(const std::array<int, 2>& v_ids){
 
 bool EdgeRemover::isSwappable_cd1(const std::array<int, 2>& v_ids, std::vector<int>& t_ids, bool is_check_conn_tet_num){
 //    std::vector<int> t_ids;
-    setIntersection(tet_vertices[v_ids[0]].conn_tets, tet_vertices[v_ids[1]].conn_tets, t_ids);
+    getEdgeConnTets(v_ids[0], v_ids[1], t_ids);
 
     if(is_check_conn_tet_num)
         if(t_ids.size()<3 || t_ids.size()>5)
@@ -733,30 +759,6 @@ bool EdgeRemover::isEdgeValid(const std::array<int, 2>& v_ids){
     return true;
 }
 
-void EdgeRemover::getNewTetSlots(int n, std::vector<int>& new_conn_tets) {
-    unsigned int cnt = 0;
-    for (unsigned int i = t_empty_start; i < t_is_removed.size(); i++) {
-        if (t_is_removed[i]) {
-            new_conn_tets.push_back(i);
-            cnt++;
-            if (cnt == n) {
-                t_empty_start = i + 1;
-                break;
-            }
-        }
-    }
-    if (cnt < n) {
-        for (unsigned int i = 0; i < n - cnt; i++)
-            new_conn_tets.push_back(tets.size() + i);
-
-        tets.resize(tets.size() + n - cnt);
-        t_is_removed.resize(t_is_removed.size() + n - cnt);
-        tet_qualities.resize(tet_qualities.size() + n - cnt);
-        is_surface_fs.resize(is_surface_fs.size() + n - cnt);
-        t_empty_start = tets.size();
-    }
-}
-
 void EdgeRemover::addNewEdge(const std::array<int, 2>& e){
     if (isSwappable_cd1(e)) {
         double weight = calEdgeLength(e);
@@ -40,9 +40,6 @@ public:
 
     double ideal_weight;
 
-    int v_empty_start=0;
-    int t_empty_start=0;
-
     int flag_cnt=0;
 
     int tmp_cnt3=0;
@@ -65,7 +62,6 @@ public:
 
     bool isSwappable_cd2(double weight);
     bool isEdgeValid(const std::array<int, 2>& v_ids);
-    void getNewTetSlots(int n, std::vector<int>& new_conn_tets);
 
     void addNewEdge(const std::array<int, 2>& e);
 
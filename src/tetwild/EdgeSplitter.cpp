@@ -24,7 +24,7 @@ namespace tetwild {
 		for (unsigned j = 0; j < tets.size(); ++j) {
 			for (int k = 0; k < 4; k++) {
 				for (int r = 0; r < 3; r++)
-					V(i * 4 + k, r) = tet_vertices[tets[j][k]].posf[r];
+					V(i * 4 + k, r) = vertex_store.ptr(tets[j][k])[r];
 			}
 			F.row(i * 4 + 0) << (i * 4) + 0, (i * 4) + 1, (i * 4) + 3;
 			F.row(i * 4 + 1) << (i * 4) + 0, (i * 4) + 2, (i * 4) + 1;
@@ -61,9 +61,6 @@ namespace tetwild {
 			}
 		}
 
-		t_empty_start = 0;
-		v_empty_start = 0;
-
 		//    if(budget > 0)
 		//        is_cal_quality_end = true;
 
@@ -75,23 +72,21 @@ namespace tetwild {
 	void EdgeSplitter::split() {
 
 		if (budget > 0) {
-			int v_slots = std::count(v_is_removed.begin(), v_is_removed.end(), true);
-			v_slots = budget - v_slots;
-			if (v_slots > 0) {
-				tet_vertices.reserve(tet_vertices.size() + v_slots);
-				v_is_removed.reserve(tet_vertices.size() + v_slots);
+			int n_v_slots = budget - v_slots.freeCount();
+			if (n_v_slots > 0) {
+				tet_vertices.reserve(tet_vertices.size() + n_v_slots);
+				v_is_removed.reserve(tet_vertices.size() + n_v_slots);
 			}
-			int t_slots = std::count(t_is_removed.begin(), t_is_removed.end(), true);
-			t_slots = budget * 6 - t_slots;
-			if (t_slots > 0) {
-				tet_vertices.reserve(tet_vertices.size() + t_slots);
-				v_is_removed.reserve(tet_vertices.size() + t_slots);
+			int n_t_slots = budget * 6 - t_slots.freeCount();
+			if (n_t_slots > 0) {
+				tet_vertices.reserve(tet_vertices.size() + n_t_slots);
+				v_is_removed.reserve(tet_vertices.size() + n_t_slots);
 			}
 		}
 		else {
 			// reserve space
-			int v_slot_size = std::count(v_is_removed.begin(), v_is_removed.end(), true);
-			int t_slot_size = std::count(t_is_removed.begin(), t_is_removed.end(), true);
+			int v_slot_size = v_slots.freeCount();
+			int t_slot_size = t_slots.freeCount();
 			if (v_slot_size < es_queue.size() * 2)
 				tet_vertices.reserve(es_queue.size() * 2 - v_slot_size);
 			if (t_slot_size < es_queue.size() * 6 * 2)
@@ -125,26 +120,14 @@ namespace tetwild {
 		}
 
 		//cal the qualities in the very end
-		//not really, in the last few pass, only some of the edges are splitted
-		//maybe, we can marked all the splitted tets in this pass and the update their quality in the end? -- Try it.
-		//todo ...
+		//only the tets splitted in this pass are out of date, the others are skipped
 		if (is_cal_quality_end) {
-			const int tets_size = tets.size();
-			std::vector<std::array<int, 4>> tmp_tets;
-			for (int i = 0; i < tets_size; i++) {
-				if (t_is_removed[i])
-					continue;
-				tmp_tets.push_back(tets[i]);
-			}
-
-			std::vector<TetQuality> tet_qs;
-			calTetQualities(tmp_tets, tet_qs);
-			int cnt = 0;
-			for (int i = 0; i < tets_size; i++) {
-				if (t_is_removed[i])
-					continue;
-				tet_qualities[i] = tet_qs[cnt++];
+			std::vector<int>& t_ids = scratch.t_ids.get();
+			for (int i = 0; i < tets.size(); i++) {
+				if (!t_is_removed[i])
+					t_ids.push_back(i);
 			}
+			calTetQualities(t_ids);
 		}
 
 	}
@@ -154,27 +137,7 @@ namespace tetwild {
 		int v2_id = edge[1];
 
 		//add new vertex
-		TetVertex v;//tet_vertices[v_id] is actually be reset
-		bool is_found = false;
-		for (int i = v_empty_start; i < v_is_removed.size(); i++) {
-			v_empty_start = i;
-			if (v_is_removed[i]) {
-				is_found = true;
-				break;
-			}
-		}
-		if (!is_found)
-			v_empty_start = v_is_removed.size();
-
-		int v_id = v_empty_start;
-		if (v_empty_start < v_is_removed.size()) {
-			tet_vertices[v_id] = v;
-			v_is_removed[v_id] = false;
-		}
-		else {
-			tet_vertices.push_back(v);
-			v_is_removed.push_back(false);
-		}
+		int v_id = getNewVertexSlot();//tet_vertices[v_id] and its vertex_store entry are reset
 
 		//    int v_id = -1;
 	//    auto empty_slot = std::find(v_is_removed.begin(), v_is_removed.end(), true);//can be improved
@@ -189,13 +152,13 @@ namespace tetwild {
 	//    }
 
 		//old_t_ids
-		std::vector<int> old_t_ids;
-		setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, old_t_ids);
+		std::vector<int>& old_t_ids = scratch.old_t_ids.get();
+		getEdgeConnTets(v1_id, v2_id, old_t_ids);
 
 		//new_tets
-		std::vector<int> new_t_ids;
-		std::vector<int> n12_v_ids;
-		std::vector<std::array<int, 4>> new_tets;
+		std::vector<int>& new_t_ids = scratch.new_t_ids.get();
+		std::vector<int>& n12_v_ids = scratch.n12_v_ids.get();
+		std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
 		new_tets.reserve(old_t_ids.size() * 2);
 		for (int i = 0; i < old_t_ids.size(); i++) {
 			for (int j = 0; j < 4; j++) {
@@ -213,26 +176,25 @@ namespace tetwild {
 		}
 
 		//check is_valid
-		tet_vertices[v_id].adaptive_scale = (tet_vertices[v1_id].adaptive_scale + tet_vertices[v2_id].adaptive_scale) / 2;
-		if (tet_vertices[v1_id].is_locked && tet_vertices[v2_id].is_locked)
-			tet_vertices[v_id].is_locked = true;
+		vertex_store.adaptive_scale[v_id] = (vertex_store.adaptive_scale[v1_id] + vertex_store.adaptive_scale[v2_id]) / 2;
+		if (vertex_store.is(v1_id, TetVertexStore::LOCKED) && vertex_store.is(v2_id, TetVertexStore::LOCKED))
+			vertex_store.set(v_id, TetVertexStore::LOCKED, true);
 
-		tet_vertices[v_id].posf = CGAL::midpoint(tet_vertices[v1_id].posf, tet_vertices[v2_id].posf);
-		tet_vertices[v_id].pos = Point_3(tet_vertices[v_id].posf[0], tet_vertices[v_id].posf[1], tet_vertices[v_id].posf[2]);
-		std::vector<TetQuality> tet_qs;
+		vertex_store.setPosf(v_id, CGAL::midpoint(vertex_store.posf(v1_id), vertex_store.posf(v2_id)));
+		vertex_store.releasePos(v_id);
+		std::vector<TetQuality>& tet_qs = scratch.tet_qs.get();
 		if (!is_cal_quality_end) {
 			calTetQualities(new_tets, tet_qs);
 		}
 
 		if (isFlip(new_tets)) {
-			tet_vertices[v_id].pos = CGAL::midpoint(tet_vertices[v1_id].pos, tet_vertices[v2_id].pos);
-			tet_vertices[v_id].posf = Point_3f(CGAL::to_double(tet_vertices[v_id].pos[0]), CGAL::to_double(tet_vertices[v_id].pos[1]),
-				CGAL::to_double(tet_vertices[v_id].pos[2]));
-			tet_vertices[v_id].is_rounded = false;
-		}
-		else {
-			tet_vertices[v_id].is_rounded = true;
+			Point_3 p = CGAL::midpoint(vertex_store.pos(v1_id), vertex_store.pos(v2_id));
+			vertex_store.setPos(v_id, p);
+			vertex_store.setPosf(v_id, Point_3f(CGAL::to_double(p[0]), CGAL::to_double(p[1]), CGAL::to_double(p[2])));
+			vertex_store.set(v_id, TetVertexStore::ROUNDED, false);
 		}
+		else
+			vertex_store.setRounded(v_id, true);
 
 		//    if(!is_cal_quality_end)
 		//          calTetQualities(new_tets, tet_qs);
@@ -240,32 +202,35 @@ namespace tetwild {
 			////real update//
 			//update boundary tags
 		if (isEdgeOnBoundary(v1_id, v2_id)) {
-			tet_vertices[v_id].is_on_boundary = true;
+			vertex_store.set(v_id, TetVertexStore::ON_BOUNDARY, true);
 		}
 
 		//update surface tags
 		if (state.eps != state.EPSILON_INFINITE) {
 			if (isEdgeOnSurface(v1_id, v2_id)) {
-				tet_vertices[v_id].is_on_surface = true;
+				vertex_store.set(v_id, TetVertexStore::ON_SURFACE, true);
 				if (state.eps == state.EPSILON_NA) {
 					setIntersection(tet_vertices[v1_id].on_edge, tet_vertices[v2_id].on_edge, tet_vertices[v_id].on_edge);
 					setIntersection(tet_vertices[v1_id].on_face, tet_vertices[v2_id].on_face, tet_vertices[v_id].on_face);
 				}
 			}
 			else
-				tet_vertices[v_id].is_on_surface = false;
+				vertex_store.set(v_id, TetVertexStore::ON_SURFACE, false);
 		}
 
 		//get new tet ids
+		unindexSurfaceTets(old_t_ids);
 		getNewTetSlots(old_t_ids.size(), new_t_ids);
 		for (int i = 0; i < old_t_ids.size(); i++) {
 			tets[old_t_ids[i]] = new_tets[i * 2];
 			tets[new_t_ids[i]] = new_tets[i * 2 + 1];
 			if (!is_cal_quality_end) {
-				tet_qualities[old_t_ids[i]] = tet_qs[i * 2];
-				tet_qualities[new_t_ids[i]] = tet_qs[i * 2 + 1];
+				setTetQuality(old_t_ids[i], tet_qs[i * 2]);
+				setTetQuality(new_t_ids[i], tet_qs[i * 2 + 1]);
+			} else {
+				invalidateTetQuality(old_t_ids[i]);
+				invalidateTetQuality(new_t_ids[i]);
 			}
-			t_is_removed[new_t_ids[i]] = false;
 			is_surface_fs[new_t_ids[i]] = is_surface_fs[old_t_ids[i]];
 		}
 
@@ -286,12 +251,12 @@ namespace tetwild {
 		}
 
 		//update bbox tags //Note that no matter what the epsilon is, the bbox has to be preserved anyway
-		if (tet_vertices[v1_id].is_on_bbox && tet_vertices[v2_id].is_on_bbox) {
+		if (vertex_store.is(v1_id, TetVertexStore::ON_BBOX) && vertex_store.is(v2_id, TetVertexStore::ON_BBOX)) {
 			setIntersection(tet_vertices[v1_id].on_face, tet_vertices[v2_id].on_face, tet_vertices[v_id].on_face);
 			if (tet_vertices[v_id].on_face.size() == 0)
-				tet_vertices[v_id].is_on_bbox = false;
+				vertex_store.set(v_id, TetVertexStore::ON_BBOX, false);
 			else {
-				tet_vertices[v_id].is_on_bbox = true;
+				vertex_store.set(v_id, TetVertexStore::ON_BBOX, true);
 				setIntersection(tet_vertices[v1_id].on_edge, tet_vertices[v2_id].on_edge, tet_vertices[v_id].on_edge);
 			}
 		}
@@ -306,6 +271,11 @@ namespace tetwild {
 		}
 		tet_vertices[v_id].conn_tets.insert(old_t_ids.begin(), old_t_ids.end());
 		tet_vertices[v_id].conn_tets.insert(new_t_ids.begin(), new_t_ids.end());
+		std::vector<int>& changed_t_ids = scratch.changed_t_ids.get();
+		changed_t_ids.insert(changed_t_ids.end(), old_t_ids.begin(), old_t_ids.end());
+		changed_t_ids.insert(changed_t_ids.end(), new_t_ids.begin(), new_t_ids.end());
+		updateOppTets(changed_t_ids);
+		indexSurfaceTets(changed_t_ids);
 
 		//push new ele into queue
 		double weight = calEdgeLength(v1_id, v_id);
@@ -374,7 +344,7 @@ namespace tetwild {
 	}
 
 	bool EdgeSplitter::isSplittable_cd1(int v1_id, int v2_id, double weight) {
-		double adaptive_scale = (tet_vertices[v1_id].adaptive_scale + tet_vertices[v2_id].adaptive_scale) / 2.0;
+		double adaptive_scale = (vertex_store.adaptive_scale[v1_id] + vertex_store.adaptive_scale[v2_id]) / 2.0;
 		//    if(adaptive_scale==0){
 		//        logger().debug("adaptive_scale==0!!!");
 		//    }
@@ -390,28 +360,4 @@ namespace tetwild {
 		return false;
 	}
 
-	void EdgeSplitter::getNewTetSlots(int n, std::vector<int>& new_conn_tets) {
-		int cnt = 0;
-		for (int i = t_empty_start; i < t_is_removed.size(); i++) {
-			if (t_is_removed[i]) {
-				new_conn_tets.push_back(i);
-				cnt++;
-				if (cnt == n) {
-					t_empty_start = i + 1;
-					break;
-				}
-			}
-		}
-		if (cnt < n) {
-			for (int i = 0; i < n - cnt; i++)
-				new_conn_tets.push_back(tets.size() + i);
-
-			tets.resize(tets.size() + n - cnt);
-			t_is_removed.resize(t_is_removed.size() + n - cnt);
-			tet_qualities.resize(tet_qualities.size() + n - cnt);
-			is_surface_fs.resize(is_surface_fs.size() + n - cnt);
-			t_empty_start = tets.size();
-		}
-	}
-
 } // namespace tetwild
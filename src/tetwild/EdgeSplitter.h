@@ -40,9 +40,6 @@ public:
 
     std::priority_queue<ElementInQueue_es, std::vector<ElementInQueue_es>, cmp_es> es_queue;
 
-    int t_empty_start=0;
-    int v_empty_start=0;
-
     double max_weight=0;
     double ideal_weight=0;
 
@@ -57,7 +54,6 @@ public:
 
     bool isSplittable_cd1(double weight);
     bool isSplittable_cd1(int v1_id, int v2_id, double weight);
-    void getNewTetSlots(int n, std::vector<int>& new_conn_tets);
 //    igl::viewer::Viewer viewer;
     void getMesh_ui(const std::vector<std::array<int, 4>>& tets, Eigen::MatrixXd& V, Eigen::MatrixXi& F);
 
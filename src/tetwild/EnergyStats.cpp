@@ -0,0 +1,136 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/EnergyStats.h>
+#include <algorithm>
+#include <cmath>
+
+namespace tetwild {
+
+namespace {
+const double LARGE_ENERGY = 1e8;
+}
+
+void EnergyStats::clear() {
+    is_valid = false;
+    energies.clear();
+    states.clear();
+    n_leaves = 1;
+    max_tree.assign(2, 0);
+    second_tree.assign(2, 0);
+    n_counted = 0;
+    sum = 0;
+    large_energies.clear();
+}
+
+void EnergyStats::init(int n, double max_e, double filter_e) {
+    clear();
+    is_valid = true;
+    max_energy = max_e;
+    filter_energy_thres = filter_e;
+    buckets.fill(0);
+    resize(n);
+}
+
+void EnergyStats::resize(int n) {
+    if (!is_valid || n <= (int) states.size())
+        return;
+    energies.resize(n, 0);
+    states.resize(n, EMPTY);
+    reserveLeaves(n);
+}
+
+void EnergyStats::set(int t_id, double energy, bool is_counted) {
+    if (!is_valid)
+        return;
+    remove(t_id);
+
+    energies[t_id] = energy;
+    states[t_id] = is_counted ? COUNTED : LIVE;
+    int b = getBucket(energy);
+    if (b >= 0)
+        buckets[b]++;
+    if (!is_counted)
+        return;
+
+    n_counted++;
+    if (energy > LARGE_ENERGY)
+        large_energies.insert(energy);
+    else
+        sum += energy;
+    setLeaf(max_tree, t_id, energy);
+    setLeaf(second_tree, t_id, energy == max_energy ? 0 : energy);
+}
+
+void EnergyStats::remove(int t_id) {
+    if (!is_valid || states[t_id] == EMPTY)
+        return;
+
+    double energy = energies[t_id];
+    int b = getBucket(energy);
+    if (b >= 0)
+        buckets[b]--;
+    if (states[t_id] == COUNTED) {
+        n_counted--;
+        if (energy > LARGE_ENERGY)
+            large_energies.erase(large_energies.find(energy));
+        else
+            sum -= energy;
+        setLeaf(max_tree, t_id, 0);
+        setLeaf(second_tree, t_id, 0);
+    }
+    states[t_id] = EMPTY;
+}
+
+double EnergyStats::getAvgEnergy() const {
+    double s = sum;
+    for (double e: large_energies)
+        s += e;
+    return s / n_counted;
+}
+
+int EnergyStats::getBucket(double energy) const {
+    //same buckets as LocalOperations::getFilterEnergy()
+    if (energy > filter_energy_thres - 1 + 1e10)
+        return 10;
+    for (int j = 0; j < 10; j++) {
+        if (energy > filter_energy_thres - 1 + pow(10, j) && energy <= filter_energy_thres - 1 + pow(10, j + 1))
+            return j;
+    }
+    return -1;
+}
+
+void EnergyStats::setLeaf(std::vector<double>& tree, int t_id, double energy) {
+    int i = n_leaves + t_id;
+    tree[i] = energy;
+    for (i /= 2; i >= 1; i /= 2) {
+        double m = std::max(tree[2 * i], tree[2 * i + 1]);
+        if (tree[i] == m)
+            break;
+        tree[i] = m;
+    }
+}
+
+void EnergyStats::reserveLeaves(int n) {
+    if (n <= n_leaves)
+        return;
+    int old_n_leaves = n_leaves;
+    while (n_leaves < n)
+        n_leaves *= 2;
+
+    for (auto* tree: {&max_tree, &second_tree}) {
+        std::vector<double> new_tree(2 * n_leaves, 0);
+        std::copy(tree->begin() + old_n_leaves, tree->end(), new_tree.begin() + n_leaves);
+        for (int i = n_leaves - 1; i >= 1; i--)
+            new_tree[i] = std::max(new_tree[2 * i], new_tree[2 * i + 1]);
+        tree->swap(new_tree);
+    }
+}
+
+} // namespace tetwild
@@ -0,0 +1,72 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace tetwild {
+
+///statistics of the tet energies, updated on every write to tet_qualities
+///sum/count/max only cover the unlocked tets, the histogram of getFilterEnergy() covers all the live ones
+class EnergyStats {
+public:
+    static const int N_BUCKETS = 11;
+
+    ///set()/remove()/resize() are ignored until init() is called again
+    bool isValid() const { return is_valid; }
+    void invalidate() { is_valid = false; }
+    void clear();
+
+    void init(int n, double max_energy, double filter_energy_thres);
+    void resize(int n);
+
+    void set(int t_id, double energy, bool is_counted);
+    void remove(int t_id);
+
+    int count() const { return n_counted; }
+    double getAvgEnergy() const;
+    double getMaxEnergy() const { return max_tree[1]; }
+    ///the max energy ignoring the tets at max_energy
+    double getSecondMaxEnergy() const { return second_tree[1]; }
+    const std::array<int, N_BUCKETS>& getBuckets() const { return buckets; }
+
+private:
+    enum SlotState : uint8_t {
+        EMPTY   = 0,
+        LIVE    = 1,
+        COUNTED = 2
+    };
+
+    int getBucket(double energy) const;
+    void setLeaf(std::vector<double>& tree, int t_id, double energy);
+    void reserveLeaves(int n);
+
+    bool is_valid = false;
+    double max_energy = 0;
+    double filter_energy_thres = 0;
+
+    std::vector<double> energies;
+    std::vector<uint8_t> states;
+
+    //tournament trees over the slots, the leaves are stored in [n_leaves, 2 * n_leaves)
+    int n_leaves = 1;
+    std::vector<double> max_tree = std::vector<double>(2, 0);
+    std::vector<double> second_tree = std::vector<double>(2, 0);
+
+    int n_counted = 0;
+    double sum = 0;
+    std::multiset<double> large_energies;//kept out of sum, so that removing them does not wipe out the small ones
+    std::array<int, N_BUCKETS> buckets;
+};
+
+} // namespace tetwild
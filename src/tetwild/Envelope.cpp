@@ -0,0 +1,205 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/Envelope.h>
+#include <tetwild/ProgressHandler.h>
+#include <algorithm>
+
+namespace tetwild {
+
+namespace {
+///the surface tree is traversed once per packet, the boundary tree once per point,
+///both count their hint hits per point
+template<typename TraversalStats>
+void addTraversal(const TraversalStats& ts, long long n_packets, EnvelopeStats& stats) {
+    stats.n_packets += n_packets;
+    stats.n_hint_hits += ts.nb_hint_hits;
+    stats.n_nodes += ts.nb_nodes;
+}
+}
+
+void EnvelopeQuery::resetStats() {
+    breakdown_timing = {{0, 0}};
+    stats.clear();
+    cache.resetCounts();
+}
+
+bool Envelope::isPointOut(const GEO::vec3& p, double sq_eps, EnvelopeQuery& query) const {
+    query.stats.n_calls++;
+    GEO::vec3 ps[1] = {p};
+    int owners[1] = {0};
+    bool is_out = findPointOut(ps, owners, 1, sq_eps, query) >= 0;
+    if (is_out)
+        query.stats.n_out++;
+    return is_out;
+}
+
+int Envelope::findFaceOut_sampling(const Triangle_3f* const* tris, int n, double sq_eps, double sampling_dist,
+                                   EnvelopeQuery& query) const {
+#if TIMING_BREAKDOWN
+    query.timer.start();
+#endif
+    std::vector<TriangleSampler>& samplers = query.samplers;
+    std::vector<int>& live_ids = query.live_ids;
+    if (samplers.size() < n)
+        samplers.resize(n);
+    live_ids.clear();
+    size_t num_lattice = 0;//the samples the faces would have without the early exit
+    for (int i = 0; i < n; i++) {
+        const Triangle_3f& tri = *tris[i];
+        if (tri.is_degenerate())
+            continue;
+        std::array<GEO::vec3, 3> vs = {{GEO::vec3(tri[0][0], tri[0][1], tri[0][2]),
+                                        GEO::vec3(tri[1][0], tri[1][1], tri[1][2]),
+                                        GEO::vec3(tri[2][0], tri[2][1], tri[2][2])}};
+        samplers[i].init(vs, sampling_dist);
+        num_lattice += samplers[i].count();
+        live_ids.push_back(i);
+    }
+#if TIMING_BREAKDOWN
+    query.breakdown_timing[EnvelopeQuery::ID_SAMPLING] += query.timer.getElapsedTime();
+#endif
+
+    size_t num_samples = 0;
+
+    //decide in/out
+#if TIMING_BREAKDOWN
+    query.timer.start();
+#endif
+
+    //the samples are generated from coarse to fine by packets sharing one traversal of the tree,
+    //most faces out of the envelope fail at a vertex, the centroid or a coarse sample
+    //each live face gets a share of a packet, so that the coarse samples of all the faces come before the fine ones,
+    //and the faces of a one-ring share the hint of their nearest facet
+    const int packet_size = GEO::MeshFacetsAABBWithEps::PACKET_SIZE;
+    std::array<GEO::vec3, GEO::MeshFacetsAABBWithEps::PACKET_SIZE> ps;
+    std::array<int, GEO::MeshFacetsAABBWithEps::PACKET_SIZE> owners;
+    int out_id = -1;
+    while (out_id < 0 && !live_ids.empty()) {
+        const int share = std::max(1, packet_size / int(live_ids.size()));
+        int nb = 0;
+        for (int k = 0; k < live_ids.size() && nb < packet_size;) {
+            const int i = live_ids[k];
+            int m = samplers[i].next(&ps[nb], std::min(share, packet_size - nb));
+            if (m == 0) { //all the samples of the face are in
+                live_ids.erase(live_ids.begin() + k);
+                continue;
+            }
+            std::fill(owners.begin() + nb, owners.begin() + nb + m, i);
+            nb += m;
+            k++;
+        }
+        if (nb == 0)
+            break;
+        num_samples += nb;
+        out_id = findPointOut(ps.data(), owners.data(), nb, sq_eps, query);
+    }
+
+#if TIMING_BREAKDOWN
+    query.breakdown_timing[EnvelopeQuery::ID_AABB] += query.timer.getElapsedTime();
+#endif
+    //the samplers are lazy, but the last packet may be left after its first sample out,
+    //findPointOut() counts the samples queried
+    query.stats.n_calls++;
+    query.stats.n_samples += num_samples;
+    if (out_id >= 0)
+        query.stats.n_out++;
+
+    ProgressHandler::Trace("num_samples {} / {}", num_samples, num_lattice);
+    return out_id;
+}
+
+int Envelope::findPointOut(GEO::vec3* ps, int* owners, GEO::index_t nb, double sq_eps, EnvelopeQuery& query) const {
+    //the points decided by the grid are dropped, the tree only sees the others
+    GEO::index_t nb_tree = nb;
+    if (!grid.empty()) {
+        nb_tree = 0;
+        for (GEO::index_t i = 0; i < nb; i++) {
+            EnvelopeGrid::Side side = grid.side(ps[i], sq_eps);
+            if (side == EnvelopeGrid::Side::OUT) {
+                query.stats.n_grid_decided += i + 1 - nb_tree;
+                query.stats.n_samples_queried += i + 1;
+                return owners[i];
+            }
+            if (side == EnvelopeGrid::Side::UNKNOWN) {
+                ps[nb_tree] = ps[i];
+                owners[nb_tree] = owners[i];
+                nb_tree++;
+            }
+        }
+        query.stats.n_grid_decided += nb - nb_tree;
+    }
+    //the tree decides all the points left in one traversal
+    query.stats.n_samples_queried += nb;
+    if (nb_tree == 0)
+        return -1;
+    GEO::MeshFacetsAABBWithEps::TraversalStats ts;
+    GEO::index_t out = sf_tree.points_in_envelope(ps, nb_tree, sq_eps, query.sf_hint, &ts);
+    addTraversal(ts, 1, query.stats);
+    query.stats.n_leaves += ts.nb_facets;
+    return out < nb_tree ? owners[out] : -1;
+}
+
+bool Envelope::isFaceOut_exact(const Triangle_3f& tri, double eps, EnvelopeQuery& query) const {
+    if (tri.is_degenerate())
+        return false;
+
+#if TIMING_BREAKDOWN
+    query.timer.start();
+#endif
+    bool is_out = prism_envelope.isTriangleOut({{tri[0], tri[1], tri[2]}}, eps, query.prism_buffers);
+#if TIMING_BREAKDOWN
+    query.breakdown_timing[EnvelopeQuery::ID_AABB] += query.timer.getElapsedTime();
+#endif
+    query.stats.n_calls++;
+    if (is_out)
+        query.stats.n_out++;
+    return is_out;
+}
+
+bool Envelope::isPointOutBoundary(const GEO::vec3& p, double sq_eps, EnvelopeQuery& query) const {
+    SegmentAABB::TraversalStats ts;
+    bool is_out = b_tree.pointsInEnvelope(&p, 1, sq_eps, query.b_hint, &ts) == 0;
+    addTraversal(ts, 1, query.stats);
+    query.stats.n_leaves += ts.nb_segments;
+    query.stats.n_calls++;
+    query.stats.n_samples_queried++;
+    if (is_out)
+        query.stats.n_out++;
+    return is_out;
+}
+
+bool Envelope::isBoundaryPointsOut(double sq_eps, EnvelopeQuery& query) const {
+    std::vector<GEO::vec3>& b_points = query.b_points;
+    if (b_points.empty())
+        return false;
+
+#if TIMING_BREAKDOWN
+    query.timer.start();
+#endif
+    //starting from the middle, as the ends of the edges are the vertices already on the boundary
+    const int b_points_size = b_points.size();
+    std::rotate(b_points.begin(), b_points.begin() + b_points_size / 2, b_points.end());
+    SegmentAABB::TraversalStats ts;
+    int out = b_tree.pointsInEnvelope(b_points.data(), b_points_size, sq_eps, query.b_hint, &ts);
+#if TIMING_BREAKDOWN
+    query.breakdown_timing[EnvelopeQuery::ID_AABB] += query.timer.getElapsedTime();
+#endif
+    const int num_queries = std::min(out + 1, b_points_size);
+    addTraversal(ts, num_queries, query.stats);
+    query.stats.n_leaves += ts.nb_segments;
+    query.stats.n_calls++;
+    query.stats.n_samples += b_points_size;
+    query.stats.n_samples_queried += num_queries;
+    if (out < b_points_size)
+        query.stats.n_out++;
+    return out < b_points_size;
+}
+
+} // namespace tetwild
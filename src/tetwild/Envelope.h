@@ -0,0 +1,90 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <tetwild/Common.h>
+#include <tetwild/CGALTypes.h>
+#include <tetwild/EnvelopeCache.h>
+#include <tetwild/EnvelopeGrid.h>
+#include <tetwild/EnvelopeStats.h>
+#include <tetwild/PrismEnvelope.h>
+#include <tetwild/SegmentAABB.h>
+#include <tetwild/geogram/mesh_AABB.h>
+#include <igl/Timer.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace tetwild {
+
+///mutable state of the envelope queries of one thread: hints, buffers, cached results and statistics
+///each LocalOperations owns one, so that operators running concurrently never share one
+struct EnvelopeQuery {
+    enum { ID_SAMPLING = 0, ID_AABB = 1 };
+
+    //hints of the nearest facet/segment, kept from one query to the next
+    GEO::index_t sf_hint = GEO::NO_FACET;
+    int b_hint = -1;
+
+    std::vector<std::pair<double, int>> areas;
+    std::vector<const Triangle_3f*> tris;
+    std::vector<TriangleSampler> samplers;
+    std::vector<int> live_ids;
+    std::vector<GEO::vec3> ps;
+    std::vector<GEO::vec3> b_points;
+    PrismEnvelope::Buffers prism_buffers;
+
+    //the faces tested again by the retried collapses and by the smoothing of unchanged one-rings
+    EnvelopeCache cache;
+
+    igl::Timer timer;
+    std::array<double, 2> breakdown_timing = {{0, 0}};
+    std::array<std::string, 2> breakdown_name = {{"Envelop_sampling", "Envelop_AABBtree"}};
+    EnvelopeStats stats;
+
+    ///at the start of a pass of the operator, the cached results are kept
+    void resetStats();
+};
+
+///envelope of the input surface and of its open boundary, read-only once built and shared by all the threads
+///the queries only write into the EnvelopeQuery they are given
+///the squared eps of a query is the one of the current stage, see State::eps_2
+class Envelope {
+public:
+    Envelope(const GEO::Mesh& sf_mesh, const GEO::MeshFacetsAABBWithEps& sf_tree, const SegmentAABB& b_tree,
+             const EnvelopeGrid& grid):
+        sf_mesh(sf_mesh), sf_tree(sf_tree), b_tree(b_tree), grid(grid), prism_envelope(sf_mesh, sf_tree) {}
+
+    bool isPointOut(const GEO::vec3& p, double sq_eps, EnvelopeQuery& query) const;
+
+    ///index of a face out, -1 if none: the packets mix the samples of all the faces from coarse to fine,
+    ///the first faces get their samples first
+    int findFaceOut_sampling(const Triangle_3f* const* tris, int n, double sq_eps, double sampling_dist,
+                             EnvelopeQuery& query) const;
+    ///eps is the distance the samples guarantee, not the one they are tested with
+    bool isFaceOut_exact(const Triangle_3f& tri, double eps, EnvelopeQuery& query) const;
+
+    bool isPointOutBoundary(const GEO::vec3& p, double sq_eps, EnvelopeQuery& query) const;
+    ///true if one of query.b_points is out of the envelope of the boundary
+    bool isBoundaryPointsOut(double sq_eps, EnvelopeQuery& query) const;
+
+    const GEO::Mesh& sf_mesh;
+    const GEO::MeshFacetsAABBWithEps& sf_tree;
+    const SegmentAABB& b_tree;//empty if sf_mesh is closed
+    const EnvelopeGrid& grid;//filters the point queries on sf_tree, empty if not used
+
+private:
+    ///owner of a point out among ps[0..nb), -1 if none, the points are reordered
+    int findPointOut(GEO::vec3* ps, int* owners, GEO::index_t nb, double sq_eps, EnvelopeQuery& query) const;
+
+    const PrismEnvelope prism_envelope;
+};
+
+} // namespace tetwild
@@ -0,0 +1,79 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/EnvelopeCache.h>
+#include <algorithm>
+#include <cstring>
+
+namespace tetwild {
+
+void EnvelopeCache::clear() {
+    slots.clear();
+    generation = 1;
+    surface = nullptr;
+    n_queries = 0;
+    n_hits = 0;
+}
+
+void EnvelopeCache::setEnvelope(const void* sf, double e, double d) {
+    if (slots.empty())
+        slots.resize(N_SLOTS);
+    if (sf == surface && e == eps && d == sampling_dist)
+        return;
+    surface = sf;
+    eps = e;
+    sampling_dist = d;
+    if (++generation == 0) {//wrapped around, the old stamps could match again
+        slots.assign(N_SLOTS, Slot());
+        generation = 1;
+    }
+}
+
+bool EnvelopeCache::find(const Triangle_3f& tri, bool& is_out) {
+    n_queries++;
+    Key key = getKey(tri);
+    const Slot& slot = slots[getSlot(key)];
+    if (slot.generation != generation || slot.key != key)
+        return false;
+    n_hits++;
+    is_out = slot.is_out;
+    return true;
+}
+
+void EnvelopeCache::insert(const Triangle_3f& tri, bool is_out) {
+    Key key = getKey(tri);
+    Slot& slot = slots[getSlot(key)];
+    slot.key = key;
+    slot.generation = generation;
+    slot.is_out = is_out;
+}
+
+EnvelopeCache::Key EnvelopeCache::getKey(const Triangle_3f& tri) {
+    std::array<std::array<double, 3>, 3> vs;
+    for (int j = 0; j < 3; j++)
+        vs[j] = {{tri[j][0], tri[j][1], tri[j][2]}};
+    std::sort(vs.begin(), vs.end());
+
+    Key key;
+    for (int j = 0; j < 3; j++)
+        std::copy(vs[j].begin(), vs[j].end(), key.begin() + j * 3);
+    return key;
+}
+
+std::size_t EnvelopeCache::getSlot(const Key& key) {
+    uint64_t h = 0;
+    for (double x: key) {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        h = (h ^ bits) * 0x9E3779B97F4A7C15ULL;
+    }
+    return (std::size_t) (h >> 48) & (N_SLOTS - 1);
+}
+
+} // namespace tetwild
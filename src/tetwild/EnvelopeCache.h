@@ -0,0 +1,62 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <tetwild/CGALTypes.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tetwild {
+
+///bounded cache of the envelope tests of the faces, keyed by the exact coordinates of their vertices in any order
+///direct-mapped: a face replaces the one in its slot, so that the memory is fixed
+///the results hold for one envelope: a change of the surface or of eps/sampling_dist drops them all
+class EnvelopeCache {
+public:
+    static const int N_SLOTS = 1 << 16;
+
+    void clear();
+    void setEnvelope(const void* surface, double eps, double sampling_dist);
+
+    bool find(const Triangle_3f& tri, bool& is_out);
+    void insert(const Triangle_3f& tri, bool is_out);
+
+    ///counted since the last resetCounts(), the cached results are kept
+    long long queryCount() const { return n_queries; }
+    long long hitCount() const { return n_hits; }
+    void resetCounts() {
+        n_queries = 0;
+        n_hits = 0;
+    }
+
+private:
+    typedef std::array<double, 9> Key;
+    struct Slot {
+        Key key;
+        uint32_t generation = 0;//the slot is empty unless generation is the current one
+        bool is_out = false;
+    };
+
+    static Key getKey(const Triangle_3f& tri);
+    static std::size_t getSlot(const Key& key);
+
+    std::vector<Slot> slots;//allocated on the first setEnvelope()
+    uint32_t generation = 1;
+
+    const void* surface = nullptr;
+    double eps = 0;
+    double sampling_dist = 0;
+
+    long long n_queries = 0;
+    long long n_hits = 0;
+};
+
+} // namespace tetwild
@@ -0,0 +1,230 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/EnvelopeGrid.h>
+#include <geogram/mesh/mesh_geometry.h>
+#include <geogram/basic/geometry_nd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tetwild {
+
+namespace {
+//the half diagonal of a cell is enlarged by this relative margin, a point on the border of two cells may fall in either
+const double CELL_MARGIN = 1e-6;
+const double CELL_GROWTH = 1.25;
+
+float roundDown(double x) {
+    float y = float(x);
+    if (y > x)
+        y = std::nextafter(y, -std::numeric_limits<float>::infinity());
+    return y;
+}
+
+float roundUp(double x) {
+    float y = float(x);
+    if (y < x)
+        y = std::nextafter(y, std::numeric_limits<float>::infinity());
+    return y;
+}
+
+double squaredDistance(const GEO::vec3& p, const std::array<GEO::vec3, 3>& vs) {
+    GEO::vec3 nearest_p;
+    double l1, l2, l3;
+    return GEO::Geom::point_triangle_squared_distance(p, vs[0], vs[1], vs[2], nearest_p, l1, l2, l3);
+}
+}
+
+const uint64_t EnvelopeGrid::EMPTY_KEY;
+
+void EnvelopeGrid::clear() {
+    facets.clear();
+    keys.clear();
+    cells.clear();
+    n_cells = 0;
+    hash_shift = 64;
+    h = 0;
+    r = 0;
+    sq_far_eps = 0;
+}
+
+void EnvelopeGrid::build(const GEO::Mesh& M, double eps, int max_cells) {
+    clear();
+    if (M.facets.nb() == 0 || eps <= 0)
+        return;
+
+    facets.resize(M.facets.nb());
+    GEO::vec3 min_p = GEO::Geom::mesh_vertex(M, M.facets.vertex(0, 0));
+    GEO::vec3 max_p = min_p;
+    double area = 0;
+    for (GEO::index_t f = 0; f < M.facets.nb(); f++) {
+        for (int j = 0; j < 3; j++) {
+            const GEO::vec3& p = GEO::Geom::mesh_vertex(M, M.facets.vertex(f, j));
+            facets[f][j] = p;
+            for (int c = 0; c < 3; c++) {
+                min_p[c] = std::min(min_p[c], p[c]);
+                max_p[c] = std::max(max_p[c], p[c]);
+            }
+        }
+        area += GEO::length(GEO::cross(facets[f][1] - facets[f][0], facets[f][2] - facets[f][0])) / 2;
+    }
+    double extent = std::max(std::max(max_p[0] - min_p[0], max_p[1] - min_p[1]), max_p[2] - min_p[2]);
+
+    //a cell is kept iff its center is within band = eps + r of the surface,
+    //then all the points of a cell that is not kept are farther than eps
+    double band, n_estimated;
+    h = eps;
+    while (true) {
+        r = h * std::sqrt(3) / 2 * (1 + CELL_MARGIN);
+        band = eps + r;
+        n_estimated = area * (2 * band + h) / (h * h * h);
+        bool is_in_range = (extent + 2 * (band + h)) / h + 2 < (1 << KEY_BITS);
+        if (n_estimated <= max_cells && is_in_range)
+            break;
+        h *= CELL_GROWTH;
+    }
+    for (int c = 0; c < 3; c++)
+        origin[c] = min_p[c] - (band + h);
+    sq_far_eps = eps * eps;
+
+    std::vector<double> sq_dists;
+    std::size_t n_slots = 1024;
+    while (n_slots < 2 * n_estimated)
+        n_slots *= 2;
+    resize(n_slots, sq_dists);
+
+    const double sq_band = band * band;
+    std::array<int, 3> lo, hi, ijk;
+    for (uint32_t f = 0; f < facets.size(); f++) {
+        const std::array<GEO::vec3, 3>& vs = facets[f];
+        for (int c = 0; c < 3; c++) {
+            double f_min = std::min(std::min(vs[0][c], vs[1][c]), vs[2][c]) - band;
+            double f_max = std::max(std::max(vs[0][c], vs[1][c]), vs[2][c]) + band;
+            lo[c] = std::max(0, int(std::ceil((f_min - origin[c]) / h - 0.5)) - 1);
+            hi[c] = std::min((1 << KEY_BITS) - 1, int(std::floor((f_max - origin[c]) / h - 0.5)) + 1);
+        }
+
+        //the cells are scanned by columns along the axis closest to the normal,
+        //only the ones within the slab of half width band around the plane of the facet are tested
+        GEO::vec3 n = GEO::cross(vs[1] - vs[0], vs[2] - vs[0]);
+        double l = GEO::length(n);
+        int k = 2;
+        if (l > 0) {
+            n = n / l;
+            for (int c = 0; c < 2; c++) {
+                if (std::abs(n[c]) > std::abs(n[k]))
+                    k = c;
+            }
+        }
+        const int k0 = (k + 1) % 3, k1 = (k + 2) % 3;
+        const double n_dot = GEO::dot(n, vs[0]);
+        const double half_slab = l > 0 ? band / std::abs(n[k]) + h : 0;
+
+        for (ijk[k0] = lo[k0]; ijk[k0] <= hi[k0]; ijk[k0]++) {
+            for (ijk[k1] = lo[k1]; ijk[k1] <= hi[k1]; ijk[k1]++) {
+                int k_lo = lo[k], k_hi = hi[k];
+                if (l > 0) {
+                    GEO::vec3 c = getCenter(ijk);
+                    double t = (n_dot - n[k0] * c[k0] - n[k1] * c[k1]) / n[k];
+                    k_lo = std::max(k_lo, int(std::ceil((t - half_slab - origin[k]) / h - 0.5)));
+                    k_hi = std::min(k_hi, int(std::floor((t + half_slab - origin[k]) / h - 0.5)));
+                }
+                for (ijk[k] = k_lo; ijk[k] <= k_hi; ijk[k]++) {
+                    double sq_dist = squaredDistance(getCenter(ijk), vs);
+                    if (sq_dist <= sq_band)
+                        insert(getKey(ijk), f, sq_dist, sq_dists);
+                }
+            }
+        }
+    }
+
+    for (std::size_t s = 0; s < keys.size(); s++) {
+        if (keys[s] == EMPTY_KEY)
+            continue;
+        double d = std::sqrt(sq_dists[s]);
+        cells[s].lower = roundDown(d - r);
+        cells[s].upper = roundUp(d + r);
+    }
+}
+
+void EnvelopeGrid::resize(std::size_t n_slots, std::vector<double>& sq_dists) {
+    std::vector<uint64_t> old_keys(n_slots, EMPTY_KEY);
+    std::vector<Cell> old_cells(n_slots);
+    std::vector<double> old_sq_dists(n_slots);
+    old_keys.swap(keys);
+    old_cells.swap(cells);
+    old_sq_dists.swap(sq_dists);
+
+    hash_shift = 64;
+    for (std::size_t n = n_slots; n > 1; n /= 2)
+        hash_shift--;
+    const std::size_t mask = n_slots - 1;
+    for (std::size_t i = 0; i < old_keys.size(); i++) {
+        if (old_keys[i] == EMPTY_KEY)
+            continue;
+        std::size_t s = getSlot(old_keys[i]);
+        while (keys[s] != EMPTY_KEY)
+            s = (s + 1) & mask;
+        keys[s] = old_keys[i];
+        cells[s] = old_cells[i];
+        sq_dists[s] = old_sq_dists[i];
+    }
+}
+
+void EnvelopeGrid::insert(uint64_t key, uint32_t f, double sq_dist, std::vector<double>& sq_dists) {
+    if (2 * (n_cells + 1) > keys.size())
+        resize(2 * keys.size(), sq_dists);
+
+    const std::size_t mask = keys.size() - 1;
+    std::size_t s = getSlot(key);
+    while (keys[s] != EMPTY_KEY && keys[s] != key)
+        s = (s + 1) & mask;
+    if (keys[s] == EMPTY_KEY) {
+        keys[s] = key;
+        n_cells++;
+    } else if (sq_dist >= sq_dists[s])
+        return;
+    cells[s].f = f;
+    sq_dists[s] = sq_dist;
+}
+
+EnvelopeGrid::Side EnvelopeGrid::side(const GEO::vec3& p, double sq_eps) const {
+    if (n_cells == 0)
+        return Side::UNKNOWN;
+    const Side far_side = sq_eps <= sq_far_eps ? Side::OUT : Side::UNKNOWN;
+
+    std::array<int, 3> ijk;
+    for (int c = 0; c < 3; c++) {
+        double x = (p[c] - origin[c]) / h;
+        if (!(x >= 0 && x < (1 << KEY_BITS)))
+            return far_side;
+        ijk[c] = int(x);
+    }
+    const uint64_t key = getKey(ijk);
+    const std::size_t mask = keys.size() - 1;
+    std::size_t s = getSlot(key);
+    while (keys[s] != key) {
+        if (keys[s] == EMPTY_KEY)
+            return far_side;
+        s = (s + 1) & mask;
+    }
+
+    //the squares of floats are exact in double
+    const Cell& cell = cells[s];
+    if (cell.lower > 0 && double(cell.lower) * cell.lower > sq_eps)
+        return Side::OUT;
+    if (double(cell.upper) * cell.upper <= sq_eps)
+        return Side::IN;
+    if (squaredDistance(p, facets[cell.f]) <= sq_eps)
+        return Side::IN;
+    return Side::UNKNOWN;
+}
+
+} // namespace tetwild
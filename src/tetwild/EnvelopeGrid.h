@@ -0,0 +1,76 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <geogram/mesh/mesh.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tetwild {
+
+///sparse voxel grid over the band of the input surface, answering most envelope point queries with one lookup
+///a cell of the band stores a lower and an upper bound of the distance to the surface over the cell,
+///and the facet nearest to its center; a cell out of the band is farther than the eps of build() everywhere
+///the grid keeps its own copy of the facets, those of the mesh are reordered by the AABB trees
+class EnvelopeGrid {
+public:
+    enum class Side { IN, OUT, UNKNOWN };
+
+    static const int DEFAULT_MAX_CELLS = 1 << 21;
+
+    ///the cells are at least eps wide, and wider if the band would have more than max_cells of them
+    void build(const GEO::Mesh& M, double eps, int max_cells = DEFAULT_MAX_CELLS);
+    void clear();
+    bool empty() const { return n_cells == 0; }
+
+    ///IN/OUT are exact w.r.t. the squared distance to the surface, UNKNOWN leaves it to the AABB tree
+    Side side(const GEO::vec3& p, double sq_eps) const;
+
+    std::size_t cellCount() const { return n_cells; }
+    double cellSize() const { return h; }
+
+private:
+    struct Cell {
+        uint32_t f = 0;//nearest facet to the center
+        float lower = 0;//rounded down
+        float upper = 0;//rounded up
+    };
+
+    static const int KEY_BITS = 21;
+    static const uint64_t EMPTY_KEY = ~uint64_t(0);
+
+    static uint64_t getKey(const std::array<int, 3>& ijk) {
+        return uint64_t(ijk[0]) | (uint64_t(ijk[1]) << KEY_BITS) | (uint64_t(ijk[2]) << (2 * KEY_BITS));
+    }
+    std::size_t getSlot(uint64_t key) const {
+        return std::size_t((key * 0x9E3779B97F4A7C15ull) >> hash_shift);
+    }
+    GEO::vec3 getCenter(const std::array<int, 3>& ijk) const {
+        return GEO::vec3(origin[0] + (ijk[0] + 0.5) * h, origin[1] + (ijk[1] + 0.5) * h, origin[2] + (ijk[2] + 0.5) * h);
+    }
+    void resize(std::size_t n_slots, std::vector<double>& sq_dists);
+    void insert(uint64_t key, uint32_t f, double sq_dist, std::vector<double>& sq_dists);
+
+    std::vector<std::array<GEO::vec3, 3>> facets;
+
+    ///open addressing with linear probing, the table is a power of 2 at most half full
+    std::vector<uint64_t> keys;
+    std::vector<Cell> cells;
+    std::size_t n_cells = 0;
+    int hash_shift = 64;
+
+    GEO::vec3 origin;
+    double h = 0;
+    double r = 0;//half diagonal of a cell, with a margin for the rounding of the cell of a point
+    double sq_far_eps = 0;//the squared eps of build(), below which a point out of the band is out
+};
+
+} // namespace tetwild
@@ -0,0 +1,32 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+namespace tetwild {
+
+///work done by the envelope queries, summed over the calls of one operator during one pass
+///and written to the stats file with its MeshRecord, see LocalOperations::outputInfo()
+///n_calls and n_out count queries: a point, a batch of faces or the boundary points of an operation each count once,
+///n_samples_queried, n_grid_decided and n_hint_hits count points
+struct EnvelopeStats {
+    long long n_calls = 0;//queries
+    long long n_out = 0;//queries rejected
+    long long n_samples = 0;//samples generated on the faces and boundary edges
+    long long n_samples_queried = 0;//points and samples decided, up to the first one out
+    long long n_grid_decided = 0;//points decided by the grid without the tree
+    long long n_packets = 0;//traversals of the trees
+    long long n_hint_hits = 0;//points within eps of the hint facet/segment, found before traversing the tree
+    long long n_nodes = 0;//nodes of the trees visited
+    long long n_leaves = 0;//facets/segments tested
+
+    void clear() { *this = EnvelopeStats(); }
+};
+
+} // namespace tetwild
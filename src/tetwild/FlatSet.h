@@ -0,0 +1,74 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <vector>
+
+namespace tetwild {
+
+///set of ids stored as a sorted vector, for the small adjacency sets of the BSP complex
+///one allocation per set instead of a bucket array plus one node per id, and a deterministic iteration order
+class FlatSet {
+public:
+    typedef std::vector<int>::const_iterator iterator;
+    typedef std::vector<int>::const_iterator const_iterator;
+    typedef int value_type;
+
+    FlatSet() {}
+    FlatSet(std::initializer_list<int> l) { insert(l.begin(), l.end()); }
+    FlatSet& operator=(std::initializer_list<int> l) {
+        ids.clear();
+        insert(l.begin(), l.end());
+        return *this;
+    }
+
+    const_iterator begin() const { return ids.begin(); }
+    const_iterator end() const { return ids.end(); }
+    int size() const { return (int) ids.size(); }
+    bool empty() const { return ids.empty(); }
+    void clear() { ids.clear(); }
+    void reserve(int n) { ids.reserve(n); }
+
+    const_iterator find(int id) const {
+        const_iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+        return it != ids.end() && *it == id ? it : ids.end();
+    }
+    int count(int id) const { return std::binary_search(ids.begin(), ids.end(), id) ? 1 : 0; }
+
+    iterator insert(int id) {
+        std::vector<int>::iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id)
+            return it;
+        return ids.insert(it, id);
+    }
+    ///the hint is ignored, for std::inserter
+    iterator insert(const_iterator /*hint*/, int id) { return insert(id); }
+    template<typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    iterator erase(const_iterator it) { return ids.erase(it); }
+    int erase(int id) {
+        const_iterator it = find(id);
+        if (it == ids.end())
+            return 0;
+        ids.erase(it);
+        return 1;
+    }
+
+private:
+    std::vector<int> ids;
+};
+
+} // namespace tetwild
@@ -20,10 +20,10 @@
 
 namespace tetwild {
 
-void InoutFiltering::filter() {
+int InoutFiltering::filter() {
     ProgressHandler::Debug("In/out filtering...");
 
-    Eigen::MatrixXd C(std::count(t_is_removed.begin(), t_is_removed.end(), false), 3);
+    Eigen::MatrixXd C(tets.size(), 3);
     int cnt = 0;
     for (int i = 0; i < tets.size(); i++) {
         if (t_is_removed[i])
@@ -31,12 +31,13 @@ void InoutFiltering::filter() {
         std::vector<Point_3f> vs;
         vs.reserve(4);
         for (int j = 0; j < 4; j++)
-            vs.push_back(tet_vertices[tets[i][j]].posf);
+            vs.push_back(vertex_store.posf(tets[i][j]));
         Point_3f p = CGAL::centroid(vs.begin(), vs.end(), CGAL::Dimension_tag<0>());
         for (int j = 0; j < 3; j++)
             C(cnt, j) = p[j];
         cnt++;
     }
+    C.conservativeResize(cnt, 3);
 
     Eigen::MatrixXd V;
     Eigen::MatrixXi F;
@@ -46,16 +47,19 @@ void InoutFiltering::filter() {
 
     std::vector<bool> tmp_t_is_removed = t_is_removed;
     cnt = 0;
+    int n_inside = 0;
     for (int i = 0; i < tets.size(); i++) {
         if (tmp_t_is_removed[i])
             continue;
         tmp_t_is_removed[i] = !(W(cnt) > 0.5);
+        if (!tmp_t_is_removed[i])
+            n_inside++;
         cnt++;
     }
 
     //if the surface is totally reversed
     //TODO: test the correctness
-    if(std::count(tmp_t_is_removed.begin(), tmp_t_is_removed.end(), false)==0) {
+    if(n_inside==0) {
         ProgressHandler::Debug("Winding number gives a empty mesh! trying again");
         for (int i = 0; i < F.rows(); i++) {
             int tmp = F(i, 1);
@@ -71,6 +75,8 @@ void InoutFiltering::filter() {
             if (tmp_t_is_removed[i])
                 continue;
             tmp_t_is_removed[i] = !(W(cnt) > 0.5);
+            if (!tmp_t_is_removed[i])
+                n_inside++;
             cnt++;
         }
     }
@@ -78,29 +84,33 @@ void InoutFiltering::filter() {
 //    outputWindingNumberField(W);
 
     t_is_removed = tmp_t_is_removed;
+    surface_index.invalidate();
     ProgressHandler::Debug("In/out Filtered!");
+    return n_inside;
 }
 
 void InoutFiltering::getSurface(Eigen::MatrixXd& V, Eigen::MatrixXi& F){
+    if (!surface_index.isValid())
+        surface_index.build(tets, is_surface_fs, t_is_removed, state.NOT_SURFACE);
+    std::vector<int> tf_ids;
+    surface_index.getTetFaces(tf_ids);
+
     std::vector<std::array<int, 3>> fs;
     std::vector<int> vs;
-    for(int i=0;i<tets.size();i++) {
-        if (t_is_removed[i])
-            continue;
-        for (int j = 0; j < 4; j++) {
-            if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] > 0) {//outside
-                std::array<int, 3> v_ids = {{tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]}};
-                if (CGAL::orientation(tet_vertices[v_ids[0]].pos, tet_vertices[v_ids[1]].pos,
-                                      tet_vertices[v_ids[2]].pos, tet_vertices[tets[i][j]].pos) != CGAL::POSITIVE) {
-                    int tmp = v_ids[0];
-                    v_ids[0] = v_ids[2];
-                    v_ids[2] = tmp;
-                }
-                for (int k = 0; k < is_surface_fs[i][j]; k++)
-                    fs.push_back(v_ids);
-                for (int k = 0; k < 3; k++)
-                    vs.push_back(v_ids[k]);
+    for (int tf_id:tf_ids) {
+        int i = tf_id / 4, j = tf_id % 4;
+        if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] > 0) {//outside
+            std::array<int, 3> v_ids = {{tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]}};
+            if (CGAL::orientation(vertex_store.pos(v_ids[0]), vertex_store.pos(v_ids[1]),
+                                  vertex_store.pos(v_ids[2]), vertex_store.pos(tets[i][j])) != CGAL::POSITIVE) {
+                int tmp = v_ids[0];
+                v_ids[0] = v_ids[2];
+                v_ids[2] = tmp;
             }
+            for (int k = 0; k < is_surface_fs[i][j]; k++)
+                fs.push_back(v_ids);
+            for (int k = 0; k < 3; k++)
+                vs.push_back(v_ids[k]);
         }
     }
     std::sort(vs.begin(), vs.end());
@@ -111,7 +121,7 @@ void InoutFiltering::getSurface(Eigen::MatrixXd& V, Eigen::MatrixXi& F){
     for(int i=0;i<vs.size();i++){
         map_ids[vs[i]]=i;
         for(int j=0;j<3;j++)
-            V(i, j)=tet_vertices[vs[i]].posf[j];
+            V(i, j)=vertex_store.ptr(vs[i])[j];
     }
 
     F.resize(fs.size(), 3);
@@ -144,7 +154,7 @@ void InoutFiltering::outputWindingNumberField(const Eigen::VectorXd& W){
     Eigen::VectorXi oT(t_cnt * 4);
     for (int i = 0; i < v_ids.size(); i++) {
         for (int j = 0; j < 3; j++)
-            oV(i * 3 + j) = tet_vertices[v_ids[i]].posf[j];
+            oV(i * 3 + j) = vertex_store.ptr(v_ids[i])[j];
     }
     int cnt = 0;
     for (int i = 0; i < tets.size(); i++) {
@@ -13,6 +13,7 @@
 #define NEW_GTET_INOUTFILTERING_H
 
 #include <tetwild/TetmeshElements.h>
+#include <tetwild/SurfaceIndex.h>
 #include <Eigen/Dense>
 
 namespace tetwild {
@@ -20,24 +21,25 @@ namespace tetwild {
 class InoutFiltering {
 public:
     const State &state;
-    std::vector<TetVertex>& tet_vertices;
+    const TetVertexStore& vertex_store;
     std::vector<std::array<int, 4>>& tets;
     std::vector<std::array<int, 4>>& is_surface_fs;
+    SurfaceIndex& surface_index;
     std::vector<bool>& v_is_removed;
     std::vector<bool>& t_is_removed;
     std::vector<TetQuality>& tet_qualities;
 
     std::vector<bool> is_inside;
-    InoutFiltering(std::vector<TetVertex>& t_vs, std::vector<std::array<int, 4>>& ts,
-                   std::vector<std::array<int, 4>>& is_sf_fs,
+    InoutFiltering(const TetVertexStore& v_store, std::vector<std::array<int, 4>>& ts,
+                   std::vector<std::array<int, 4>>& is_sf_fs, SurfaceIndex& sf_index,
                    std::vector<bool>& v_is_rm, std::vector<bool>& t_is_rm, std::vector<TetQuality>& tet_qs,
                    const State &st):
-            tet_vertices(t_vs), tets(ts), is_surface_fs(is_sf_fs), v_is_removed(v_is_rm), t_is_removed(t_is_rm),
+            vertex_store(v_store), tets(ts), is_surface_fs(is_sf_fs), surface_index(sf_index), v_is_removed(v_is_rm), t_is_removed(t_is_rm),
             tet_qualities(tet_qs), state(st)
     { }
 
     void getSurface(Eigen::MatrixXd& V_sf, Eigen::MatrixXi& F_sf);
-    void filter();
+    int filter();///returns the number of remaining tets
 
     void outputWindingNumberField(const Eigen::VectorXd& W);
 };
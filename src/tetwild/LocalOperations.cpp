@@ -13,7 +13,6 @@
 #include <tetwild/Common.h>
 #include <tetwild/Args.h>
 #include <tetwild/ProgressHandler.h>
-#include <tetwild/DistanceQuery.h>
 #include <pymesh/MshSaver.h>
 #include <igl/svd3x3.h>
 #include <igl/Timer.h>
@@ -290,6 +289,167 @@ void LocalOperations::comformalAMIPSHessian_new(const double * T, double *result
     result_0[8] = helper_56*(-helper_108*helper_109*helper_65 - 1.11111111111111*pow(helper_109, 2)*helper_84 + 3.0);
 }
 
+int LocalOperations::getNewVertexSlot() {
+    int v_id = v_slots.pop();
+    if (v_id < 0) {
+        v_id = tet_vertices.size();
+        tet_vertices.push_back(TetVertex());
+        v_is_removed.push_back(false);
+        v_slots.grow(1);
+    } else {
+        tet_vertices[v_id] = TetVertex();
+        v_is_removed[v_id] = false;
+    }
+    vertex_store.reset(v_id);
+    return v_id;
+}
+
+void LocalOperations::getNewTetSlots(int n, std::vector<int>& new_t_ids) {
+    int cnt = 0;
+    for (; cnt < n; cnt++) {
+        int t_id = t_slots.pop();
+        if (t_id < 0)
+            break;
+        t_is_removed[t_id] = false;
+        new_t_ids.push_back(t_id);
+    }
+    if (cnt < n) {
+        for (int i = 0; i < n - cnt; i++)
+            new_t_ids.push_back(tets.size() + i);
+
+        tets.resize(tets.size() + n - cnt);
+        t_is_removed.resize(t_is_removed.size() + n - cnt, false);
+        tet_qualities.resize(tet_qualities.size() + n - cnt);
+        is_surface_fs.resize(is_surface_fs.size() + n - cnt);
+        opp_tets.resize(tets.size(), std::array<int, 4>({{-1, -1, -1, -1}}));
+        energy_stats.resize(tets.size());
+        t_slots.grow(n - cnt);
+    }
+}
+
+void LocalOperations::removeVertex(int v_id) {
+    v_is_removed[v_id] = true;
+    v_slots.push(v_id);
+}
+
+void LocalOperations::removeTet(int t_id) {
+    t_is_removed[t_id] = true;
+    t_slots.push(t_id);
+    energy_stats.remove(t_id);
+    invalidateTetQuality(t_id);//the slot may be reused with any vertices
+}
+
+void LocalOperations::setTetQuality(int t_id, const TetQuality& tq) {
+    tet_qualities[t_id] = tq;
+    energy_stats.set(t_id, tq.slim_energy, !isTetLocked_ui(t_id));
+}
+
+void LocalOperations::buildEnergyStats() {
+    energy_stats.init(tets.size(), state.MAX_ENERGY, args.filter_energy_thres);
+    for (int i = 0; i < tets.size(); i++) {
+        if (!t_is_removed[i])
+            energy_stats.set(i, tet_qualities[i].slim_energy, !isTetLocked_ui(i));
+    }
+}
+
+void LocalOperations::unindexSurfaceTets(const std::vector<int>& t_ids) {
+    for (int t_id:t_ids)
+        surface_index.removeTet(t_id, tets[t_id], is_surface_fs[t_id]);
+}
+
+void LocalOperations::indexSurfaceTets(const std::vector<int>& t_ids) {
+    for (int t_id:t_ids)
+        surface_index.addTet(t_id, tets[t_id], is_surface_fs[t_id]);
+}
+
+void LocalOperations::buildSurfaceIndex() {
+    surface_index.build(tets, is_surface_fs, t_is_removed, state.NOT_SURFACE);
+}
+
+int LocalOperations::Scratch::growthCount() const {
+    return t_ids.growthCount() + edge_t_ids.growthCount() + old_t_ids.growthCount() + new_t_ids.growthCount()
+           + changed_t_ids.growthCount() + n12_t_ids.growthCount() + n12_v_ids.growthCount()
+           + n1_v_ids.growthCount() + tags.growthCount() + tmp_tags.growthCount() + is_sf_fs.growthCount()
+           + is_removed.growthCount() + new_tets.growthCount() + tmp_new_tets.growthCount()
+           + tet_qs.growthCount() + tmp_tet_qs.growthCount() + es.growthCount() + update_sf_t_ids.growthCount()
+           + fs.growthCount() + tri_ids.growthCount() + opp_fs.growthCount() + tris.growthCount()
+           + exact_tris.growthCount() + bbox_t_ids.growthCount() + n_v_ids.growthCount()
+           + dirty_t_ids.growthCount() + dirty_tets.growthCount() + dirty_tet_qs.growthCount();
+}
+
+void LocalOperations::buildOppTets() {
+    opp_tets.assign(tets.size(), std::array<int, 4>({{-1, -1, -1, -1}}));
+    for (int i = 0; i < tets.size(); i++) {
+        if (t_is_removed[i])
+            continue;
+        for (int j = 0; j < 4; j++) {
+            if (opp_tets[i][j] >= 0)
+                continue;
+            int n_t_id = findOppTet(i, j);
+            if (n_t_id < 0)
+                continue;
+            opp_tets[i][j] = n_t_id;
+            opp_tets[n_t_id][getOppIndex(i, n_t_id, j)] = i;
+        }
+    }
+}
+
+void LocalOperations::updateOppTets(const std::vector<int>& t_ids) {
+    ///the faces shared by two changed tets are matched by sorting, the others are looked up in the one-rings
+    std::vector<std::array<int, 5>>& fs = scratch.opp_fs.get();//sorted face, t_id, j
+    fs.reserve(t_ids.size() * 4);
+    for (int t_id:t_ids) {
+        for (int j = 0; j < 4; j++) {
+            std::array<int, 5> f = {{tets[t_id][(j + 1) % 4], tets[t_id][(j + 2) % 4], tets[t_id][(j + 3) % 4], t_id, j}};
+            std::sort(f.begin(), f.begin() + 3);
+            fs.push_back(f);
+        }
+    }
+    std::sort(fs.begin(), fs.end());
+
+    for (int i = 0; i < fs.size(); i++) {
+        if (i + 1 < fs.size() && fs[i][0] == fs[i + 1][0] && fs[i][1] == fs[i + 1][1] && fs[i][2] == fs[i + 1][2]) {
+            opp_tets[fs[i][3]][fs[i][4]] = fs[i + 1][3];
+            opp_tets[fs[i + 1][3]][fs[i + 1][4]] = fs[i][3];
+            i++;
+            continue;
+        }
+        int t_id = fs[i][3], j = fs[i][4];
+        int n_t_id = findOppTet(t_id, j);
+        opp_tets[t_id][j] = n_t_id;
+        if (n_t_id >= 0)
+            opp_tets[n_t_id][getOppIndex(t_id, n_t_id, j)] = t_id;
+    }
+}
+
+int LocalOperations::findOppTet(int t_id, int j) {
+    int v1_id = tets[t_id][(j + 1) % 4];
+    int v2_id = tets[t_id][(j + 2) % 4];
+    int v3_id = tets[t_id][(j + 3) % 4];
+    if (tet_vertices[v2_id].conn_tets.size() < tet_vertices[v1_id].conn_tets.size())
+        std::swap(v1_id, v2_id);
+    if (tet_vertices[v3_id].conn_tets.size() < tet_vertices[v1_id].conn_tets.size())
+        std::swap(v1_id, v3_id);
+
+    for (int n_t_id:tet_vertices[v1_id].conn_tets) {
+        if (n_t_id == t_id)
+            continue;
+        const std::array<int, 4>& t = tets[n_t_id];
+        if (std::find(t.begin(), t.end(), v2_id) != t.end() && std::find(t.begin(), t.end(), v3_id) != t.end())
+            return n_t_id;
+    }
+    return -1;
+}
+
+int LocalOperations::getOppIndex(int t_id, int opp_t_id, int j) {
+    for (int k = 0; k < 4; k++) {
+        int v_id = tets[opp_t_id][k];
+        if (v_id != tets[t_id][(j + 1) % 4] && v_id != tets[t_id][(j + 2) % 4] && v_id != tets[t_id][(j + 3) % 4])
+            return k;
+    }
+    return -1;
+}
+
 void LocalOperations::check() {
     ///check correctness
     int n_size=0;
@@ -347,6 +507,10 @@ void LocalOperations::check() {
 
 void LocalOperations::outputInfo(int op_type, double time, bool is_log) {
     ProgressHandler::Debug("outputing info");
+    //the envelope stats are the ones of this pass of the operator
+    const EnvelopeStats envelope_stats = envelope_query.stats;
+    envelope_query.stats.clear();
+
     //update min/max dihedral angle infos
     for (int i = 0; i < tets.size(); i++) {
         if (!t_is_removed[i])
@@ -450,7 +614,7 @@ void LocalOperations::outputInfo(int op_type, double time, bool is_log) {
     for (int i = 0; i < tet_vertices.size(); i++) {
         if (!v_is_removed[i]) {
             cnt++;
-            if (tet_vertices[i].is_rounded) {
+            if (vertex_store.is(i, TetVertexStore::ROUNDED)) {
 //                if (tet_vertices[i].pos[0] != tet_vertices[i].posf[0]
 //                    || tet_vertices[i].pos[1] != tet_vertices[i].posf[1]
 //                    || tet_vertices[i].pos[2] != tet_vertices[i].posf[2]) {
@@ -486,6 +650,17 @@ void LocalOperations::outputInfo(int op_type, double time, bool is_log) {
 	ProgressHandler::Debug("# tets = {}({})", cnt, tets.size());
 	ProgressHandler::Debug("# total operations = {}", counter);
 	ProgressHandler::Debug("# accepted operations = {}", suc_counter);
+	ProgressHandler::Debug("# scratch growths = {}", scratch.growthCount());
+    ProgressHandler::Debug("# tet energies computed = {}, reused = {}", n_energies_computed, n_energies_reused);
+    n_energies_computed = 0;
+    n_energies_reused = 0;
+    if (args.use_energy_screening) {
+        ProgressHandler::Debug("# energy screenings = {}, accepted = {}, rejected = {}", n_screened, n_screen_accepted,
+                               n_screen_rejected);
+    }
+    n_screened = 0;
+    n_screen_accepted = 0;
+    n_screen_rejected = 0;
 
 
     double min = 10, max = 0;
@@ -525,10 +700,19 @@ void LocalOperations::outputInfo(int op_type, double time, bool is_log) {
     ProgressHandler::Debug("avg_min_d_angle = {}, avg_max_d_angle = {}, avg_slim_energy = {}", min_avg / cnt, max_avg / cnt, avg_slim_energy / cnt);
     ProgressHandler::Debug("min_d_angle: <6 {};   <12 {};  <18 {}", cmp_cnt[0] / cnt, cmp_cnt[1] / cnt, cmp_cnt[2] / cnt);
     ProgressHandler::Debug("max_d_angle: >174 {}; >168 {}; >162 {}", cmp_cnt[5] / cnt, cmp_cnt[4] / cnt, cmp_cnt[3] / cnt);
+    if (envelope_stats.n_calls > 0) {
+        const EnvelopeStats& es = envelope_stats;
+        ProgressHandler::Debug("envelope: {} queries, {} out; samples: {} queried / {} generated, {} by grid",
+                               es.n_calls, es.n_out, es.n_samples_queried, es.n_samples, es.n_grid_decided);
+        ProgressHandler::Debug("envelope: {} traversals, {} hint hits, {} nodes, {} leaves",
+                               es.n_packets, es.n_hint_hits, es.n_nodes, es.n_leaves);
+    }
 
     if(is_log) {
-        addRecord(MeshRecord(op_type, time, std::count(v_is_removed.begin(), v_is_removed.end(), false), cnt,
-                             min, min_avg / cnt, max, max_avg / cnt, max_slim_energy, avg_slim_energy / cnt), args, state);
+        MeshRecord record(op_type, time, v_slots.liveCount(), cnt,
+                          min, min_avg / cnt, max, max_avg / cnt, max_slim_energy, avg_slim_energy / cnt);
+        record.envelope = envelope_stats;
+        addRecord(record, args, state);
     }
 }
 
@@ -536,16 +720,16 @@ bool LocalOperations::isTetFlip(const std::array<int, 4>& t) {
     CGAL::Orientation ori;
     bool is_rounded = true;
     for (int j = 0; j < 4; j++)
-        if (!tet_vertices[t[j]].is_rounded) {
+        if (!vertex_store.is(t[j], TetVertexStore::ROUNDED)) {
             is_rounded = false;
             break;
         }
     if (is_rounded)
-        ori = CGAL::orientation(tet_vertices[t[0]].posf, tet_vertices[t[1]].posf, tet_vertices[t[2]].posf,
-                                tet_vertices[t[3]].posf);
+        ori = CGAL::orientation(vertex_store.posf(t[0]), vertex_store.posf(t[1]), vertex_store.posf(t[2]),
+                                vertex_store.posf(t[3]));
     else
-        ori = CGAL::orientation(tet_vertices[t[0]].pos, tet_vertices[t[1]].pos, tet_vertices[t[2]].pos,
-                                tet_vertices[t[3]].pos);
+        ori = CGAL::orientation(vertex_store.pos(t[0]), vertex_store.pos(t[1]), vertex_store.pos(t[2]),
+                                vertex_store.pos(t[3]));
 
     if (ori != CGAL::POSITIVE)
         return true;
@@ -603,71 +787,30 @@ void LocalOperations::getCheckQuality(const std::vector<int>& t_ids, TetQuality&
 }
 
 void LocalOperations::getAvgMaxEnergy(double& avg_tq, double& max_tq) {
-    avg_tq = 0;
-    max_tq = 0;
-    int cnt = 0;
-    for (unsigned int i = 0; i < tet_qualities.size(); i++) {
-        if (t_is_removed[i])
-            continue;
-        if(isTetLocked_ui(i))
-            continue;
-        if (tet_qualities[i].slim_energy > max_tq)
-            max_tq = tet_qualities[i].slim_energy;
-        avg_tq += tet_qualities[i].slim_energy;
-        cnt++;
-    }
-    avg_tq /= cnt;
+    if (!energy_stats.isValid())
+        buildEnergyStats();
+    avg_tq = energy_stats.getAvgEnergy();
+    max_tq = energy_stats.getMaxEnergy();
     if(std::isinf(avg_tq))
         avg_tq = state.MAX_ENERGY;
 }
 
 double LocalOperations::getMaxEnergy(){
-    double max_tq = 0;
-    for (unsigned int i = 0; i < tet_qualities.size(); i++) {
-        if (t_is_removed[i])
-            continue;
-        if(isTetLocked_ui(i))
-            continue;
-        if (tet_qualities[i].slim_energy > max_tq)
-            max_tq = tet_qualities[i].slim_energy;
-    }
-    return max_tq;
+    if (!energy_stats.isValid())
+        buildEnergyStats();
+    return energy_stats.getMaxEnergy();
 }
 
 double LocalOperations::getSecondMaxEnergy(double max_energy){
-    double max_tq = 0;
-    for (unsigned int i = 0; i < tet_qualities.size(); i++) {
-        if (t_is_removed[i])
-            continue;
-        if(tet_qualities[i].slim_energy == state.MAX_ENERGY)
-            continue;
-        if(isTetLocked_ui(i))
-            continue;
-        if (tet_qualities[i].slim_energy > max_tq)
-            max_tq = tet_qualities[i].slim_energy;
-    }
-    return max_tq;
+    if (!energy_stats.isValid())
+        buildEnergyStats();
+    return energy_stats.getSecondMaxEnergy();
 }
 
 double LocalOperations::getFilterEnergy(bool& is_clean_up) {
-    std::array<int, 11> buckets;
-    for (int i = 0; i < 11; i++)
-        buckets[i] = 0;
-    for (unsigned int i = 0; i < tet_qualities.size(); i++) {
-        if (t_is_removed[i])
-            continue;
-        if (tet_qualities[i].slim_energy > args.filter_energy_thres - 1 + 1e10)
-            buckets[10]++;
-        else {
-            for (int j = 0; j < 10; j++) {
-                if (tet_qualities[i].slim_energy > args.filter_energy_thres - 1 + pow(10, j)
-                    && tet_qualities[i].slim_energy <= args.filter_energy_thres - 1 + pow(10, j + 1)) {
-                    buckets[j]++;
-                    break;
-                }
-            }
-        }
-    }
+    if (!energy_stats.isValid())
+        buildEnergyStats();
+    const std::array<int, EnergyStats::N_BUCKETS>& buckets = energy_stats.getBuckets();
 
     std::array<int, 10> tmps1;
     std::array<int, 10> tmps2;
@@ -695,89 +838,112 @@ double LocalOperations::getFilterEnergy(bool& is_clean_up) {
 void LocalOperations::calTetQualities(const std::vector<std::array<int, 4>>& new_tets, std::vector<TetQuality>& tet_qs,
                                       bool all_measure) {
     tet_qs.resize(new_tets.size());
-#ifdef TETWILD_WITH_ISPC
-    int n = new_tets.size();
-
-    static thread_local std::vector<double> T0;
-    static thread_local std::vector<double> T1;
-    static thread_local std::vector<double> T2;
-    static thread_local std::vector<double> T3;
-    static thread_local std::vector<double> T4;
-    static thread_local std::vector<double> T5;
-    static thread_local std::vector<double> T6;
-    static thread_local std::vector<double> T7;
-    static thread_local std::vector<double> T8;
-    static thread_local std::vector<double> T9;
-    static thread_local std::vector<double> T10;
-    static thread_local std::vector<double> T11;
-    static thread_local std::vector<double> energy;
-
-    if (T0.empty()) {
-        // logger().trace("Initial ISPC allocation: n = {}", n);
-    } else if (T0.size() != n) {
-        // logger().trace("ISPC reallocation: n = {}", n);
+    if (energy_type != state.ENERGY_AMIPS) {
+        for (int i = 0; i < new_tets.size(); i++)
+            calTetQuality_AMIPS(new_tets[i], tet_qs[i]);
+        return;
     }
 
-    T0.resize(n);
-    T1.resize(n);
-    T2.resize(n);
-    T3.resize(n);
-    T4.resize(n);
-    T5.resize(n);
-    T6.resize(n);
-    T7.resize(n);
-    T8.resize(n);
-    T9.resize(n);
-    T10.resize(n);
-    T11.resize(n);
-    energy.resize(n);
-
-    for (int i = 0; i < n; i++) {
-        T0[i] = tet_vertices[new_tets[i][0]].posf[0];
-        T1[i] = tet_vertices[new_tets[i][0]].posf[1];
-        T2[i] = tet_vertices[new_tets[i][0]].posf[2];
-        T3[i] = tet_vertices[new_tets[i][1]].posf[0];
-        T4[i] = tet_vertices[new_tets[i][1]].posf[1];
-        T5[i] = tet_vertices[new_tets[i][1]].posf[2];
-        T6[i] = tet_vertices[new_tets[i][2]].posf[0];
-        T7[i] = tet_vertices[new_tets[i][2]].posf[1];
-        T8[i] = tet_vertices[new_tets[i][2]].posf[2];
-        T9[i] = tet_vertices[new_tets[i][3]].posf[0];
-        T10[i] = tet_vertices[new_tets[i][3]].posf[1];
-        T11[i] = tet_vertices[new_tets[i][3]].posf[2];
+    const uint64_t version = vertex_store.getVersion();
+    static thread_local AMIPSBatch batch;
+    batch.resize(new_tets.size());
+    for (int i = 0; i < new_tets.size(); i++) {
+        std::array<double, 12> T;
+        vertex_store.gatherTet(new_tets[i], T.data());
+        batch.setTet(i, T.data());
     }
-
-    ispc::energy_ispc(T0.data(), T1.data(), T2.data(), T3.data(), T4.data(),
-        T5.data(), T6.data(), T7.data(), T8.data(),
-        T9.data(), T10.data(), T11.data(), energy.data(), n);
+    batch.computeEnergies();
 
     for (int i = 0; i < new_tets.size(); i++) {
-        CGAL::Orientation ori = CGAL::orientation(tet_vertices[new_tets[i][0]].posf,
-                                                  tet_vertices[new_tets[i][1]].posf,
-                                                  tet_vertices[new_tets[i][2]].posf,
-                                                  tet_vertices[new_tets[i][3]].posf);
-        if (ori != CGAL::POSITIVE) {
+        tet_qs[i].energy_version = version;
+        //the orientation is filtered with the energies, the exact predicate only decides the tets the filter fails on
+        bool is_positive = batch.orientationFilter(i) > 0;
+        if (batch.orientationFilter(i) == 0) {
+            is_positive = CGAL::orientation(vertex_store.posf(new_tets[i][0]), vertex_store.posf(new_tets[i][1]),
+                                            vertex_store.posf(new_tets[i][2]), vertex_store.posf(new_tets[i][3]))
+                          == CGAL::POSITIVE;
+        }
+        if (!is_positive) {//degenerate in floats
             tet_qs[i].slim_energy = state.MAX_ENERGY;
             continue;
-        } else
-            tet_qs[i].slim_energy = energy[i];
-
-        if (std::isinf(energy[i]) || std::isnan(energy[i]))
+        }
+        tet_qs[i].slim_energy = batch.energy(i);
+        if (std::isinf(tet_qs[i].slim_energy) || std::isnan(tet_qs[i].slim_energy) || tet_qs[i].slim_energy <= 0)
             tet_qs[i].slim_energy = state.MAX_ENERGY;
     }
-#else
+}
+
+void LocalOperations::calTetQualities(const std::vector<int>& t_ids, bool all_measure) {
+    //the energy of a tet only depends on the positions of its vertices
+    std::vector<int>& dirty_t_ids = scratch.dirty_t_ids.get();
+    std::vector<std::array<int, 4>>& dirty_tets = scratch.dirty_tets.get();
+    for (int t_id:t_ids) {
+        const TetQuality& tq = tet_qualities[t_id];
+        if (energy_type == state.ENERGY_AMIPS && !args.validate_energy_cache && tq.energy_version > 0
+            && vertex_store.isUnchangedSince(tets[t_id], tq.energy_version))
+            continue;
+        dirty_t_ids.push_back(t_id);
+        dirty_tets.push_back(tets[t_id]);
+    }
+    n_energies_computed += dirty_t_ids.size();
+    n_energies_reused += t_ids.size() - dirty_t_ids.size();
+    if (dirty_t_ids.empty())
+        return;
+
+    std::vector<TetQuality>& dirty_tet_qs = scratch.dirty_tet_qs.get();
+    calTetQualities(dirty_tets, dirty_tet_qs, all_measure);
+    int n_out_of_date = 0;
+    for (int i = 0; i < dirty_t_ids.size(); i++) {
+        const TetQuality& tq = tet_qualities[dirty_t_ids[i]];
+        if (args.validate_energy_cache && tq.energy_version > 0
+            && vertex_store.isUnchangedSince(dirty_tets[i], tq.energy_version)
+            && std::abs(tq.slim_energy - dirty_tet_qs[i].slim_energy)
+               > AMIPS_SIMD_TOLERANCE * std::abs(dirty_tet_qs[i].slim_energy))
+            n_out_of_date++;
+        setTetQuality(dirty_t_ids[i], dirty_tet_qs[i]);
+    }
+    if (n_out_of_date > 0)
+        ProgressHandler::Warn("{} cached tet energies out of date", n_out_of_date);
+}
+
+int LocalOperations::screenTetQualities(const std::vector<std::array<int, 4>>& new_tets, double old_energy) {
+    if (!args.use_energy_screening || energy_type != state.ENERGY_AMIPS || !state.use_energy_max)
+        return SCREEN_UNSURE;
+
+    static thread_local AMIPSScreenBatch batch;
+    batch.resize(new_tets.size());
     for (int i = 0; i < new_tets.size(); i++) {
-        calTetQuality_AMIPS(new_tets[i], tet_qs[i]);
+        std::array<double, 12> T;
+        vertex_store.gatherTet(new_tets[i], T.data());
+        batch.setTet(i, T.data());
     }
-#endif
+    batch.computeBounds();
+    double max_lower = 0, max_upper = 0;
+    for (int i = 0; i < new_tets.size(); i++) {
+        max_lower = std::max(max_lower, batch.lowerCube(i));
+        max_upper = std::max(max_upper, batch.upperCube(i));
+    }
+
+    //the cube is increasing, the margin covers its rounding
+    const double old_cube = old_energy * old_energy * old_energy;
+    n_screened++;
+    if (max_lower > old_cube * (1 + 1e-12)) {
+        n_screen_rejected++;
+        return SCREEN_REJECT;
+    }
+    if (max_upper < old_cube * (1 - 1e-12)) {
+        n_screen_accepted++;
+        return SCREEN_ACCEPT;
+    }
+    return SCREEN_UNSURE;
 }
 
 double LocalOperations::calEdgeLength(const std::array<int, 2>& v_ids){
-    return CGAL::squared_distance(tet_vertices[v_ids[0]].posf, tet_vertices[v_ids[1]].posf);
+    return vertex_store.squaredDistance(v_ids[0], v_ids[1]);
 }
 
 double LocalOperations::calEdgeLength(int v1_id,int v2_id, bool is_over_refine) {
-    return CGAL::squared_distance(tet_vertices[v1_id].posf, tet_vertices[v2_id].posf);
+    return vertex_store.squaredDistance(v1_id, v2_id);
 }
 
 void LocalOperations::calTetQuality_AD(const std::array<int, 4>& tet, TetQuality& t_quality) {
@@ -785,22 +951,22 @@ void LocalOperations::calTetQuality_AD(const std::array<int, 4>& tet, TetQuality
     std::array<double, 4> nv_length;
     std::array<double, 4> heights;
     for (int i = 0; i < 4; i++) {
-        Plane_3f pln(tet_vertices[tet[(i + 1) % 4]].posf,
-                    tet_vertices[tet[(i + 2) % 4]].posf,
-                    tet_vertices[tet[(i + 3) % 4]].posf);
+        Plane_3f pln(vertex_store.posf(tet[(i + 1) % 4]),
+                    vertex_store.posf(tet[(i + 2) % 4]),
+                    vertex_store.posf(tet[(i + 3) % 4]));
         if(pln.is_degenerate()){
             t_quality.min_d_angle = 0;
             t_quality.max_d_angle = M_PI;
             return;
         }
-        Point_3f tmp_p = pln.projection(tet_vertices[tet[i]].posf);
-        if(tmp_p == tet_vertices[tet[i]].posf){
+        Point_3f tmp_p = pln.projection(vertex_store.posf(tet[i]));
+        if(tmp_p == vertex_store.posf(tet[i])){
             t_quality.min_d_angle = 0;
             t_quality.max_d_angle = M_PI;
             return;
         }
-        nv[i] = tet_vertices[tet[i]].posf - tmp_p;
-        heights[i] = CGAL::squared_distance(tet_vertices[tet[i]].posf, tmp_p);
+        nv[i] = vertex_store.posf(tet[i]) - tmp_p;
+        heights[i] = CGAL::squared_distance(vertex_store.posf(tet[i]), tmp_p);
 
 //        if(std::isnan(heights[i])){//because pln is degenerate
 //            logger().debug("{}", tet_vertices[tet[i]].posf);
@@ -831,11 +997,7 @@ void LocalOperations::calTetQuality_AD(const std::array<int, 4>& tet, TetQuality
         }
     }
 
-    std::vector<std::array<int, 2>> opp_edges;
-    for (int i = 0; i < 3; i++) {
-        opp_edges.push_back(std::array<int, 2>({{0, i + 1}}));
-        opp_edges.push_back(std::array<int, 2>({{i + 1, (i + 1) % 3 + 1}}));
-    }
+    static const std::array<std::array<int, 2>, 6> opp_edges = {{{{0, 1}}, {{1, 2}}, {{0, 2}}, {{2, 3}}, {{0, 3}}, {{3, 1}}}};
 
     ////compute dihedral angles
     std::array<double, 6> dihedral_angles;
@@ -861,19 +1023,16 @@ void LocalOperations::calTetQuality_AD(const std::array<int, 4>& tet, TetQuality
 
 void LocalOperations::calTetQuality_AMIPS(const std::array<int, 4>& tet, TetQuality& t_quality) {
     if (energy_type == state.ENERGY_AMIPS) {
-        CGAL::Orientation ori = CGAL::orientation(tet_vertices[tet[0]].posf,
-                                                  tet_vertices[tet[1]].posf,
-                                                  tet_vertices[tet[2]].posf,
-                                                  tet_vertices[tet[3]].posf);
+        CGAL::Orientation ori = CGAL::orientation(vertex_store.posf(tet[0]),
+                                                  vertex_store.posf(tet[1]),
+                                                  vertex_store.posf(tet[2]),
+                                                  vertex_store.posf(tet[3]));
+        t_quality.energy_version = vertex_store.getVersion();
         if (ori != CGAL::POSITIVE) {//degenerate in floats
             t_quality.slim_energy = state.MAX_ENERGY;
         } else {
             std::array<double, 12> T;
-            for (int i = 0; i < 4; i++) {
-                for (int j = 0; j < 3; j++) {
-                    T[i*3+j] = tet_vertices[tet[i]].posf[j];
-                }
-            }
+            vertex_store.gatherTet(tet, T.data());
             t_quality.slim_energy = comformalAMIPSEnergy_new(T.data());
             if (std::isinf(t_quality.slim_energy) || std::isnan(t_quality.slim_energy))
                 t_quality.slim_energy = state.MAX_ENERGY;
@@ -884,25 +1043,26 @@ void LocalOperations::calTetQuality_AMIPS(const std::array<int, 4>& tet, TetQual
 }
 
 bool LocalOperations::isEdgeOnSurface(int v1_id, int v2_id) {
-    if (!tet_vertices[v1_id].is_on_surface || !tet_vertices[v2_id].is_on_surface)
+    if (!vertex_store.is(v1_id, TetVertexStore::ON_SURFACE) || !vertex_store.is(v2_id, TetVertexStore::ON_SURFACE))
         return false;
 
-    std::vector<int> t_ids;
-    setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, t_ids);
-    assert(t_ids.size()!=0);
-    return isEdgeOnSurface(v1_id, v2_id, t_ids);
+    if (!surface_index.isValid())
+        buildSurfaceIndex();
+    return surface_index.isEdgeOnSurface(v1_id, v2_id);
 }
 
 bool LocalOperations::isEdgeOnBbox(int v1_id, int v2_id){
-    if(!tet_vertices[v1_id].is_on_bbox || !tet_vertices[v2_id].is_on_bbox)
+    if(!vertex_store.is(v1_id, TetVertexStore::ON_BBOX) || !vertex_store.is(v2_id, TetVertexStore::ON_BBOX))
         return false;
 
-    std::vector<int> t_ids;
-    setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, t_ids);
+    std::vector<int>& t_ids = scratch.bbox_t_ids.get();
+    getEdgeConnTets(v1_id, v2_id, t_ids);
     return isEdgeOnBbox(v1_id, v2_id, t_ids);
 }
 
 bool LocalOperations::isEdgeOnSurface(int v1_id, int v2_id, const std::vector<int>& t_ids){
+    if (surface_index.isValid())
+        return surface_index.isEdgeOnSurface(v1_id, v2_id);
     for (int i = 0; i < t_ids.size(); i++) {
         for (int j = 0; j < 4; j++) {
             if (tets[t_ids[i]][j] != v1_id && tets[t_ids[i]][j] != v2_id) {
@@ -915,14 +1075,16 @@ bool LocalOperations::isEdgeOnSurface(int v1_id, int v2_id, const std::vector<in
 }
 
 bool LocalOperations::isEdgeOnBbox(int v1_id, int v2_id, const std::vector<int>& t_ids){
-    std::unordered_set<int> v_ids;
+    std::vector<int>& v_ids = scratch.n_v_ids.get();
     for (int i = 0; i < t_ids.size(); i++) {
         for (int j = 0; j < 4; j++) {
             if (tets[t_ids[i]][j] != v1_id && tets[t_ids[i]][j] != v2_id) {
-                v_ids.insert(tets[t_ids[i]][j]);
+                v_ids.push_back(tets[t_ids[i]][j]);
             }
         }
     }
+    std::sort(v_ids.begin(), v_ids.end());
+    v_ids.erase(std::unique(v_ids.begin(), v_ids.end()), v_ids.end());
     if(v_ids.size()!=t_ids.size())
         return true;
     return false;
@@ -935,7 +1097,7 @@ bool LocalOperations::isEdgeOnBoundary(int v1_id, int v2_id) {
     if(state.is_mesh_closed)
         return false;
 
-    if (!tet_vertices[v1_id].is_on_boundary || !tet_vertices[v2_id].is_on_boundary)
+    if (!vertex_store.is(v1_id, TetVertexStore::ON_BOUNDARY) || !vertex_store.is(v2_id, TetVertexStore::ON_BOUNDARY))
         return false;
 
 //    return true;
@@ -966,10 +1128,17 @@ bool LocalOperations::isEdgeOnBoundary(int v1_id, int v2_id) {
 
 bool LocalOperations::isFaceOutEnvelop(const Triangle_3f& tri) {
 #if CHECK_ENVELOP
-    if(state.use_sampling){
-        return isFaceOutEnvelop_sampling(tri);
-    }
-    return true;
+    envelope_query.cache.setEnvelope(&geo_sf_mesh, state.eps, state.sampling_dist);
+    bool is_out = true;
+    if (envelope_query.cache.find(tri, is_out))
+        return is_out;
+
+    if (args.use_exact_envelope)
+        is_out = isFaceOutEnvelop_exact(tri);
+    else if(state.use_sampling)
+        is_out = isFaceOutEnvelop_sampling(tri);
+    envelope_query.cache.insert(tri, is_out);
+    return is_out;
 #else
     return false;
 #endif
@@ -1031,78 +1200,71 @@ bool LocalOperations::isFaceOutEnvelop(const Triangle_3f& tri) {
 //    }
 }
 
-bool LocalOperations::isPointOutEnvelop(const Point_3f& p) {
+bool LocalOperations::isFacesOutEnvelop(const std::vector<Triangle_3f>& tris) {
 #if CHECK_ENVELOP
-    GEO::vec3 geo_p(p[0], p[1], p[2]);
-    if (geo_sf_tree.squared_distance(geo_p) > state.eps_2)
-        return true;
+    envelope_query.cache.setEnvelope(&geo_sf_mesh, state.eps, state.sampling_dist);
+    //the faces not in the cache, largest first: they have the most samples and are the most likely to be out
+    std::vector<std::pair<double, int>>& areas = envelope_query.areas;
+    std::vector<const Triangle_3f*>& todo_tris = envelope_query.tris;
+    areas.clear();
+    for (int i = 0; i < tris.size(); i++) {
+        bool is_out = true;
+        if (!envelope_query.cache.find(tris[i], is_out))
+            areas.push_back(std::make_pair(-tris[i].squared_area(), i));
+        else if (is_out)
+            return true;
+    }
+    std::sort(areas.begin(), areas.end());
+
+    if (args.use_exact_envelope || !state.use_sampling) {
+        for (const auto& a: areas) {
+            //out without the exact envelope, as in isFaceOutEnvelop()
+            bool is_out = !args.use_exact_envelope || isFaceOutEnvelop_exact(tris[a.second]);
+            envelope_query.cache.insert(tris[a.second], is_out);
+            if (is_out)
+                return true;
+        }
+        return false;
+    }
 
+    todo_tris.clear();
+    for (const auto& a: areas)
+        todo_tris.push_back(&tris[a.second]);
+    int out_id = envelope.findFaceOut_sampling(todo_tris.data(), todo_tris.size(), state.eps_2, state.sampling_dist,
+                                               envelope_query);
+    if (out_id >= 0) {
+        envelope_query.cache.insert(*todo_tris[out_id], true);
+        return true;
+    }
+    for (const Triangle_3f* tri: todo_tris)
+        envelope_query.cache.insert(*tri, false);
     return false;
 #else
     return false;
 #endif
 }
 
-bool LocalOperations::isFaceOutEnvelop_sampling(const Triangle_3f& tri) {
+bool LocalOperations::isPointOutEnvelop(const Point_3f& p) {
 #if CHECK_ENVELOP
-    if (tri.is_degenerate())
-        return false;
-
-#if TIMING_BREAKDOWN
-    igl_timer0.start();
-#endif
-    std::array<GEO::vec3, 3> vs = {{GEO::vec3(tri[0][0], tri[0][1], tri[0][2]),
-                                    GEO::vec3(tri[1][0], tri[1][1], tri[1][2]),
-                                    GEO::vec3(tri[2][0], tri[2][1], tri[2][2])}};
-    static thread_local std::vector<GEO::vec3> ps;
-    ps.clear();
-    sampleTriangle(vs, ps, state.sampling_dist);
-#if TIMING_BREAKDOWN
-    breakdown_timing0[id_sampling] += igl_timer0.getElapsedTime();
-#endif
-
-    size_t num_queries = 0;
-    size_t num_samples = ps.size();
-
-    //decide in/out
-#if TIMING_BREAKDOWN
-    igl_timer0.start();
-#endif
-
-    GEO::vec3 current_point = ps[0];
-    GEO::vec3 nearest_point;
-    double sq_dist = std::numeric_limits<double>::max();
-    GEO::index_t prev_facet = GEO::NO_FACET;
-    int cnt = 0;
-    const unsigned int ps_size = ps.size();
-    for (unsigned int i = ps_size / 2; i < ps.size(); i = (i + 1) % ps_size) {//check from the middle
-        GEO::vec3 &current_point = ps[i];
-        if (prev_facet != GEO::NO_FACET) {
-            get_point_facet_nearest_point(geo_sf_mesh, current_point, prev_facet, nearest_point, sq_dist);
-        }
-        if (sq_dist > state.eps_2) {
-            geo_sf_tree.facet_in_envelope_with_hint(
-                current_point, state.eps_2, prev_facet, nearest_point, sq_dist);
-        }
-        ++num_queries;
-        if (sq_dist > state.eps_2) {
-#if TIMING_BREAKDOWN
-            breakdown_timing0[id_aabb] += igl_timer0.getElapsedTime();
+    return envelope.isPointOut(GEO::vec3(p[0], p[1], p[2]), state.eps_2, envelope_query);
+#else
+    return false;
 #endif
-            ProgressHandler::Trace("num_queries {} / {}", num_queries, num_samples);
-            return true;
-        }
-        cnt++;
-        if (cnt >= ps_size)
-            break;
-    }
+}
 
-#if TIMING_BREAKDOWN
-    breakdown_timing0[id_aabb] += igl_timer0.getElapsedTime();
+bool LocalOperations::isFaceOutEnvelop_sampling(const Triangle_3f& tri) {
+#if CHECK_ENVELOP
+    const Triangle_3f* p_tri = &tri;
+    return envelope.findFaceOut_sampling(&p_tri, 1, state.eps_2, state.sampling_dist, envelope_query) >= 0;
+#else
+    return false;
 #endif
+}
 
-    ProgressHandler::Trace("num_queries {} / {}", num_queries, num_samples);
-    return false;
+bool LocalOperations::isFaceOutEnvelop_exact(const Triangle_3f& tri) {
+#if CHECK_ENVELOP
+    //the sampling error d_k/sqrt(3) of the current stage is not needed, the envelope is the one the samples guarantee
+    return envelope.isFaceOut_exact(tri, state.eps + state.sampling_dist / std::sqrt(3), envelope_query);
 #else
     return false;
 #endif
@@ -1110,11 +1272,7 @@ bool LocalOperations::isFaceOutEnvelop_sampling(const Triangle_3f& tri) {
 
 bool LocalOperations::isPointOutBoundaryEnvelop(const Point_3f& p) {
 #if CHECK_ENVELOP
-    GEO::vec3 geo_p(p[0], p[1], p[2]);
-    if (geo_b_tree.squared_distance(geo_p) > state.eps_2) {
-        return true;
-    }
-    return false;
+    return envelope.isPointOutBoundary(GEO::vec3(p[0], p[1], p[2]), state.eps_2, envelope_query);
 #else
     return false;
 #endif
@@ -1130,24 +1288,24 @@ bool LocalOperations::isBoundarySlide(int v1_id, int v2_id, Point_3f& old_pf){
     std::unordered_set<int> n_v_ids;
     for(int t_id:tet_vertices[v1_id].conn_tets){
         for(int j=0;j<4;j++)
-            if(tets[t_id][j]!=v1_id && tets[t_id][j]!=v2_id && tet_vertices[tets[t_id][j]].is_on_boundary)
+            if(tets[t_id][j]!=v1_id && tets[t_id][j]!=v2_id && vertex_store.is(tets[t_id][j], TetVertexStore::ON_BOUNDARY))
                 n_v_ids.insert(tets[t_id][j]);
     }
     if(n_v_ids.size()==0)
         return false;
 
 #if TIMING_BREAKDOWN
-    igl_timer0.start();
+    envelope_query.timer.start();
 #endif
-    static thread_local std::vector<GEO::vec3> b_points;
-    static thread_local std::vector<GEO::vec3> ps;
+    std::vector<GEO::vec3>& b_points = envelope_query.b_points;
+    std::vector<GEO::vec3>& ps = envelope_query.ps;
     b_points.clear();
     for(int v_id:n_v_ids) {
         if (!isEdgeOnBoundary(v1_id, v_id))
             continue;
         //sample the edge (v1, v) and push the sampling points into vector
-        GEO::vec3 p1(tet_vertices[v1_id].posf[0], tet_vertices[v1_id].posf[1], tet_vertices[v1_id].posf[2]);
-        GEO::vec3 p2(tet_vertices[v_id].posf[0], tet_vertices[v_id].posf[1], tet_vertices[v_id].posf[2]);
+        GEO::vec3 p1(vertex_store.ptr(v1_id)[0], vertex_store.ptr(v1_id)[1], vertex_store.ptr(v1_id)[2]);
+        GEO::vec3 p2(vertex_store.ptr(v_id)[0], vertex_store.ptr(v_id)[1], vertex_store.ptr(v_id)[2]);
         b_points.push_back(p1);
         b_points.push_back(p2);
         int n = GEO::distance(p1, p2) / state.sampling_dist + 1;
@@ -1159,13 +1317,13 @@ bool LocalOperations::isBoundarySlide(int v1_id, int v2_id, Point_3f& old_pf){
     }
 
     //sampling faces
-    if(v2_id>=0 && tet_vertices[v2_id].is_on_boundary) {
+    if(v2_id>=0 && vertex_store.is(v2_id, TetVertexStore::ON_BOUNDARY)) {
         std::vector<int> n12_t_ids;
-        setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, n12_t_ids);
+        getEdgeConnTets(v1_id, v2_id, n12_t_ids);
         std::unordered_set<int> n12_v_ids;
         for (int t_id:n12_t_ids) {
             for (int j = 0; j < 4; j++)
-                if (tets[t_id][j] != v1_id && tets[t_id][j] != v2_id && tet_vertices[tets[t_id][j]].is_on_boundary)
+                if (tets[t_id][j] != v1_id && tets[t_id][j] != v2_id && vertex_store.is(tets[t_id][j], TetVertexStore::ON_BOUNDARY))
                     n12_v_ids.insert(tets[t_id][j]);
         }
         bool is_12_on_boundary = false;
@@ -1176,7 +1334,7 @@ bool LocalOperations::isBoundarySlide(int v1_id, int v2_id, Point_3f& old_pf){
             if (!isEdgeOnBoundary(v1_id, v_id) || !isEdgeOnBoundary(v2_id, v_id))
                 continue;
             if (!is_12_on_boundary) {
-                GEO::vec3 p1(tet_vertices[v1_id].posf[0], tet_vertices[v1_id].posf[1], tet_vertices[v1_id].posf[2]);
+                GEO::vec3 p1(vertex_store.ptr(v1_id)[0], vertex_store.ptr(v1_id)[1], vertex_store.ptr(v1_id)[2]);
                 GEO::vec3 p2(old_pf[0], old_pf[1], old_pf[2]);
                 int n = GEO::distance(p1, p2) / state.sampling_dist + 1;
                 b_points.reserve(b_points.size() + n + 1);
@@ -1185,7 +1343,7 @@ bool LocalOperations::isBoundarySlide(int v1_id, int v2_id, Point_3f& old_pf){
                     b_points.push_back(p1 * ((double) k / (double) n) + p2 * ((double) (n - k) / (double) n));
                 b_points.push_back(p2);
             } else {
-                Triangle_3f tri(tet_vertices[v_id].posf, tet_vertices[v2_id].posf, old_pf);
+                Triangle_3f tri(vertex_store.posf(v_id), vertex_store.posf(v2_id), old_pf);
                 std::array<GEO::vec3, 3> vs = {{GEO::vec3(tri[0][0], tri[0][1], tri[0][2]),
                                                 GEO::vec3(tri[1][0], tri[1][1], tri[1][2]),
                                                 GEO::vec3(tri[2][0], tri[2][1], tri[2][2])}};
@@ -1200,40 +1358,9 @@ bool LocalOperations::isBoundarySlide(int v1_id, int v2_id, Point_3f& old_pf){
         }
     }
 #if TIMING_BREAKDOWN
-    breakdown_timing0[id_sampling] += igl_timer0.getElapsedTime();
-#endif
-    if(b_points.size()==0)
-        return false;
-
-#if TIMING_BREAKDOWN
-    igl_timer0.start();
-#endif
-    GEO::vec3 current_point = b_points[0];
-    GEO::vec3 nearest_point;
-    double sq_dist;
-    GEO::index_t prev_facet = geo_b_tree.nearest_facet(current_point, nearest_point, sq_dist);
-    int cnt = 0;
-    const unsigned int b_points_size = b_points.size();
-    for (unsigned int i = b_points_size / 2; ; i = (i + 1) % b_points_size) {
-        GEO::vec3 &current_point = b_points[i];
-        sq_dist = current_point.distance2(nearest_point);
-        geo_b_tree.nearest_facet_with_hint(current_point, prev_facet, nearest_point, sq_dist);
-        double dis = current_point.distance2(nearest_point);
-        if (dis > state.eps_2) {
-#if TIMING_BREAKDOWN
-            breakdown_timing0[id_aabb] += igl_timer0.getElapsedTime();
-#endif
-            return true;
-        }
-        cnt++;
-        if (cnt >= b_points.size())
-            break;
-    }
-#if TIMING_BREAKDOWN
-    breakdown_timing0[id_aabb] += igl_timer0.getElapsedTime();
+    envelope_query.breakdown_timing[EnvelopeQuery::ID_SAMPLING] += envelope_query.timer.getElapsedTime();
 #endif
-
-    return false;
+    return envelope.isBoundaryPointsOut(state.eps_2, envelope_query);
 #else
     return false;
 #endif
@@ -1249,30 +1376,120 @@ bool LocalOperations::isTetOnSurface(int t_id){
 
 bool LocalOperations::isTetRounded(int t_id){
     for(int i=0;i<4;i++){
-        if(!tet_vertices[tets[t_id][i]].is_rounded)
+        if(!vertex_store.is(tets[t_id][i], TetVertexStore::ROUNDED))
             return false;
     }
     return true;
 }
 
 void LocalOperations::getFaceConnTets(int v1_id, int v2_id, int v3_id, std::vector<int>& t_ids){
-    std::vector<int> v1, v2, v3, tmp;
-    v1.reserve(tet_vertices[v1_id].conn_tets.size());
-    for(auto it=tet_vertices[v1_id].conn_tets.begin();it!=tet_vertices[v1_id].conn_tets.end();it++)
-        v1.push_back(*it);
-    v2.reserve(tet_vertices[v2_id].conn_tets.size());
-    for(auto it=tet_vertices[v2_id].conn_tets.begin();it!=tet_vertices[v2_id].conn_tets.end();it++)
-        v2.push_back(*it);
-    v3.reserve(tet_vertices[v3_id].conn_tets.size());
-    for(auto it=tet_vertices[v3_id].conn_tets.begin();it!=tet_vertices[v3_id].conn_tets.end();it++)
-        v3.push_back(*it);
-
-    std::sort(v1.begin(), v1.end());
-    std::sort(v2.begin(), v2.end());
-    std::sort(v3.begin(), v3.end());
-
-    std::set_intersection(v1.begin(), v1.end(), v2.begin(), v2.end(), std::back_inserter(tmp));
-    std::set_intersection(v3.begin(), v3.end(), tmp.begin(), tmp.end(), std::back_inserter(t_ids));
+    ///a tet containing the face, and its neighbour across it
+    int v_id = v1_id;
+    if (tet_vertices[v2_id].conn_tets.size() < tet_vertices[v_id].conn_tets.size())
+        v_id = v2_id;
+    if (tet_vertices[v3_id].conn_tets.size() < tet_vertices[v_id].conn_tets.size())
+        v_id = v3_id;
+
+    for (int t_id:tet_vertices[v_id].conn_tets) {
+        const std::array<int, 4>& t = tets[t_id];
+        int j = -1;
+        int cnt = 0;
+        for (int k = 0; k < 4; k++) {
+            if (t[k] == v1_id || t[k] == v2_id || t[k] == v3_id)
+                cnt++;
+            else
+                j = k;
+        }
+        if (cnt != 3)
+            continue;
+        t_ids.push_back(t_id);
+        if (opp_tets[t_id][j] >= 0)
+            t_ids.push_back(opp_tets[t_id][j]);
+        std::sort(t_ids.begin(), t_ids.end());
+        return;
+    }
+}
+
+void LocalOperations::getEdgeConnTets(int v1_id, int v2_id, std::vector<int>& t_ids) {
+    ///walk around the edge through the face adjacency, instead of intersecting the two one-rings
+    t_ids.clear();
+    const ConnTets& conn_tets = tet_vertices[v1_id].conn_tets.size() <= tet_vertices[v2_id].conn_tets.size() ?
+                                tet_vertices[v1_id].conn_tets : tet_vertices[v2_id].conn_tets;
+    auto is_edge_tet = [&](int t_id) {
+        const std::array<int, 4>& t = tets[t_id];
+        return std::find(t.begin(), t.end(), v1_id) != t.end() && std::find(t.begin(), t.end(), v2_id) != t.end();
+    };
+
+    int seed_t_id = -1;
+    for (int t_id:conn_tets) {
+        if (is_edge_tet(t_id)) {
+            seed_t_id = t_id;
+            break;
+        }
+    }
+    if (seed_t_id < 0)
+        return;
+
+    std::array<int, 2> js;
+    int cnt = 0;
+    for (int j = 0; j < 4; j++) {
+        if (tets[seed_t_id][j] != v1_id && tets[seed_t_id][j] != v2_id)
+            js[cnt++] = j;
+    }
+
+    t_ids.push_back(seed_t_id);
+    bool is_closed = false;
+    for (int k = 0; k < 2; k++) {
+        int prev_t_id = seed_t_id;
+        int t_id = opp_tets[seed_t_id][js[k]];
+        while (t_id >= 0 && t_id != seed_t_id) {
+            if (t_ids.size() >= conn_tets.size() || t_is_removed[t_id] || !is_edge_tet(t_id)) {//should not happen
+                setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, t_ids);
+                return;
+            }
+            t_ids.push_back(t_id);
+
+            int next_t_id = -1;
+            bool is_from_prev = false;
+            for (int j = 0; j < 4; j++) {
+                if (tets[t_id][j] == v1_id || tets[t_id][j] == v2_id)
+                    continue;
+                if (opp_tets[t_id][j] == prev_t_id && !is_from_prev)
+                    is_from_prev = true;
+                else
+                    next_t_id = opp_tets[t_id][j];
+            }
+            if (!is_from_prev) {
+                setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, t_ids);
+                return;
+            }
+            prev_t_id = t_id;
+            t_id = next_t_id;
+        }
+        if (t_id == seed_t_id) {//the edge is inside the mesh, the ring is closed
+            is_closed = true;
+            break;
+        }
+    }
+
+    //an open ring is only expected for an edge on the hull, a missed update of opp_tets would silently drop tets
+#ifndef NDEBUG
+    const bool is_checked = true;
+#else
+    const bool is_checked = !is_closed;
+#endif
+    if (is_checked) {
+        int n = 0;
+        for (int t_id:conn_tets) {
+            if (is_edge_tet(t_id))
+                n++;
+        }
+        if (n != t_ids.size()) {//should not happen
+            setIntersection(tet_vertices[v1_id].conn_tets, tet_vertices[v2_id].conn_tets, t_ids);
+            return;
+        }
+    }
+    std::sort(t_ids.begin(), t_ids.end());
 }
 
 bool LocalOperations::isIsolated(int v_id) {
@@ -1289,12 +1506,14 @@ bool LocalOperations::isIsolated(int v_id) {
 bool LocalOperations::isBoundaryPoint(int v_id) {
     if(state.is_mesh_closed)
         return false;
-    std::unordered_set<int> n_v_ids;
+    std::vector<int>& n_v_ids = scratch.n_v_ids.get();
     for (int t_id:tet_vertices[v_id].conn_tets) {
         for (int j = 0; j < 4; j++)
-            if (tets[t_id][j] != v_id && tet_vertices[tets[t_id][j]].is_on_boundary)
-                n_v_ids.insert(tets[t_id][j]);
+            if (tets[t_id][j] != v_id && vertex_store.is(tets[t_id][j], TetVertexStore::ON_BOUNDARY))
+                n_v_ids.push_back(tets[t_id][j]);
     }
+    std::sort(n_v_ids.begin(), n_v_ids.end());
+    n_v_ids.erase(std::unique(n_v_ids.begin(), n_v_ids.end()), n_v_ids.end());
     for (int n_v_id:n_v_ids) {
         if (isEdgeOnBoundary(n_v_id, v_id))
             return true;
@@ -1307,7 +1526,7 @@ void LocalOperations::checkUnrounded() {
     for (unsigned int i = 0; i < tet_vertices.size(); i++) {
         if (v_is_removed[i])
             continue;
-        if (!tet_vertices[i].is_rounded) {
+        if (!vertex_store.is(i, TetVertexStore::ROUNDED)) {
             is_output = true;
             break;
         }
@@ -1325,14 +1544,14 @@ void LocalOperations::checkUnrounded() {
     for (unsigned int i = 0; i < tet_vertices.size(); i++) {
         if (v_is_removed[i])
             continue;
-        if (tet_vertices[i].is_rounded)
+        if (vertex_store.is(i, TetVertexStore::ROUNDED))
             continue;
 
         cnt_all++;
 
-        if (tet_vertices[i].is_on_boundary)
+        if (vertex_store.is(i, TetVertexStore::ON_BOUNDARY))
             cnt_b++;
-        if (tet_vertices[i].is_on_surface) {
+        if (vertex_store.is(i, TetVertexStore::ON_SURFACE)) {
             cnt_sf++;
             continue;
         }
@@ -1354,7 +1573,7 @@ void LocalOperations::checkUnrounded() {
         if (is_found)
             continue;
 
-        GEO::vec3 geo_p(tet_vertices[i].posf[0], tet_vertices[i].posf[1], tet_vertices[i].posf[2]);
+        GEO::vec3 geo_p(vertex_store.ptr(i)[0], vertex_store.ptr(i)[1], vertex_store.ptr(i)[2]);
         double dis = sqrt(geo_sf_tree.squared_distance(geo_p));
         diss.push_back(dis);
     }
@@ -1371,14 +1590,14 @@ void LocalOperations::checkUnrounded() {
 }
 
 bool LocalOperations::isLocked_ui(const std::array<int, 2>& e){
-    return (tet_vertices[e[0]].is_locked || tet_vertices[e[1]].is_locked);
+    return (vertex_store.is(e[0], TetVertexStore::LOCKED) || vertex_store.is(e[1], TetVertexStore::LOCKED));
 }
 
 bool LocalOperations::isTetLocked_ui(int tid){
 //    return false;
 
     for(int j=0;j<4;j++)
-        if(tet_vertices[tets[tid][j]].is_locked)
+        if(vertex_store.is(tets[tid][j], TetVertexStore::LOCKED))
             return true;
     return false;
 }
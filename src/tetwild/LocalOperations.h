@@ -13,7 +13,14 @@
 #define NEW_GTET_LOCALOPERATIONS_H
 
 #include <tetwild/ForwardDecls.h>
+#include <tetwild/AMIPSEnergy.h>
 #include <tetwild/TetmeshElements.h>
+#include <tetwild/TetVertexStore.h>
+#include <tetwild/SlotAllocator.h>
+#include <tetwild/EnergyStats.h>
+#include <tetwild/ScratchVector.h>
+#include <tetwild/SurfaceIndex.h>
+#include <tetwild/Envelope.h>
 #include <tetwild/geogram/mesh_AABB.h>
 #include <igl/grad.h>
 #include <igl/Timer.h>
@@ -36,38 +43,120 @@ public:
     State & state;
 
     std::vector<TetVertex>& tet_vertices;
+    TetVertexStore& vertex_store;
     std::vector<std::array<int, 4>>& tets;
     std::vector<std::array<int, 4>>& is_surface_fs;
+    std::vector<std::array<int, 4>>& opp_tets;//opp_tets[t_id][j] shares the face opposite to tets[t_id][j], -1 if none
     std::vector<bool>& v_is_removed;
     std::vector<bool>& t_is_removed;
+    SlotAllocator& v_slots;
+    SlotAllocator& t_slots;
     std::vector<TetQuality>& tet_qualities;
+    EnergyStats& energy_stats;
+    SurfaceIndex& surface_index;
 
     int energy_type;
 
+    const Envelope& envelope;//read-only, may be shared by operators running concurrently
+    EnvelopeQuery envelope_query;//hints, buffers, cache and statistics of the envelope queries of this operator
     const GEO::Mesh &geo_sf_mesh;
     const GEO::MeshFacetsAABBWithEps& geo_sf_tree;
-    const GEO::MeshFacetsAABBWithEps& geo_b_tree;
+    const SegmentAABB& geo_b_tree;//open boundary of geo_sf_mesh, empty if it is closed
 
     int counter=0;
     int suc_counter=0;
+    //tet energies computed/reused by calTetQualities(t_ids) in this pass of the operator
+    int n_energies_computed=0;
+    int n_energies_reused=0;
+    //quality checks decided by screenTetQualities() in this pass of the operator
+    int n_screened=0;
+    int n_screen_accepted=0;
+    int n_screen_rejected=0;
+
+    ///temporaries of the local operations, reused from one attempt to the next
+    ///each operator owns its copy, and a buffer is never used by two nested calls at once
+    ///the buffers of the envelope queries are kept by EnvelopeQuery instead
+    struct Scratch {
+        ScratchVector<int> t_ids;
+        ScratchVector<int> edge_t_ids;
+        ScratchVector<int> old_t_ids;
+        ScratchVector<int> new_t_ids;
+        ScratchVector<int> changed_t_ids;
+        ScratchVector<int> n12_t_ids;
+        ScratchVector<int> n12_v_ids;
+        ScratchVector<int> n1_v_ids;
+        ScratchVector<int> tags;
+        ScratchVector<int> tmp_tags;
+        ScratchVector<int> is_sf_fs;
+        ScratchVector<bool> is_removed;
+        ScratchVector<std::array<int, 4>> new_tets;
+        ScratchVector<std::array<int, 4>> tmp_new_tets;
+        ScratchVector<TetQuality> tet_qs;
+        ScratchVector<TetQuality> tmp_tet_qs;
+        ScratchVector<int> dirty_t_ids;
+        ScratchVector<std::array<int, 4>> dirty_tets;
+        ScratchVector<TetQuality> dirty_tet_qs;
+        ScratchVector<std::array<int, 2>> es;
+        ScratchVector<std::array<int, 2>> update_sf_t_ids;
+        ScratchVector<std::array<int, 3>> fs;
+        ScratchVector<std::array<int, 3>> tri_ids;
+        ScratchVector<std::array<int, 5>> opp_fs;
+        ScratchVector<Triangle_3f> tris;
+        ScratchVector<Triangle_3> exact_tris;
+        ScratchVector<int> bbox_t_ids;//of isEdgeOnBbox()
+        ScratchVector<int> n_v_ids;//of isEdgeOnBbox() and isBoundaryPoint()
+
+        ///get() calls that found a buffer grown since its previous get(), see ScratchVector
+        int growthCount() const;
+    } scratch;
 
     std::array<double, 6> cmp_d_angles = {{6/180.0*M_PI, 12/180.0*M_PI, 18/180.0*M_PI, 162/180.0*M_PI, 168/180.0*M_PI, 174/180.0*M_PI}};
 
-    LocalOperations(std::vector<TetVertex>& t_vs, std::vector<std::array<int, 4>>& ts, std::vector<std::array<int, 4>>& is_sf_fs,
-                    std::vector<bool>& v_is_rm, std::vector<bool>& t_is_rm, std::vector<TetQuality>& tet_qs,
-                    int e_type, const GEO::Mesh &geo_mesh, const GEO::MeshFacetsAABBWithEps& geo_tree, const GEO::MeshFacetsAABBWithEps& b_t,
-                    const Args &ar, State &st) :
-        tet_vertices(t_vs), tets(ts), is_surface_fs(is_sf_fs), v_is_removed(v_is_rm), t_is_removed(t_is_rm),
-        tet_qualities(tet_qs), energy_type(e_type),
-        geo_sf_mesh(geo_mesh), geo_sf_tree(geo_tree), geo_b_tree(b_t),
+    LocalOperations(std::vector<TetVertex>& t_vs, TetVertexStore& v_store, std::vector<std::array<int, 4>>& ts, std::vector<std::array<int, 4>>& is_sf_fs,
+                    std::vector<std::array<int, 4>>& opp_ts, std::vector<bool>& v_is_rm, std::vector<bool>& t_is_rm, SlotAllocator& v_sl, SlotAllocator& t_sl,
+                    std::vector<TetQuality>& tet_qs, EnergyStats& e_stats, SurfaceIndex& sf_index,
+                    int e_type, const Envelope& env, const Args &ar, State &st) :
+        tet_vertices(t_vs), vertex_store(v_store), tets(ts), is_surface_fs(is_sf_fs), opp_tets(opp_ts), v_is_removed(v_is_rm), t_is_removed(t_is_rm),
+        v_slots(v_sl), t_slots(t_sl), tet_qualities(tet_qs), energy_stats(e_stats), surface_index(sf_index), energy_type(e_type),
+        envelope(env), geo_sf_mesh(env.sf_mesh), geo_sf_tree(env.sf_tree), geo_b_tree(env.b_tree),
         args(ar), state(st)
     { }
 
     void check();
+
+    ///the slots of the removed elements are reused by the new ones
+    int getNewVertexSlot();
+    void getNewTetSlots(int n, std::vector<int>& new_t_ids);
+    void removeVertex(int v_id);
+    void removeTet(int t_id);
+
+    ///face adjacency, updated on the tets changed by an operation
+    void buildOppTets();
+    void updateOppTets(const std::vector<int>& t_ids);
+    int findOppTet(int t_id, int j);
+    int getOppIndex(int t_id, int opp_t_id, int j);
     void outputInfo(int op_type, double time, bool is_log = true);
 
+    ///write-through updates of tet_qualities and energy_stats
+    void setTetQuality(int t_id, const TetQuality& tq);
+    void buildEnergyStats();
+
+    ///surface_index is updated around the changes of tets and is_surface_fs made by an operation
+    void unindexSurfaceTets(const std::vector<int>& t_ids);
+    void indexSurfaceTets(const std::vector<int>& t_ids);
+    void buildSurfaceIndex();
+
     void calTetQualities(const std::vector<std::array<int, 4>>& new_tets, std::vector<TetQuality>& tet_qs, bool all_measure = false);
+    ///updates the qualities of the live tets t_ids, skipping the ones whose energy is still up to date,
+    ///all of them are recomputed with args.validate_energy_cache
     void calTetQualities(const std::vector<int>& t_ids, bool all_measure = false);
+    ///marks the energy of the tet as out of date, when its vertices are replaced without computing it
+    void invalidateTetQuality(int t_id) { tet_qualities[t_id].energy_version = 0; }
+
+    enum ScreenResult { SCREEN_REJECT, SCREEN_ACCEPT, SCREEN_UNSURE };
+    ///whether the max energy of new_tets is surely below or above old_energy, from float bounds of the energies
+    ///when args.use_energy_screening, SCREEN_UNSURE if the energies in double are needed to compare them
+    int screenTetQualities(const std::vector<std::array<int, 4>>& new_tets, double old_energy);
 
     double calEdgeLength(const std::array<int, 2>& v_ids);
     double calEdgeLength(int v1_id, int v2_id, bool is_over_refine=false);
@@ -95,14 +184,18 @@ public:
 
 //    EnvelopSide getUpperLowerBounds(const Triangle_3f& tri);
     bool isFaceOutEnvelop(const Triangle_3f& tri);
+    ///true if one of the faces is out, they are tested together with a shared early exit
+    bool isFacesOutEnvelop(const std::vector<Triangle_3f>& tris);
     bool isPointOutEnvelop(const Point_3f& p);
     bool isFaceOutEnvelop_sampling(const Triangle_3f& tri);
+    bool isFaceOutEnvelop_exact(const Triangle_3f& tri);
     bool isPointOutBoundaryEnvelop(const Point_3f& p);
     bool isBoundarySlide(int v1_id, int v2_id, Point_3f& pf);
 
     bool isTetOnSurface(int t_id);
     bool isTetRounded(int t_id);
     void getFaceConnTets(int v1_id, int v2_id, int v3_id, std::vector<int>& t_ids);
+    void getEdgeConnTets(int v1_id, int v2_id, std::vector<int>& t_ids);
     bool isIsolated(int v_id);
     bool isBoundaryPoint(int v_id);
 
@@ -110,12 +203,6 @@ public:
     static void comformalAMIPSJacobian_new(const double * T, double *result_0);
     static void comformalAMIPSHessian_new(const double * T, double *result_0);
 
-    igl::Timer igl_timer0;
-    int id_sampling=0;
-    int id_aabb=1;
-    std::array<double, 2> breakdown_timing0;
-    std::array<std::string, 2> breakdown_name0={{"Envelop_sampling", "Envelop_AABBtree"}};
-
     void checkUnrounded();
     int mid_id=0;
     void outputSurfaceColormap(const Eigen::MatrixXd& V_in, const Eigen::MatrixXi& F_in, double old_eps);
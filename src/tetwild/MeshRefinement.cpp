@@ -25,6 +25,7 @@
 #include <pymesh/MshLoader.h>
 #include <pymesh/MshSaver.h>
 #include <geogram/mesh/mesh_AABB.h>
+#include <geogram/mesh/mesh_reorder.h>
 #include <geogram/points/kd_tree.h>
 #include <igl/winding_number.h>
 
@@ -36,9 +37,9 @@ namespace tetwild {
             t_is_removed = std::vector<bool>(tets.size(), false);//have to
             v_is_removed = std::vector<bool>(tet_vertices.size(), false);
             for (int i = 0; i < tet_vertices.size(); i++) {
-                if (tet_vertices[i].is_rounded)
+                if (vertex_store.is(i, TetVertexStore::ROUNDED))
                     continue;
-                tet_vertices[i].round();
+                vertex_store.round(i);
             }
             round();
         }
@@ -46,9 +47,24 @@ namespace tetwild {
         GEO::Mesh simple_mesh;
         getSimpleMesh(simple_mesh);
         GEO::MeshFacetsAABBWithEps simple_tree(simple_mesh);
-        LocalOperations localOperation(tet_vertices, tets, is_surface_fs, v_is_removed, t_is_removed, tet_qualities,
-            state.ENERGY_AMIPS, simple_mesh, simple_tree, simple_tree, args, state);
-        localOperation.calTetQualities(tets, tet_qualities, true);//cal all measure
+        EnvelopeGrid no_grid;//envelope_grid is over geo_sf_mesh, not simple_mesh
+        SegmentAABB no_b_tree;
+        Envelope simple_envelope(simple_mesh, simple_tree, no_b_tree, no_grid);
+        v_slots.build(v_is_removed);
+        t_slots.build(t_is_removed);
+        LocalOperations localOperation(tet_vertices, vertex_store, tets, is_surface_fs, opp_tets, v_is_removed, t_is_removed,
+            v_slots, t_slots, tet_qualities, energy_stats, surface_index,
+            state.ENERGY_AMIPS, simple_envelope, args, state);
+        tet_qualities.resize(tets.size());
+        std::vector<int> t_ids;//once per stage, not worth a scratch buffer
+        t_ids.reserve(tets.size());
+        for (int i = 0; i < tets.size(); i++) {
+            if (!t_is_removed[i])
+                t_ids.push_back(i);
+        }
+        localOperation.calTetQualities(t_ids, true);//cal all measure, the tets kept from a previous call are skipped
+        energy_stats.invalidate();
+        surface_index.invalidate();
         double tmp_time = igl_timer.getElapsedTime();
         ProgressHandler::Debug("{}s", tmp_time);
         localOperation.outputInfo(MeshRecord::OpType::OP_OPT_INIT, tmp_time);
@@ -58,36 +74,24 @@ namespace tetwild {
         int cnt = 0;
         int sub_cnt = 0;
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i])
-                continue;
-            if (tet_vertices[i].is_rounded)
+            if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::ROUNDED)) {
+                vertex_store.releasePos(i);//may be left by a reverted operation
                 continue;
-            tet_vertices[i].is_rounded = true;
-            Point_3 old_p = tet_vertices[i].pos;
-            tet_vertices[i].pos = Point_3(tet_vertices[i].posf[0], tet_vertices[i].posf[1], tet_vertices[i].posf[2]);
+            }
+            vertex_store.set(i, TetVertexStore::ROUNDED, true);
+            TetVertexStore::SavedPos old_p = vertex_store.savePos(i);
+            vertex_store.releasePos(i);
 
             for (auto it = tet_vertices[i].conn_tets.begin(); it != tet_vertices[i].conn_tets.end(); it++) {
-                CGAL::Orientation ori;
-                //            bool is_rounded = true;
-                //            for (int j = 0; j < 4; j++)
-                //                if (!tet_vertices[tets[*it][j]].is_rounded) {
-                //                    is_rounded = false;
-                //                    break;
-                //                }
-                //            if (is_rounded)
-                //                ori = CGAL::orientation(tet_vertices[tets[*it][0]].posf, tet_vertices[tets[*it][1]].posf,
-                //                                        tet_vertices[tets[*it][2]].posf, tet_vertices[tets[*it][3]].posf);
-                //            else
-                ori = CGAL::orientation(tet_vertices[tets[*it][0]].pos, tet_vertices[tets[*it][1]].pos,
-                    tet_vertices[tets[*it][2]].pos, tet_vertices[tets[*it][3]].pos);
+                CGAL::Orientation ori = tetOrientation(vertex_store, tets[*it]);
 
                 if (ori != CGAL::POSITIVE) {
-                    tet_vertices[i].is_rounded = false;
+                    vertex_store.set(i, TetVertexStore::ROUNDED, false);
                     break;
                 }
             }
-            if (!tet_vertices[i].is_rounded)
-                tet_vertices[i].pos = old_p;
+            if (!vertex_store.is(i, TetVertexStore::ROUNDED))
+                vertex_store.restorePos(i, old_p);
             else {
                 cnt++;
                 sub_cnt++;
@@ -115,13 +119,23 @@ namespace tetwild {
         v_is_removed.clear();
         is_surface_fs.clear();
         tet_qualities.clear();
+        energy_stats.clear();
+        opp_tets.clear();
+        surface_index.clear();
+        vertex_store.clear();
+        v_slots.clear();
+        t_slots.clear();
     }
 
     int MeshRefinement::doOperations(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover,
         VertexSmoother& smoother, const std::array<bool, 4>& ops) {
+        //energy_stats is kept: the operations update it tet by tet, and the changes of the locks invalidate it
+        v_slots.build(v_is_removed);
+        t_slots.build(t_is_removed);
+
         int cnt0 = 0;
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i] || tet_vertices[i].is_locked || tet_vertices[i].is_rounded)
+            if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::LOCKED) || vertex_store.is(i, TetVertexStore::ROUNDED))
                 continue;
             cnt0++;
         }
@@ -175,13 +189,143 @@ namespace tetwild {
 
         int cnt1 = 0;
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i] || tet_vertices[i].is_locked || tet_vertices[i].is_rounded)
+            if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::LOCKED) || vertex_store.is(i, TetVertexStore::ROUNDED))
                 continue;
             cnt1++;
         }
         return cnt0 - cnt1;
     }
 
+    template<typename Queue>
+    void remapEdgeQueue(Queue& queue, const std::vector<int>& v_map) {
+        Queue tmp_queue;
+        while (!queue.empty()) {
+            auto ele = queue.top();
+            queue.pop();
+            if (v_map[ele.v_ids[0]] < 0 || v_map[ele.v_ids[1]] < 0)
+                continue;
+            ele.v_ids = {{v_map[ele.v_ids[0]], v_map[ele.v_ids[1]]}};
+            tmp_queue.push(ele);
+        }
+        std::swap(queue, tmp_queue);
+    }
+
+    double MeshRefinement::getFragmentation() {
+        if (t_slots.size() == 0)
+            return 0;
+        return (t_slots.freeCount() + t_slots.allocCount()) / (double) t_slots.size();
+    }
+
+    void MeshRefinement::reorder(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover) {
+        igl::Timer tmp_timer;
+        tmp_timer.start();
+
+        //vertices
+        std::vector<int> old_v_ids;
+        std::vector<double> ps;
+        old_v_ids.reserve(v_slots.liveCount());
+        ps.reserve(v_slots.liveCount() * 3);
+        for (int i = 0; i < tet_vertices.size(); i++) {
+            if (v_is_removed[i])
+                continue;
+            old_v_ids.push_back(i);
+            for (int j = 0; j < 3; j++)
+                ps.push_back(vertex_store.ptr(i)[j]);
+        }
+        GEO::vector<GEO::index_t> order;
+        GEO::compute_Hilbert_order(old_v_ids.size(), ps.data(), order);
+
+        std::vector<int> v_map(tet_vertices.size(), -1);
+        std::vector<TetVertex> new_tet_vertices;
+        new_tet_vertices.reserve(old_v_ids.size());
+        std::vector<int> new_to_old_v_ids;
+        new_to_old_v_ids.reserve(old_v_ids.size());
+        for (int i = 0; i < order.size(); i++) {
+            v_map[old_v_ids[order[i]]] = i;
+            new_tet_vertices.push_back(std::move(tet_vertices[old_v_ids[order[i]]]));
+            new_to_old_v_ids.push_back(old_v_ids[order[i]]);
+        }
+        vertex_store.permute(new_to_old_v_ids);//the vertices keep their versions, so that the energies of the tets stay up to date
+
+        //tets, ordered by their centroids
+        std::vector<int> old_t_ids;
+        old_t_ids.reserve(t_slots.liveCount());
+        ps.clear();
+        ps.reserve(t_slots.liveCount() * 3);
+        for (int i = 0; i < tets.size(); i++) {
+            if (t_is_removed[i])
+                continue;
+            old_t_ids.push_back(i);
+            for (int j = 0; j < 3; j++) {
+                double c = 0;
+                for (int k = 0; k < 4; k++)
+                    c += vertex_store.ptr(v_map[tets[i][k]])[j];
+                ps.push_back(c / 4);
+            }
+        }
+        GEO::compute_Hilbert_order(old_t_ids.size(), ps.data(), order);
+
+        std::vector<int> t_map(tets.size(), -1);
+        for (int i = 0; i < order.size(); i++)
+            t_map[old_t_ids[order[i]]] = i;
+        std::vector<std::array<int, 4>> new_tets(order.size());
+        std::vector<std::array<int, 4>> new_is_surface_fs(order.size());
+        std::vector<std::array<int, 4>> new_opp_tets(order.size());
+        std::vector<TetQuality> new_tet_qualities(order.size());
+        for (int i = 0; i < order.size(); i++) {
+            int t_id = old_t_ids[order[i]];
+            for (int j = 0; j < 4; j++) {
+                new_tets[i][j] = v_map[tets[t_id][j]];
+                new_opp_tets[i][j] = opp_tets[t_id][j] >= 0 ? t_map[opp_tets[t_id][j]] : -1;
+            }
+            new_is_surface_fs[i] = is_surface_fs[t_id];
+            new_tet_qualities[i] = tet_qualities[t_id];
+        }
+
+        std::vector<int> t_ids;
+        for (auto& v: new_tet_vertices) {
+            t_ids.clear();
+            for (int t_id: v.conn_tets)
+                t_ids.push_back(t_map[t_id]);
+            std::sort(t_ids.begin(), t_ids.end());
+            v.conn_tets.clear();
+            v.conn_tets.insert(t_ids.begin(), t_ids.end());
+        }
+
+        tet_vertices.swap(new_tet_vertices);
+        tets.swap(new_tets);
+        is_surface_fs.swap(new_is_surface_fs);
+        opp_tets.swap(new_opp_tets);
+        tet_qualities.swap(new_tet_qualities);
+        v_is_removed.assign(tet_vertices.size(), false);
+        t_is_removed.assign(tets.size(), false);
+        energy_stats.invalidate();
+        surface_index.invalidate();
+        v_slots.build(v_is_removed);
+        t_slots.build(t_is_removed);
+        v_slots.resetAllocCount();
+        t_slots.resetAllocCount();
+
+        //the edges kept by the operations between two passes
+        remapEdgeQueue(splitter.es_queue, v_map);
+        remapEdgeQueue(collapser.ec_queue, v_map);
+        remapEdgeQueue(edge_remover.er_queue, v_map);
+        std::vector<std::array<int, 2>> inf_es;
+        std::vector<int> inf_e_tss;
+        for (int i = 0; i < collapser.inf_es.size(); i++) {
+            const std::array<int, 2>& e = collapser.inf_es[i];
+            if (v_map[e[0]] < 0 || v_map[e[1]] < 0)
+                continue;
+            inf_es.push_back(std::array<int, 2>({{v_map[e[0]], v_map[e[1]]}}));
+            inf_e_tss.push_back(collapser.inf_e_tss[i]);
+        }
+        collapser.inf_es.swap(inf_es);
+        collapser.inf_e_tss.swap(inf_e_tss);
+
+        ProgressHandler::Debug("reordered {} vertices and {} tets, {}s", tet_vertices.size(), tets.size(),
+                               tmp_timer.getElapsedTime());
+    }
+
     int MeshRefinement::doOperationLoops(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover,
         VertexSmoother& smoother, int max_pass, const std::array<bool, 4>& ops)
     {
@@ -206,11 +350,9 @@ namespace tetwild {
     }
 
     void MeshRefinement::refine(int energy_type, const std::array<bool, 4>& ops, bool is_pre, bool is_post, int scalar_update) {
-        GEO::MeshFacetsAABBWithEps geo_sf_tree(geo_sf_mesh);
-        if (geo_b_mesh.vertices.nb() == 0) {
-            getSimpleMesh(geo_b_mesh);//for constructing aabb tree, the mesh cannot be empty
-        }
-        GEO::MeshFacetsAABBWithEps geo_b_tree(geo_b_mesh);
+        GEO::MeshFacetsAABBWithEps geo_sf_tree(geo_sf_mesh, true, args.use_wide_envelope_tree);
+        SegmentAABB geo_b_tree(geo_b_mesh);
+        Envelope envelope(geo_sf_mesh, geo_sf_tree, geo_b_tree, envelope_grid);
 
         if (is_dealing_unrounded)
             min_adaptive_scale = state.eps / state.initial_edge_len * 0.5; //min to eps/2
@@ -218,8 +360,14 @@ namespace tetwild {
             //        min_adaptive_scale = state.eps_input / state.initial_edge_len; // state.eps_input / state.initial_edge_len * 0.5 is too small
             min_adaptive_scale = (state.bbox_diag / 1000) / state.initial_edge_len; // set min_edge_length to diag / 1000 would be better
 
-        LocalOperations localOperation(tet_vertices, tets, is_surface_fs, v_is_removed, t_is_removed, tet_qualities,
-            energy_type, geo_sf_mesh, geo_sf_tree, geo_b_tree, args, state);
+        energy_stats.invalidate();
+        surface_index.invalidate();
+        v_slots.build(v_is_removed);
+        t_slots.build(t_is_removed);
+        LocalOperations localOperation(tet_vertices, vertex_store, tets, is_surface_fs, opp_tets, v_is_removed, t_is_removed,
+            v_slots, t_slots, tet_qualities, energy_stats, surface_index,
+            energy_type, envelope, args, state);
+        localOperation.buildOppTets();
         EdgeSplitter splitter(localOperation, state.initial_edge_len * (4.0 / 3.0) * state.initial_edge_len * (4.0 / 3.0));
         EdgeCollapser collapser(localOperation, state.initial_edge_len * (4.0 / 5.0) * state.initial_edge_len * (4.0 / 5.0));
         EdgeRemover edge_remover(localOperation, state.initial_edge_len * (4.0 / 3.0) * state.initial_edge_len * (4.0 / 3.0));
@@ -240,7 +388,7 @@ namespace tetwild {
         /// apply the local operations
         if (is_dealing_unrounded) {
             for (int i = 0; i < tet_vertices.size(); i++) {
-                if (v_is_removed[i] || tet_vertices[i].is_rounded)
+                if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::ROUNDED))
                     continue;
                 smoother.outputOneRing(i, "");
             }
@@ -265,6 +413,8 @@ namespace tetwild {
             ProgressHandler::Info("//////////////// Pass {} ////////////////", pass);
             if (is_dealing_unrounded)
                 collapser.is_limit_length = false;
+            if (args.reorder_thres > 0 && getFragmentation() > args.reorder_thres)
+                reorder(splitter, collapser, edge_remover);
             doOperations(splitter, collapser, edge_remover, smoother,
                 std::array<bool, 4>({ {is_split, ops[1], ops[2], ops[3]} }));
             update_cnt++;
@@ -274,7 +424,7 @@ namespace tetwild {
                 for (int i = 0; i < tet_vertices.size(); i++) {
                     if (v_is_removed[i])
                         continue;
-                    if (!tet_vertices[i].is_rounded)
+                    if (!vertex_store.is(i, TetVertexStore::ROUNDED))
                         is_finished = false;
                 }
                 if (is_finished) {
@@ -392,10 +542,10 @@ namespace tetwild {
                         f << "tet " << i << ": energy = " << tet_qualities[i].slim_energy << "; ";
                         std::array<double, 6> l;
                         for (int j = 0; j < 3; j++) {
-                            l[j * 2] = CGAL::squared_distance(tet_vertices[tets[i][0]].posf,
-                                tet_vertices[tets[i][j + 1]].posf);
-                            l[j * 2 + 1] = CGAL::squared_distance(tet_vertices[tets[i][j + 1]].posf,
-                                tet_vertices[tets[i][(j + 1) % 3 + 1]].posf);
+                            l[j * 2] = CGAL::squared_distance(vertex_store.posf(tets[i][0]),
+                                vertex_store.posf(tets[i][j + 1]));
+                            l[j * 2 + 1] = CGAL::squared_distance(vertex_store.posf(tets[i][j + 1]),
+                                vertex_store.posf(tets[i][(j + 1) % 3 + 1]));
                         }
                         auto it = std::min_element(l.begin(), l.end());
                         f << "min_el = " << std::sqrt(*it) << "; ";
@@ -409,15 +559,15 @@ namespace tetwild {
                             v1_id = (n - 1) / 2 + 1;
                             v2_id = ((n - 1) / 2 + 1) % 3 + 1;
                         }
-                        f << "v1 " << tets[i][v1_id] << " " << tet_vertices[tets[i][v1_id]].is_on_surface << " "
-                            << tet_vertices[tets[i][v1_id]].is_on_boundary << " "
-                            << localOperation.isPointOutEnvelop(tet_vertices[tets[i][v1_id]].posf) << " "
-                            << localOperation.isPointOutBoundaryEnvelop(tet_vertices[tets[i][v1_id]].posf) << "; "
-
-                            << "v2 " << tets[i][v2_id] << " " << tet_vertices[tets[i][v2_id]].is_on_surface << " "
-                            << tet_vertices[tets[i][v2_id]].is_on_boundary << " "
-                            << localOperation.isPointOutEnvelop(tet_vertices[tets[i][v2_id]].posf) << " "
-                            << localOperation.isPointOutBoundaryEnvelop(tet_vertices[tets[i][v2_id]].posf) << std::endl;
+                        f << "v1 " << tets[i][v1_id] << " " << vertex_store.is(tets[i][v1_id], TetVertexStore::ON_SURFACE) << " "
+                            << vertex_store.is(tets[i][v1_id], TetVertexStore::ON_BOUNDARY) << " "
+                            << localOperation.isPointOutEnvelop(vertex_store.posf(tets[i][v1_id])) << " "
+                            << localOperation.isPointOutBoundaryEnvelop(vertex_store.posf(tets[i][v1_id])) << "; "
+
+                            << "v2 " << tets[i][v2_id] << " " << vertex_store.is(tets[i][v2_id], TetVertexStore::ON_SURFACE) << " "
+                            << vertex_store.is(tets[i][v2_id], TetVertexStore::ON_BOUNDARY) << " "
+                            << localOperation.isPointOutEnvelop(vertex_store.posf(tets[i][v2_id])) << " "
+                            << localOperation.isPointOutBoundaryEnvelop(vertex_store.posf(tets[i][v2_id])) << std::endl;
                     }
                 }
                 if (is_print)
@@ -434,7 +584,7 @@ namespace tetwild {
                     collapser.is_soft = true;
                     collapser.soft_energy = localOperation.getMaxEnergy();
                     collapser.budget =
-                        (n - args.target_num_vertices) * std::count(v_is_removed.begin(), v_is_removed.end(), false) / n *
+                        (n - args.target_num_vertices) * v_slots.liveCount() / n *
                         1.5;
                 }
             }
@@ -482,7 +632,7 @@ namespace tetwild {
         ProgressHandler::Info("////////////////// Post-processing //////////////////");
         collapser.is_limit_length = true;
         for (int i = 0; i < tet_vertices.size(); i++) {
-            tet_vertices[i].adaptive_scale = 1;
+            vertex_store.adaptive_scale[i] = 1;
         }
 
         doOperations(splitter, collapser, edge_remover, smoother, std::array<bool, 4>{ {false, true, false, false}});
@@ -521,7 +671,8 @@ namespace tetwild {
         refine_revert(splitter, collapser, edge_remover, smoother);
 
         for (int i = 0; i < tet_vertices.size(); i++)
-            tet_vertices[i].is_locked = false;
+            vertex_store.set(i, TetVertexStore::LOCKED, false);
+        energy_stats.invalidate();
     }
 
     bool MeshRefinement::refine_unrounded(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover,
@@ -549,7 +700,8 @@ namespace tetwild {
         refine_revert(splitter, collapser, edge_remover, smoother);
 
         for (int i = 0; i < tet_vertices.size(); i++)
-            tet_vertices[i].is_locked = false;
+            vertex_store.set(i, TetVertexStore::LOCKED, false);
+        energy_stats.invalidate();
 
         return false;
     }
@@ -561,17 +713,17 @@ namespace tetwild {
         collapser.is_soft = true;
 
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (!v_is_removed[i] && !tet_vertices[i].is_locked)
-                tet_vertices[i].adaptive_scale = 1;
+            if (!v_is_removed[i] && !vertex_store.is(i, TetVertexStore::LOCKED))
+                vertex_store.adaptive_scale[i] = 1;
         }
 
-        int n_v0 = std::count(v_is_removed.begin(), v_is_removed.end(), false);
+        int n_v0 = v_slots.liveCount();
         for (int pass = 0; pass < 10; pass++) {
             ProgressHandler::Info("////////////////// Local (revert) Pass {} //////////////////", pass);
             doOperations(splitter, collapser, edge_remover, smoother, std::array<bool, 4>({ {false, true, true, true} }));
             //        doOperations(splitter, collapser, edge_remover, smoother);
 
-            int n_v = std::count(v_is_removed.begin(), v_is_removed.end(), false);
+            int n_v = v_slots.liveCount();
             if (n_v0 - n_v < 1) //when number of vertices becomes stable
                 break;
             n_v0 = n_v;
@@ -604,7 +756,7 @@ namespace tetwild {
             std::vector<Point_3f> vs;
             vs.reserve(4);
             for (int j = 0; j < 4; j++)
-                vs.push_back(tet_vertices[tets[i][j]].posf);
+                vs.push_back(vertex_store.posf(tets[i][j]));
             Point_3f p = CGAL::centroid(vs.begin(), vs.end(), CGAL::Dimension_tag<0>());
             for (int j = 0; j < 3; j++)
                 C(cnt, j) = p[j];
@@ -661,7 +813,7 @@ namespace tetwild {
         for (int i = 0; i < tet_vertices.size(); i++) {
             if (v_is_removed[i])
                 continue;
-            GEO::vec3 p(tet_vertices[i].posf[0], tet_vertices[i].posf[1], tet_vertices[i].posf[2]);
+            GEO::vec3 p(vertex_store.ptr(i)[0], vertex_store.ptr(i)[1], vertex_store.ptr(i)[2]);
             int bg_t_id = bg_aabb.containing_tet(p);
             if (bg_t_id == GEO::MeshCellsAABB::NO_TET)
                 continue;
@@ -677,12 +829,12 @@ namespace tetwild {
             for (int j = 0; j < 4; j++) {
                 Plane_3f pln(vs[j], vs[(j + 1) % 4], vs[(j + 2) % 4]);
                 double weight = std::sqrt(
-                    CGAL::squared_distance(tet_vertices[i].posf, pln) / CGAL::squared_distance(vs[(j + 3) % 4], pln));
+                    CGAL::squared_distance(vertex_store.posf(i), pln) / CGAL::squared_distance(vs[(j + 3) % 4], pln));
                 weights[j] = weight;
                 value += weight * values(T_in(bg_t_id * 4 + (j + 3) % 4));
             }
 
-            tet_vertices[i].adaptive_scale = value / state.initial_edge_len; //we allow .adaptive_scale > 1
+            vertex_store.adaptive_scale[i] = value / state.initial_edge_len; //we allow .adaptive_scale > 1
         }
 
         //     for debugging
@@ -700,9 +852,13 @@ namespace tetwild {
         VertexSmoother& smoother) {
         if (args.target_num_vertices < 0)
             return;
-        if (args.target_num_vertices == 0)
+        if (args.target_num_vertices == 0) {
             for (int i = 0; i < t_is_removed.size(); i++)
                 t_is_removed[i] = true;
+            t_slots.build(t_is_removed);
+            energy_stats.invalidate();
+            surface_index.invalidate();
+        }
 
         double N = args.target_num_vertices; //targeted #v
 
@@ -711,18 +867,19 @@ namespace tetwild {
         markInOut(tmp_t_is_removed);
 
         for (int i = 0; i < tet_vertices.size(); i++)
-            tet_vertices[i].is_locked = true;
+            vertex_store.set(i, TetVertexStore::LOCKED, true);
 
         for (int i = 0; i < tets.size(); i++) {
             if (tmp_t_is_removed[i])
                 continue;
             for (int j = 0; j < 4; j++)
-                tet_vertices[tets[i][j]].is_locked = false;
+                vertex_store.set(tets[i][j], TetVertexStore::LOCKED, false);
         }
+        energy_stats.invalidate();
 
         int cnt = 0;
         for (int i = 0; i < tet_vertices.size(); i++)
-            if (!v_is_removed[i] && !tet_vertices[i].is_locked)
+            if (!v_is_removed[i] && !vertex_store.is(i, TetVertexStore::LOCKED))
                 cnt++;
 
         const double size_threshold = 0.05;
@@ -734,7 +891,7 @@ namespace tetwild {
         if (cnt > N) {//reduce vertices
             double max_energy = splitter.getMaxEnergy();
             for (int i = 0; i < tet_vertices.size(); i++)
-                tet_vertices[i].adaptive_scale = 10;
+                vertex_store.adaptive_scale[i] = 10;
 
             collapser.is_soft = true;
             collapser.soft_energy = max_energy;
@@ -754,7 +911,7 @@ namespace tetwild {
         }
         else {//increase vertices
             for (int i = 0; i < tet_vertices.size(); i++)
-                tet_vertices[i].adaptive_scale = 0;
+                vertex_store.adaptive_scale[i] = 0;
 
             splitter.budget = N - cnt;
             while (splitter.budget / N >= size_threshold) {
@@ -767,9 +924,9 @@ namespace tetwild {
 
     bool MeshRefinement::isRegionFullyRounded() {
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i] || tet_vertices[i].is_locked)
+            if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::LOCKED))
                 continue;
-            if (!tet_vertices[i].is_rounded)
+            if (!vertex_store.is(i, TetVertexStore::ROUNDED))
                 return false;
         }
         return true;
@@ -807,11 +964,11 @@ namespace tetwild {
         const int N = -int(std::log2(min_adaptive_scale) - 1);
         std::vector<std::vector<int>> v_ids(N, std::vector<int>());
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i] || tet_vertices[i].is_locked)
+            if (v_is_removed[i] || vertex_store.is(i, TetVertexStore::LOCKED))
                 continue;
 
             if (is_clean_up_unrounded) {
-                if (tet_vertices[i].is_rounded)
+                if (vertex_store.is(i, TetVertexStore::ROUNDED))
                     continue;
             }
             else {
@@ -824,7 +981,7 @@ namespace tetwild {
                     continue;
             }
 
-            int n = -int(std::log2(tet_vertices[i].adaptive_scale) - 0.5);
+            int n = -int(std::log2(vertex_store.adaptive_scale[i]) - 0.5);
             if (n >= N)
                 n = N - 1;
             v_ids[n].push_back(i);
@@ -844,7 +1001,7 @@ namespace tetwild {
             pts.reserve(v_ids[n].size() * 3);
             for (int i = 0; i < v_ids[n].size(); i++) {
                 for (int j = 0; j < 3; j++)
-                    pts.push_back(tet_vertices[v_ids[n][i]].posf[j]);
+                    pts.push_back(vertex_store.ptr(v_ids[n][i])[j]);
 
                 v_queue.push(v_ids[n][i]);
                 is_visited.insert(v_ids[n][i]);
@@ -864,12 +1021,12 @@ namespace tetwild {
                             continue;
                         GEO::index_t _;
                         double sq_dist;
-                        const double p[3] = { tet_vertices[tets[t_id][k]].posf[0], tet_vertices[tets[t_id][k]].posf[1],
-                                             tet_vertices[tets[t_id][k]].posf[2] };
+                        const double p[3] = { vertex_store.ptr(tets[t_id][k])[0], vertex_store.ptr(tets[t_id][k])[1],
+                                             vertex_store.ptr(tets[t_id][k])[2] };
                         nnsearch->get_nearest_neighbors(1, p, &_, &sq_dist);
                         double dis = sqrt(sq_dist);
 
-                        if (dis < radius && !tet_vertices[tets[t_id][k]].is_locked) {
+                        if (dis < radius && !vertex_store.is(tets[t_id][k], TetVertexStore::LOCKED)) {
                             v_queue.push(tets[t_id][k]);
                             double new_ss =
                                 (dis / radius) * (1 - dynamic_adaptive_scale) + dynamic_adaptive_scale;
@@ -888,22 +1045,23 @@ namespace tetwild {
             if (v_is_removed[i])
                 continue;
             if (is_clean_up_unrounded && is_lock && adap_tmp[i] > 1) {
-                tet_vertices[i].is_locked = true;
+                vertex_store.set(i, TetVertexStore::LOCKED, true);
                 cnt++;
             }
-            double new_scale = tet_vertices[i].adaptive_scale * adap_tmp[i];
+            double new_scale = vertex_store.adaptive_scale[i] * adap_tmp[i];
             if (new_scale > 1)
-                tet_vertices[i].adaptive_scale = 1;
+                vertex_store.adaptive_scale[i] = 1;
             else if (new_scale < min_adaptive_scale) {
                 if (!is_clean_up_unrounded)
                     is_hit_min = true;
-                tet_vertices[i].adaptive_scale = min_adaptive_scale;
+                vertex_store.adaptive_scale[i] = min_adaptive_scale;
             }
             else
-                tet_vertices[i].adaptive_scale = new_scale;
+                vertex_store.adaptive_scale[i] = new_scale;
         }
         if (is_clean_up_unrounded && is_lock)
             ProgressHandler::Debug("{} vertices locked", cnt);
+        energy_stats.invalidate();
 
         ProgressHandler::Debug("marked!");
         tmp_time = igl_timer.getElapsedTime();
@@ -928,6 +1086,7 @@ namespace tetwild {
 
     void MeshRefinement::postProcess(VertexSmoother& smoother) {
         igl_timer.start();
+        energy_stats.invalidate();
 
         std::vector<bool> tmp_t_is_removed;
         markInOut(tmp_t_is_removed);
@@ -938,7 +1097,7 @@ namespace tetwild {
         for (int i = 0; i < tet_vertices.size(); i++) {
             if (v_is_removed[i])
                 continue;
-            if (tet_vertices[i].is_on_bbox)
+            if (vertex_store.is(i, TetVertexStore::ON_BBOX))
                 continue;
             bool has_removed = false;
             bool has_unremoved = false;
@@ -959,7 +1118,7 @@ namespace tetwild {
             tmp_is_on_surface[i] = true;
             //        if(tet_vertices[i].is_on_boundary && !tet_vertices[i].is_on_surface)
             //            pausee();
-            if (!tet_vertices[i].is_on_surface)
+            if (!vertex_store.is(i, TetVertexStore::ON_SURFACE))
                 b_v_ids.push_back(i);
         }
         ProgressHandler::Debug("tmp_is_on_surface.size = {}", tmp_is_on_surface.size());
@@ -972,6 +1131,8 @@ namespace tetwild {
         smoother.outputInfo(MeshRecord::OpType::OP_SMOOTH, igl_timer.getElapsedTime());
 
         t_is_removed = tmp_t_is_removed;
+        t_slots.build(t_is_removed);//the live count is read by extractFinalTetmesh()
+        surface_index.invalidate();
     }
 
     /////just for check
@@ -993,10 +1154,7 @@ namespace tetwild {
             if (t_is_removed[i])
                 continue;
 
-            CGAL::Orientation ori = CGAL::orientation(tet_vertices[tets[i][0]].pos,
-                tet_vertices[tets[i][1]].pos,
-                tet_vertices[tets[i][2]].pos,
-                tet_vertices[tets[i][3]].pos);
+            CGAL::Orientation ori = tetOrientation(vertex_store, tets[i]);
 
             if (ori == CGAL::COPLANAR) {
                 ProgressHandler::Debug("tet {} is degenerate!", i);
@@ -1050,7 +1208,7 @@ namespace tetwild {
             std::vector<Point_3f> vs;
             vs.reserve(4);
             for (int j = 0; j < 4; j++)
-                vs.push_back(tet_vertices[tets[i][j]].posf);
+                vs.push_back(vertex_store.posf(tets[i][j]));
             Point_3f p = CGAL::centroid(vs.begin(), vs.end(), CGAL::Dimension_tag<0>());
             for (int j = 0; j < 3; j++)
                 C(cnt, j) = p[j];
@@ -1097,7 +1255,7 @@ namespace tetwild {
         Eigen::VectorXi oT(t_cnt * 4);
         for (int i = 0; i < v_ids.size(); i++) {
             for (int j = 0; j < 3; j++)
-                oV(i * 3 + j) = tet_vertices[v_ids[i]].posf[j];
+                oV(i * 3 + j) = vertex_store.ptr(v_ids[i])[j];
         }
         //    int cnt = 0;
         cnt = 0;
@@ -1131,32 +1289,34 @@ namespace tetwild {
         Eigen::VectorXd scalar(v_ids.size());
         cnt = 0;
         for (int i = 0; i < v_ids.size(); i++) {
-            scalar(cnt) = tet_vertices[v_ids[i]].adaptive_scale;
+            scalar(cnt) = vertex_store.adaptive_scale[v_ids[i]];
             cnt++;
         }
         mSaver.save_scalar_field("scalar field", scalar);
     }
 
     void MeshRefinement::getSurface(Eigen::MatrixXd& V, Eigen::MatrixXi& F) {
+        if (!surface_index.isValid())
+            surface_index.build(tets, is_surface_fs, t_is_removed, state.NOT_SURFACE);
+        std::vector<int> tf_ids;
+        surface_index.getTetFaces(tf_ids);
+
         std::vector<std::array<int, 3>> fs;
         std::vector<int> vs;
-        for (int i = 0; i < tets.size(); i++) {
-            if (t_is_removed[i])
-                continue;
-            for (int j = 0; j < 4; j++) {
-                if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] > 0) {//outside
-                    std::array<int, 3> v_ids = { {tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]} };
-                    if (CGAL::orientation(tet_vertices[v_ids[0]].pos, tet_vertices[v_ids[1]].pos,
-                        tet_vertices[v_ids[2]].pos, tet_vertices[tets[i][j]].pos) != CGAL::POSITIVE) {
-                        int tmp = v_ids[0];
-                        v_ids[0] = v_ids[2];
-                        v_ids[2] = tmp;
-                    }
-                    for (int k = 0; k < is_surface_fs[i][j]; k++)
-                        fs.push_back(v_ids);
-                    for (int k = 0; k < 3; k++)
-                        vs.push_back(v_ids[k]);
+        for (int tf_id:tf_ids) {
+            int i = tf_id / 4, j = tf_id % 4;
+            if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] > 0) {//outside
+                std::array<int, 3> v_ids = { {tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]} };
+                if (CGAL::orientation(vertex_store.pos(v_ids[0]), vertex_store.pos(v_ids[1]),
+                    vertex_store.pos(v_ids[2]), vertex_store.pos(tets[i][j])) != CGAL::POSITIVE) {
+                    int tmp = v_ids[0];
+                    v_ids[0] = v_ids[2];
+                    v_ids[2] = tmp;
                 }
+                for (int k = 0; k < is_surface_fs[i][j]; k++)
+                    fs.push_back(v_ids);
+                for (int k = 0; k < 3; k++)
+                    vs.push_back(v_ids[k]);
             }
         }
         std::sort(vs.begin(), vs.end());
@@ -1167,7 +1327,7 @@ namespace tetwild {
         for (int i = 0; i < vs.size(); i++) {
             map_ids[vs[i]] = i;
             for (int j = 0; j < 3; j++)
-                V(i, j) = tet_vertices[vs[i]].posf[j];
+                V(i, j) = vertex_store.ptr(vs[i])[j];
         }
 
         F.resize(fs.size(), 3);
@@ -1178,26 +1338,28 @@ namespace tetwild {
     }
 
     void MeshRefinement::getTrackedSurface(Eigen::MatrixXd& V, Eigen::MatrixXi& F) {
+        if (!surface_index.isValid())
+            surface_index.build(tets, is_surface_fs, t_is_removed, state.NOT_SURFACE);
+        std::vector<int> tf_ids;
+        surface_index.getTetFaces(tf_ids);
+
         std::vector<std::array<int, 6>> fs;
         std::vector<int> vs;
-        for (int i = 0; i < tets.size(); i++) {
-            if (t_is_removed[i])
-                continue;
-            for (int j = 0; j < 4; j++) {
-                if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] >= 0) {//outside
-                    std::array<int, 3> v_ids = { {tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]} };
-                    if (CGAL::orientation(tet_vertices[v_ids[0]].pos, tet_vertices[v_ids[1]].pos,
-                        tet_vertices[v_ids[2]].pos, tet_vertices[tets[i][j]].pos) != CGAL::POSITIVE) {
-                        int tmp = v_ids[0];
-                        v_ids[0] = v_ids[2];
-                        v_ids[2] = tmp;
-                    }
-                    std::array<int, 3> v_ids1 = v_ids;
-                    std::sort(v_ids1.begin(), v_ids1.end());
-                    fs.push_back(std::array<int, 6>({ {v_ids1[0], v_ids1[1], v_ids1[2], v_ids[0], v_ids[1], v_ids[2]} }));
-                    for (int k = 0; k < 3; k++)
-                        vs.push_back(v_ids[k]);
+        for (int tf_id:tf_ids) {
+            int i = tf_id / 4, j = tf_id % 4;
+            if (is_surface_fs[i][j] != state.NOT_SURFACE && is_surface_fs[i][j] >= 0) {//outside
+                std::array<int, 3> v_ids = { {tets[i][(j + 1) % 4], tets[i][(j + 2) % 4], tets[i][(j + 3) % 4]} };
+                if (CGAL::orientation(vertex_store.pos(v_ids[0]), vertex_store.pos(v_ids[1]),
+                    vertex_store.pos(v_ids[2]), vertex_store.pos(tets[i][j])) != CGAL::POSITIVE) {
+                    int tmp = v_ids[0];
+                    v_ids[0] = v_ids[2];
+                    v_ids[2] = tmp;
                 }
+                std::array<int, 3> v_ids1 = v_ids;
+                std::sort(v_ids1.begin(), v_ids1.end());
+                fs.push_back(std::array<int, 6>({ {v_ids1[0], v_ids1[1], v_ids1[2], v_ids[0], v_ids[1], v_ids[2]} }));
+                for (int k = 0; k < 3; k++)
+                    vs.push_back(v_ids[k]);
             }
         }
         std::sort(vs.begin(), vs.end());
@@ -1208,7 +1370,7 @@ namespace tetwild {
         for (int i = 0; i < vs.size(); i++) {
             map_ids[vs[i]] = i;
             for (int j = 0; j < 3; j++)
-                V(i, j) = tet_vertices[vs[i]].posf[j];
+                V(i, j) = vertex_store.ptr(vs[i])[j];
         }
 
         F.resize(fs.size(), 3);
@@ -1335,7 +1497,8 @@ namespace tetwild {
         // igl::deserialize(state.NOT_SURFACE, "NOT_SURFACE", slz_file);
         igl::deserialize(old_pass, "old_pass", slz_file);
 
-        igl::deserialize(tet_vertices, "tet_vertices", slz_file);
+        igl::deserialize(vertex_store, "vertex_store", slz_file);
+        tet_vertices.assign(vertex_store.size(), TetVertex());
         igl::deserialize(tets, "tets", slz_file);
         igl::deserialize(is_surface_fs, "is_surface_fs", slz_file);
 
@@ -1378,18 +1541,16 @@ namespace tetwild {
         }
 
         // serialize
-        std::vector <TetVertex> slz_tet_vertices;
-        slz_tet_vertices.reserve(std::count(v_is_removed.begin(), v_is_removed.end(), false));
+        std::vector<int> slz_v_ids;
+        slz_v_ids.reserve(cnt);
         for (int i = 0; i < tet_vertices.size(); i++) {
-            if (v_is_removed[i])
-                continue;
-            slz_tet_vertices.push_back(tet_vertices[i]);
-            slz_tet_vertices.back().conn_tets.clear();
-            slz_tet_vertices.back().on_face.clear();
-            slz_tet_vertices.back().on_edge.clear();
+            if (!v_is_removed[i])
+                slz_v_ids.push_back(i);
         }
-        igl::serialize(slz_tet_vertices, "tet_vertices", slz_file);
-        slz_tet_vertices.clear();
+        TetVertexStore slz_vertex_store = vertex_store;
+        slz_vertex_store.permute(slz_v_ids);
+        igl::serialize(slz_vertex_store, "vertex_store", slz_file);
+        slz_vertex_store.clear();
 
         std::vector <std::array<int, 4>> slz_tets;
         slz_tets.reserve(std::count(t_is_removed.begin(), t_is_removed.end(), false));
@@ -14,6 +14,11 @@
 
 #include <tetwild/ForwardDecls.h>
 #include <tetwild/TetmeshElements.h>
+#include <tetwild/TetVertexStore.h>
+#include <tetwild/SlotAllocator.h>
+#include <tetwild/EnergyStats.h>
+#include <tetwild/SurfaceIndex.h>
+#include <tetwild/EnvelopeGrid.h>
 #include <geogram/mesh/mesh.h>
 #include <igl/Timer.h>
 
@@ -26,33 +31,44 @@ public:
 
     GEO::Mesh &geo_sf_mesh;
     GEO::Mesh &geo_b_mesh;
+    const EnvelopeGrid &envelope_grid;//empty unless args.use_envelope_grid
 
     //init
     std::vector<TetVertex> tet_vertices;
     std::vector<std::array<int, 4>> tets;
+    TetVertexStore vertex_store;//coordinates and tags of tet_vertices, with the same vertex ids
     //prepare data
     std::vector<bool> v_is_removed;
     std::vector<bool> t_is_removed;
+    SlotAllocator v_slots;
+    SlotAllocator t_slots;
     std::vector<TetQuality> tet_qualities;
+    EnergyStats energy_stats;//rebuilt lazily after invalidate()
     std::vector<std::array<int, 4>> is_surface_fs;
+    std::vector<std::array<int, 4>> opp_tets;//face adjacency of tets, maintained by the local operations
+    SurfaceIndex surface_index;//tracked surface faces/edges, rebuilt lazily after invalidate()
 
     igl::Timer igl_timer;
 
     int old_pass = 0;
 
-    MeshRefinement(GEO::Mesh & sf_mesh, GEO::Mesh & b_mesh, const Args &ar, State &st)
-        : geo_sf_mesh(sf_mesh), geo_b_mesh(b_mesh), args(ar), state(st)
+    MeshRefinement(GEO::Mesh & sf_mesh, GEO::Mesh & b_mesh, const EnvelopeGrid & env_grid, const Args &ar, State &st)
+        : geo_sf_mesh(sf_mesh), geo_b_mesh(b_mesh), envelope_grid(env_grid), args(ar), state(st)
     { }
 
     void prepareData(bool is_init=true);
     void round();
     void clear();
 
+
     int sf_id = 0;
     int doOperations(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover,
                      VertexSmoother& smoother, const std::array<bool, 4>& ops={{true, true, true, true}});
     int doOperationLoops(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover,
                          VertexSmoother& smoother, int max_pass, const std::array<bool, 4>& ops={{true, true, true, true}});
+    ///renumbers the live vertices and tets along a Hilbert curve, dropping the removed slots
+    double getFragmentation();
+    void reorder(EdgeSplitter& splitter, EdgeCollapser& collapser, EdgeRemover& edge_remover);
     bool is_dealing_unrounded = false;
     bool is_dealing_local = false;
 
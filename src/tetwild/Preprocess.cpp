@@ -95,7 +95,7 @@ void checkBoundary(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F, const Sta
 } // anonymous namespace
 
 bool Preprocess::init(const Eigen::MatrixXd& V_tmp, const Eigen::MatrixXi& F_tmp,
-                      GEO::Mesh& geo_b_mesh, GEO::Mesh& geo_sf_mesh, const Args &args) {
+                      GEO::Mesh& geo_b_mesh, GEO::Mesh& geo_sf_mesh, EnvelopeGrid& envelope_grid, const Args &args) {
 
     ProgressHandler::Debug("{} {}", V_tmp.rows(), F_tmp.rows());
 
@@ -131,6 +131,11 @@ bool Preprocess::init(const Eigen::MatrixXd& V_tmp, const Eigen::MatrixXi& F_tmp
     }
     geo_sf_mesh.facets.compute_borders();
 
+    if (args.use_envelope_grid) {
+        envelope_grid.build(geo_sf_mesh, state.eps_input);
+        ProgressHandler::Debug("envelope grid: {} cells of size {}", envelope_grid.cellCount(), envelope_grid.cellSize());
+    }
+
     getBoundaryMesh(geo_b_mesh);
     state.is_mesh_closed = (geo_b_mesh.vertices.nb() == 0);
 
@@ -214,7 +219,9 @@ void Preprocess::process(GEO::Mesh& geo_sf_mesh, std::vector<Point_3>& m_vertice
     f_is_removed = std::vector<bool>(F_in.rows(), false);
 
     // mesh_reorder(geo_sf_mesh, GEO::MESH_ORDER_HILBERT);
-    GEO::MeshFacetsAABBWithEps geo_face_tree(geo_sf_mesh);
+    GEO::MeshFacetsAABBWithEps geo_face_tree(geo_sf_mesh, true, args.use_wide_envelope_tree);
+    if (args.benchmark_envelope_tree)
+        benchmarkEnvelopeTree(geo_face_tree, geo_sf_mesh, state.eps_2);
 
     std::vector<std::array<int, 2>> edges;
     edges.reserve(F_in.rows()*6);
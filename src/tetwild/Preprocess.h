@@ -14,6 +14,7 @@
 
 #include <tetwild/ForwardDecls.h>
 #include <tetwild/CGALTypes.h>
+#include <tetwild/EnvelopeGrid.h>
 #include <tetwild/geogram/mesh_AABB.h>
 #include <geogram/mesh/mesh.h>
 #include <Eigen/Dense>
@@ -54,7 +55,9 @@ public:
 
     Preprocess(State &st) : state(st) { }
 
-    bool init(const Eigen::MatrixXd& V_tmp, const Eigen::MatrixXi& F_tmp, GEO::Mesh& geo_b_mesh, GEO::Mesh& geo_sf_mesh, const Args &args);
+    ///builds envelope_grid over geo_sf_mesh if args.use_envelope_grid
+    bool init(const Eigen::MatrixXd& V_tmp, const Eigen::MatrixXi& F_tmp, GEO::Mesh& geo_b_mesh, GEO::Mesh& geo_sf_mesh,
+              EnvelopeGrid& envelope_grid, const Args &args);
 
     void getBoundaryMesh(GEO::Mesh& b_mesh);
     void process(GEO::Mesh& geo_sf_mesh, std::vector<Point_3>& m_vertices, std::vector<std::array<int, 3>>& m_faces, const Args &args);
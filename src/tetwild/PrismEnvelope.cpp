@@ -0,0 +1,190 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/PrismEnvelope.h>
+#include <geogram/mesh/mesh_geometry.h>
+#include <algorithm>
+#include <cmath>
+
+namespace tetwild {
+
+namespace {
+//the planes of a prism are rounded to doubles, it is shrunk by this relative margin to stay within eps
+const double PRISM_MARGIN = 1e-6;
+//the exact test gives up (out) beyond this number of pieces left
+const int MAX_PIECES = 1024;
+
+typedef std::vector<Point_3> Polygon;//PrismEnvelope::Polygon
+
+Point_3f toPoint(const GEO::vec3& p) {
+    return Point_3f(p[0], p[1], p[2]);
+}
+
+Point_3 toExact(const Point_3f& p) {
+    return Point_3(p[0], p[1], p[2]);
+}
+
+bool hasArea(const Polygon& poly) {
+    for (int i = 1; i + 1 < poly.size(); i++) {
+        if (!CGAL::collinear(poly[0], poly[i], poly[i + 1]))
+            return true;
+    }
+    return false;
+}
+
+///splits a convex polygon into its parts on the non-negative and the non-positive sides of the plane
+void splitPolygon(const Polygon& poly, const Plane_3& pln, Polygon& pos_poly, Polygon& neg_poly,
+                  std::vector<CGAL::Oriented_side>& sides) {
+    sides.clear();
+    for (const Point_3& p: poly)
+        sides.push_back(pln.oriented_side(p));
+
+    pos_poly.clear();
+    neg_poly.clear();
+    for (int i = 0; i < poly.size(); i++) {
+        int j = (i + 1) % poly.size();
+        if (sides[i] != CGAL::ON_NEGATIVE_SIDE)
+            pos_poly.push_back(poly[i]);
+        if (sides[i] != CGAL::ON_POSITIVE_SIDE)
+            neg_poly.push_back(poly[i]);
+        if (sides[i] * sides[j] < 0) {
+            auto result = intersection(Segment_3(poly[i], poly[j]), pln);
+            const Point_3 *p = boost::get<Point_3>(&*result);
+            pos_poly.push_back(*p);
+            neg_poly.push_back(*p);
+        }
+    }
+}
+}
+
+bool PrismEnvelope::isTriangleOut(const std::array<Point_3f, 3>& tri, double eps, Buffers& buffers) const {
+    std::vector<GEO::index_t>& f_ids = buffers.f_ids;
+    std::vector<Prism>& prisms = buffers.prisms;
+    getCandidateFacets(tri, eps, f_ids);
+
+    const double d = eps / std::sqrt(3) * (1 - PRISM_MARGIN);
+    std::array<bool, 3> is_v_in = {{false, false, false}};
+    int n_partial = 0;
+    prisms.clear();
+    Prism prism;
+    for (GEO::index_t f: f_ids) {
+        if (!getPrism(f, d, prism))
+            continue;
+        int cnt = 0;
+        for (int j = 0; j < 3; j++) {
+            if (isInPrism(prism, tri[j])) {
+                is_v_in[j] = true;
+                cnt++;
+            }
+        }
+        if (cnt == 3) //a prism is convex
+            return false;
+
+        //the prisms containing a vertex come first, they are the most likely to cover the triangle
+        prisms.push_back(prism);
+        if (cnt > 0)
+            std::swap(prisms[n_partial++], prisms.back());
+    }
+    if (!is_v_in[0] || !is_v_in[1] || !is_v_in[2])
+        return true;
+
+    return !isCovered(tri, prisms, buffers);
+}
+
+bool PrismEnvelope::getPrism(GEO::index_t f, double d, Prism& prism) const {
+    std::array<GEO::vec3, 3> vs;
+    for (int j = 0; j < 3; j++)
+        vs[j] = GEO::Geom::mesh_vertex(mesh, mesh.facets.vertex(f, j));
+    GEO::vec3 n = GEO::cross(vs[1] - vs[0], vs[2] - vs[0]);
+    double l = GEO::length(n);
+    if (l == 0)
+        return false;
+    n = n / l;
+
+    //outward normals of the edges vs[j]vs[j + 1] in the plane of the facet
+    std::array<GEO::vec3, 3> os;
+    for (int j = 0; j < 3; j++)
+        os[j] = GEO::normalize(GEO::cross(vs[(j + 1) % 3] - vs[j], n));
+
+    prism.planes[0] = {{toPoint(vs[0] + d * n), toPoint(vs[2] + d * n), toPoint(vs[1] + d * n)}};
+    prism.planes[1] = {{toPoint(vs[0] - d * n), toPoint(vs[1] - d * n), toPoint(vs[2] - d * n)}};
+    for (int j = 0; j < 3; j++) {
+        GEO::vec3 p = vs[j] + d * os[j];
+        GEO::vec3 q = vs[(j + 1) % 3] + d * os[j];
+        prism.planes[2 + j] = {{toPoint(p), toPoint(p + n), toPoint(q)}};
+    }
+    //a corner is cut at d along its outward bisector, so that no point of the prism is farther than sqrt(2) * d
+    //from the corner in the plane of the facet
+    for (int j = 0; j < 3; j++) {
+        GEO::vec3 u = os[(j + 2) % 3] + os[j];
+        double u_l = GEO::length(u);
+        u = u_l > 1e-8 ? u / u_l : os[j];
+        GEO::vec3 p = vs[j] + d * u;
+        prism.planes[5 + j] = {{toPoint(p), toPoint(p + n), toPoint(p + GEO::cross(n, u))}};
+    }
+    return true;
+}
+
+bool PrismEnvelope::isInPrism(const Prism& prism, const Point_3f& p) {
+    for (const auto& pln: prism.planes) {
+        if (CGAL::orientation(pln[0], pln[1], pln[2], p) == CGAL::NEGATIVE)
+            return false;
+    }
+    return true;
+}
+
+void PrismEnvelope::getCandidateFacets(const std::array<Point_3f, 3>& tri, double eps,
+                                       std::vector<GEO::index_t>& f_ids) const {
+    GEO::Box box;
+    for (int c = 0; c < 3; c++) {
+        box.xyz_min[c] = std::min(std::min(tri[0][c], tri[1][c]), tri[2][c]) - eps;
+        box.xyz_max[c] = std::max(std::max(tri[0][c], tri[1][c]), tri[2][c]) + eps;
+    }
+    f_ids.clear();
+    auto action = [&f_ids](GEO::index_t f) { f_ids.push_back(f); };
+    tree.compute_bbox_facet_bbox_intersections(box, action);
+}
+
+bool PrismEnvelope::isCovered(const std::array<Point_3f, 3>& tri, const std::vector<Prism>& prisms, Buffers& buffers) {
+    //the part of the triangle not covered yet, as convex polygons
+    std::vector<Polygon>& pieces = buffers.pieces;
+    std::vector<Polygon>& new_pieces = buffers.new_pieces;
+    Polygon& pos_poly = buffers.pos_poly;
+    Polygon& neg_poly = buffers.neg_poly;
+    pieces.assign(1, Polygon({toExact(tri[0]), toExact(tri[1]), toExact(tri[2])}));
+
+    std::array<Plane_3, 8> plns;
+    for (const Prism& prism: prisms) {
+        for (int i = 0; i < 8; i++)
+            plns[i] = Plane_3(toExact(prism.planes[i][0]), toExact(prism.planes[i][1]), toExact(prism.planes[i][2]));
+
+        new_pieces.clear();
+        for (Polygon& rest: pieces) {
+            //the parts outside of each plane in turn are kept, what remains is inside the prism
+            for (const Plane_3& pln: plns) {
+                splitPolygon(rest, pln, pos_poly, neg_poly, buffers.sides);
+                if (hasArea(neg_poly))
+                    new_pieces.push_back(neg_poly);
+                if (!hasArea(pos_poly))
+                    break;
+                rest.swap(pos_poly);
+            }
+        }
+        pieces.swap(new_pieces);
+
+        //the uncovered part of a triangle is open in it, so it is empty iff it has no area
+        if (pieces.empty())
+            return true;
+        if (pieces.size() > MAX_PIECES)
+            return false;
+    }
+    return false;
+}
+
+} // namespace tetwild
@@ -0,0 +1,64 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <tetwild/CGALTypes.h>
+#include <tetwild/geogram/mesh_AABB.h>
+#include <array>
+#include <vector>
+
+namespace tetwild {
+
+///envelope of the input surface as the union of one convex prism per facet, tested with exact predicates
+///the prism of a facet offsets it by d = eps / sqrt(3) along its normal, and its edges and corners by d in its plane,
+///so that the prism lies within eps of the facet
+///the test of a triangle does not depend on eps: it is accepted as soon as one prism contains its three vertices,
+///rejected as soon as one vertex is in no prism, and else cut exactly by the prisms until nothing is left of it
+class PrismEnvelope {
+private:
+    ///the inside of a prism is on the non-negative side of its 8 planes, each given by 3 points:
+    ///2 caps, 1 side per edge and 1 cut per corner
+    struct Prism {
+        std::array<std::array<Point_3f, 3>, 8> planes;
+    };
+    typedef std::vector<Point_3> Polygon;
+
+public:
+    ///temporaries of the tests, owned by the caller so that concurrent tests share none, see EnvelopeQuery
+    struct Buffers {
+        std::vector<GEO::index_t> f_ids;
+        std::vector<Prism> prisms;
+        std::vector<Polygon> pieces;
+        std::vector<Polygon> new_pieces;
+        Polygon pos_poly;
+        Polygon neg_poly;
+        std::vector<CGAL::Oriented_side> sides;
+    };
+
+    PrismEnvelope(const GEO::Mesh& M, const GEO::MeshFacetsAABBWithEps& tree): mesh(M), tree(tree) {}
+
+    ///conservative: true unless the prisms cover the triangle, true as well if it is too costly to decide
+    bool isTriangleOut(const std::array<Point_3f, 3>& tri, double eps, Buffers& buffers) const;
+
+private:
+
+    ///false for a degenerate facet, whose prism is skipped
+    bool getPrism(GEO::index_t f, double d, Prism& prism) const;
+    static bool isInPrism(const Prism& prism, const Point_3f& p);
+    void getCandidateFacets(const std::array<Point_3f, 3>& tri, double eps, std::vector<GEO::index_t>& f_ids) const;
+
+    ///exact and slow: removes the part of the triangle inside each prism in turn
+    static bool isCovered(const std::array<Point_3f, 3>& tri, const std::vector<Prism>& prisms, Buffers& buffers);
+
+    const GEO::Mesh& mesh;
+    const GEO::MeshFacetsAABBWithEps& tree;
+};
+
+} // namespace tetwild
@@ -0,0 +1,40 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tetwild {
+
+///temporary vector of a local operation, whose capacity is kept from one attempt to the next
+///get() returns it cleared, and counts a growth if its capacity changed since the previous get(),
+///the reallocations between two get() count once
+template<typename T>
+class ScratchVector {
+public:
+    std::vector<T>& get() {
+        if (buf.capacity() != capacity) {
+            capacity = buf.capacity();
+            n_growths++;
+        }
+        buf.clear();
+        return buf;
+    }
+
+    int growthCount() const { return n_growths; }
+
+private:
+    std::vector<T> buf;
+    std::size_t capacity = 0;
+    int n_growths = 0;
+};
+
+} // namespace tetwild
@@ -0,0 +1,179 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/SegmentAABB.h>
+#include <geogram/mesh/mesh_geometry.h>
+#include <algorithm>
+#include <limits>
+
+namespace tetwild {
+
+namespace {
+///zero for the points inside the box
+double pointBoxSquaredDistance(const GEO::vec3& p, const GEO::Box& B) {
+    double sq_dist = 0;
+    for (int c = 0; c < 3; c++) {
+        if (p[c] < B.xyz_min[c])
+            sq_dist += (B.xyz_min[c] - p[c]) * (B.xyz_min[c] - p[c]);
+        else if (p[c] > B.xyz_max[c])
+            sq_dist += (p[c] - B.xyz_max[c]) * (p[c] - B.xyz_max[c]);
+    }
+    return sq_dist;
+}
+
+int maxNode(int n) {
+    //the implicit binary tree of n leaves split at the middle has nodes up to 4n
+    return 4 * n;
+}
+}
+
+double SegmentAABB::pointSegmentSquaredDistance(const GEO::vec3& p, const GEO::vec3& a, const GEO::vec3& b,
+                                                GEO::vec3& nearest_p) {
+    GEO::vec3 ab = b - a;
+    double l2 = GEO::dot(ab, ab);
+    double t = l2 > 0 ? GEO::dot(p - a, ab) / l2 : 0;
+    t = std::min(1.0, std::max(0.0, t));
+    nearest_p = a + t * ab;
+    return GEO::Geom::distance2(p, nearest_p);
+}
+
+void SegmentAABB::build(const GEO::Mesh& b_mesh) {
+    segs.clear();
+    boxes.clear();
+    segs.reserve(b_mesh.facets.nb());
+    for (GEO::index_t f = 0; f < b_mesh.facets.nb(); f++) {
+        std::array<GEO::vec3, 2> s = {{GEO::Geom::mesh_vertex(b_mesh, b_mesh.facets.vertex(f, 0)),
+                                       GEO::Geom::mesh_vertex(b_mesh, b_mesh.facets.vertex(f, 1))}};
+        segs.push_back(s);
+    }
+    if (segs.empty())
+        return;
+    boxes.resize(maxNode(segs.size()) + 1);
+    buildNode(1, 0, segs.size());
+}
+
+void SegmentAABB::buildNode(int node, int b, int e) {
+    GEO::Box& B = boxes[node];
+    for (int c = 0; c < 3; c++) {
+        B.xyz_min[c] = std::numeric_limits<double>::max();
+        B.xyz_max[c] = -std::numeric_limits<double>::max();
+    }
+    for (int i = b; i < e; i++) {
+        for (int c = 0; c < 3; c++) {
+            B.xyz_min[c] = std::min(B.xyz_min[c], std::min(segs[i][0][c], segs[i][1][c]));
+            B.xyz_max[c] = std::max(B.xyz_max[c], std::max(segs[i][0][c], segs[i][1][c]));
+        }
+    }
+    if (e - b == 1)
+        return;
+
+    int axis = 0;
+    for (int c = 1; c < 3; c++) {
+        if (B.xyz_max[c] - B.xyz_min[c] > B.xyz_max[axis] - B.xyz_min[axis])
+            axis = c;
+    }
+    const int m = b + (e - b) / 2;
+    std::nth_element(segs.begin() + b, segs.begin() + m, segs.begin() + e,
+                     [axis](const std::array<GEO::vec3, 2>& s1, const std::array<GEO::vec3, 2>& s2) {
+                         return s1[0][axis] + s1[1][axis] < s2[0][axis] + s2[1][axis];
+                     });
+    buildNode(2 * node, b, m);
+    buildNode(2 * node + 1, m, e);
+}
+
+double SegmentAABB::squaredDistance(const GEO::vec3& p) const {
+    GEO::vec3 nearest_p;
+    double sq_dist;
+    nearestSegment(p, nearest_p, sq_dist);
+    return sq_dist;
+}
+
+void SegmentAABB::nearestSegment(const GEO::vec3& p, int& hint, GEO::vec3& nearest_p, double& sq_dist) const {
+    sq_dist = std::numeric_limits<double>::max();
+    if (segs.empty()) {
+        hint = -1;
+        return;
+    }
+    if (hint < 0 || hint >= segs.size())
+        hint = 0;
+    sq_dist = pointSegmentSquaredDistance(p, segs[hint][0], segs[hint][1], nearest_p);
+    nearestSegmentRecursive(p, 1, 0, segs.size(), hint, nearest_p, sq_dist);
+}
+
+void SegmentAABB::nearestSegmentRecursive(const GEO::vec3& p, int node, int b, int e,
+                                          int& nearest_s, GEO::vec3& nearest_p, double& sq_dist) const {
+    if (e - b == 1) {
+        GEO::vec3 cur_p;
+        double cur_sq_dist = pointSegmentSquaredDistance(p, segs[b][0], segs[b][1], cur_p);
+        if (cur_sq_dist < sq_dist) {
+            sq_dist = cur_sq_dist;
+            nearest_p = cur_p;
+            nearest_s = b;
+        }
+        return;
+    }
+
+    const int m = b + (e - b) / 2;
+    const int node_l = 2 * node, node_r = 2 * node + 1;
+    double d_l = pointBoxSquaredDistance(p, boxes[node_l]);
+    double d_r = pointBoxSquaredDistance(p, boxes[node_r]);
+    if (d_l < d_r) {
+        if (d_l < sq_dist)
+            nearestSegmentRecursive(p, node_l, b, m, nearest_s, nearest_p, sq_dist);
+        if (d_r < sq_dist)
+            nearestSegmentRecursive(p, node_r, m, e, nearest_s, nearest_p, sq_dist);
+    } else {
+        if (d_r < sq_dist)
+            nearestSegmentRecursive(p, node_r, m, e, nearest_s, nearest_p, sq_dist);
+        if (d_l < sq_dist)
+            nearestSegmentRecursive(p, node_l, b, m, nearest_s, nearest_p, sq_dist);
+    }
+}
+
+int SegmentAABB::pointsInEnvelope(const GEO::vec3* ps, int nb, double sq_eps, int& hint,
+                                  TraversalStats* stats) const {
+    if (segs.empty())
+        return 0;
+    if (hint < 0 || hint >= segs.size())
+        hint = 0;
+    TraversalStats local_stats;
+    TraversalStats& s = stats != nullptr ? *stats : local_stats;
+    GEO::vec3 nearest_p;
+    for (int i = 0; i < nb; i++) {
+        //the samples along a boundary edge are most often within eps of the segment of the previous one
+        s.nb_segments++;
+        if (pointSegmentSquaredDistance(ps[i], segs[hint][0], segs[hint][1], nearest_p) <= sq_eps) {
+            s.nb_hint_hits++;
+            continue;
+        }
+        if (!isPointInEnvelopeRecursive(ps[i], sq_eps, 1, 0, segs.size(), hint, s))
+            return i;
+    }
+    return nb;
+}
+
+bool SegmentAABB::isPointInEnvelopeRecursive(const GEO::vec3& p, double sq_eps, int node, int b, int e,
+                                             int& hint, TraversalStats& stats) const {
+    stats.nb_nodes++;
+    if (pointBoxSquaredDistance(p, boxes[node]) > sq_eps)
+        return false;
+    if (e - b == 1) {
+        stats.nb_segments++;
+        GEO::vec3 nearest_p;
+        if (pointSegmentSquaredDistance(p, segs[b][0], segs[b][1], nearest_p) > sq_eps)
+            return false;
+        hint = b;
+        return true;
+    }
+    const int m = b + (e - b) / 2;
+    return isPointInEnvelopeRecursive(p, sq_eps, 2 * node, b, m, hint, stats)
+           || isPointInEnvelopeRecursive(p, sq_eps, 2 * node + 1, m, e, hint, stats);
+}
+
+} // namespace tetwild
@@ -0,0 +1,66 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <geogram/mesh/mesh.h>
+#include <geogram/basic/geometry.h>
+#include <array>
+#include <vector>
+
+namespace tetwild {
+
+///AABB tree of the open boundary of the input surface, with point-segment distances
+///the boundary mesh stores an edge (a, b) as the degenerate facet (a, b, b), see Preprocess::getBoundaryMesh()
+///the tree keeps its own copy of the segments, split at the median of their centers along the longest axis
+class SegmentAABB {
+public:
+    ///work done by pointsInEnvelope(), added to by each call
+    struct TraversalStats {
+        int nb_nodes = 0;
+        int nb_segments = 0;
+        int nb_hint_hits = 0;//points within eps of the hint segment
+    };
+
+    SegmentAABB() {}
+    explicit SegmentAABB(const GEO::Mesh& b_mesh) { build(b_mesh); }
+
+    void build(const GEO::Mesh& b_mesh);
+    bool empty() const { return segs.empty(); }
+
+    ///the distances to an empty tree are infinite
+    double squaredDistance(const GEO::vec3& p) const;
+    ///hint is the nearest segment of a previous point, -1 if none, and is updated
+    void nearestSegment(const GEO::vec3& p, int& hint, GEO::vec3& nearest_p, double& sq_dist) const;
+    void nearestSegment(const GEO::vec3& p, GEO::vec3& nearest_p, double& sq_dist) const {
+        int hint = -1;
+        nearestSegment(p, hint, nearest_p, sq_dist);
+    }
+
+    ///index of the first point of ps[0..nb) farther than sqrt(sq_eps) from the segments, nb if none
+    ///the samples of a boundary edge are tested from the hint segment, and stop the traversal at the first segment
+    ///within sqrt(sq_eps) instead of looking for the nearest one
+    int pointsInEnvelope(const GEO::vec3* ps, int nb, double sq_eps, int& hint,
+                         TraversalStats* stats = nullptr) const;
+
+    static double pointSegmentSquaredDistance(const GEO::vec3& p, const GEO::vec3& a, const GEO::vec3& b,
+                                              GEO::vec3& nearest_p);
+
+private:
+    void buildNode(int node, int b, int e);
+    void nearestSegmentRecursive(const GEO::vec3& p, int node, int b, int e,
+                                 int& nearest_s, GEO::vec3& nearest_p, double& sq_dist) const;
+    bool isPointInEnvelopeRecursive(const GEO::vec3& p, double sq_eps, int node, int b, int e, int& hint,
+                                    TraversalStats& stats) const;
+
+    std::vector<std::array<GEO::vec3, 2>> segs;
+    std::vector<GEO::Box> boxes;//node 1 is the root, the children of node n are 2n and 2n + 1
+};
+
+} // namespace tetwild
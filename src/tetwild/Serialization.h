@@ -12,7 +12,7 @@
 #pragma once
 
 #include <tetwild/CGALTypes.h>
-#include <tetwild/TetmeshElements.h>
+#include <tetwild/TetVertexStore.h>
 #include <tetwild/DisableWarnings.h>
 #include <igl/copyleft/cgal/assign_scalar.h>
 #include <igl/serialize.h>
@@ -79,56 +79,21 @@ namespace igl {
                 ::igl::deserialize(arr[i], std::to_string(i), buffer);
         }
         template<>
-        inline void serialize(const tetwild::TetVertex &v, std::vector<char> &buffer) {
-            ::igl::serialize(v.pos, std::string("pos"), buffer);
-            ::igl::serialize(v.posf, std::string("posf"), buffer);
-
-            ::igl::serialize(v.is_rounded, std::string("is_rounded"), buffer);
-            ::igl::serialize(v.is_on_surface, std::string("is_on_surface"), buffer);
-            ::igl::serialize(v.is_on_bbox, std::string("is_on_bbox"), buffer);
-            ::igl::serialize(v.is_on_boundary, std::string("is_on_boundary"), buffer);
-
-            ::igl::serialize(v.adaptive_scale, std::string("adaptive_scale"), buffer);
-
-//            ::igl::serialize(v.on_fixed_vertex, std::string("on_fixed_vertex"), buffer);
-//            std::vector<int> tmp;
-//            for(auto it=v.on_edge.begin();it!=v.on_edge.end();it++)
-//                tmp.push_back(*it);
-//            ::igl::serialize(tmp, std::string("on_edge"), buffer);
-//            tmp.clear();
-//            for(auto it=v.on_face.begin();it!=v.on_face.end();it++)
-//                tmp.push_back(*it);
-//            ::igl::serialize(tmp, std::string("on_face"), buffer);
-//            tmp.clear();
-//            for(auto it=v.conn_tets.begin();it!=v.conn_tets.end();it++)
-//                tmp.push_back(*it);
-//            ::igl::serialize(tmp, std::string("conn_tets"), buffer);
+        inline void serialize(const tetwild::TetVertexStore &vs, std::vector<char> &buffer) {
+            ::igl::serialize(vs.exact_pos, std::string("exact_pos"), buffer);
+            ::igl::serialize(vs.xyz, std::string("xyz"), buffer);
+            ::igl::serialize(vs.adaptive_scale, std::string("adaptive_scale"), buffer);
+            ::igl::serialize(vs.flags, std::string("flags"), buffer);
         }
 
         template<>
-        inline void deserialize(tetwild::TetVertex &v, const std::vector<char> &buffer) {
-            ::igl::deserialize(v.pos, std::string("pos"), buffer);
-            ::igl::deserialize(v.posf, std::string("posf"), buffer);
-
-            ::igl::deserialize(v.is_rounded, std::string("is_rounded"), buffer);
-            ::igl::deserialize(v.is_on_surface, std::string("is_on_surface"), buffer);
-            ::igl::deserialize(v.is_on_bbox, std::string("is_on_bbox"), buffer);
-            ::igl::deserialize(v.is_on_boundary, std::string("is_on_boundary"), buffer);
-
-            ::igl::deserialize(v.adaptive_scale, std::string("adaptive_scale"), buffer);
-
-//            ::igl::deserialize(v.on_fixed_vertex, std::string("on_fixed_vertex"), buffer);
-//            std::vector<int> tmp;
-//            ::igl::deserialize(tmp, std::string("on_edge"), buffer);
-//            for(int i=0;i<tmp.size();i++)
-//                v.on_edge.insert(tmp[i]);
-//            tmp.clear();
-//            ::igl::deserialize(tmp, std::string("on_face"), buffer);
-//            for(int i=0;i<tmp.size();i++)
-//                v.on_face.insert(tmp[i]);
-//            ::igl::deserialize(tmp, std::string("conn_tets"), buffer);
-//            for(int i=0;i<tmp.size();i++)
-//                v.conn_tets.insert(tmp[i]);
+        inline void deserialize(tetwild::TetVertexStore &vs, const std::vector<char> &buffer) {
+            vs.clear();
+            ::igl::deserialize(vs.exact_pos, std::string("exact_pos"), buffer);
+            ::igl::deserialize(vs.xyz, std::string("xyz"), buffer);
+            ::igl::deserialize(vs.adaptive_scale, std::string("adaptive_scale"), buffer);
+            ::igl::deserialize(vs.flags, std::string("flags"), buffer);
+            vs.versions.resize(vs.flags.size(), 0);
         }
 
 //        template<>
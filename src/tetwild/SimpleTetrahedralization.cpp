@@ -43,12 +43,12 @@ typedef CGAL::Arrangement_2<Traits_2> Arrangement_2;
 
 namespace tetwild {
 
-void SimpleTetrahedralization::tetra(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets) {
+void SimpleTetrahedralization::tetra(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets) {
     std::vector<BSPFace> &faces = MC.bsp_faces;
     std::vector<Point_3> &vertices = MC.bsp_vertices;
 
     ///cal arrangement & tetrahedralization
-    triangulation(tet_vertices, tets);
+    triangulation(tet_vertices, vertex_store, tets);
     ProgressHandler::Debug("#v = {} #t = {}", tet_vertices.size(), tets.size());
 
     for (int i = 0; i < tets.size(); i++) {
@@ -58,7 +58,7 @@ void SimpleTetrahedralization::tetra(std::vector<TetVertex>& tet_vertices, std::
     }
 }
 
-void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets) {
+void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets) {
     std::vector<BSPtreeNode> &bsp_nodes = MC.bsp_nodes;
     std::vector<BSPFace> &bsp_faces = MC.bsp_faces;
     std::vector<BSPEdge> &bsp_edges = MC.bsp_edges;
@@ -215,11 +215,13 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
     tmp_timer.start();
 
     tet_vertices.reserve(bsp_vertices.size() + bsp_nodes.size());
+    vertex_store.reserve(bsp_vertices.size() + bsp_nodes.size());
+    tet_vertices.resize(bsp_vertices.size());
+    vertex_store.resize(bsp_vertices.size());
     for (unsigned int i = 0; i < bsp_vertices.size(); i++) {
-        TetVertex v(bsp_vertices[i]);
+        vertex_store.setPos(i, bsp_vertices[i]);
         if (i < m_vertices_size)
-            v.is_on_surface=true;
-        tet_vertices.push_back(v);
+            vertex_store.set(i, TetVertexStore::ON_SURFACE, true);
     }
 
     ///improvement
@@ -250,8 +252,8 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
         if (is_tet) {
             is_tets[i] = true;
             std::array<int, 4> t = {{v_ids[0], v_ids[1], v_ids[2], v_ids[3]}};
-            if (CGAL::orientation(tet_vertices[t[0]].pos, tet_vertices[t[1]].pos, tet_vertices[t[2]].pos,
-                                  tet_vertices[t[3]].pos) != CGAL::POSITIVE) {
+            if (CGAL::orientation(vertex_store.pos(t[0]), vertex_store.pos(t[1]), vertex_store.pos(t[2]),
+                                  vertex_store.pos(t[3])) != CGAL::POSITIVE) {
                 int tmp = t[1];
                 t[1] = t[3];
                 t[3] = tmp;
@@ -260,6 +262,7 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
         } else {
             TetVertex v;
             tet_vertices.push_back(v);
+            vertex_store.resize(tet_vertices.size());
             centroids_for_nodes[i] = tet_vertices.size() - 1;
         }
     }
@@ -275,7 +278,7 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
                                                         bsp_faces[i].vertices[2]}}));
             if (bsp_faces[i].conn_nodes.size() == 1) {
                 for (int j = 0; j < bsp_faces[i].vertices.size(); j++)
-                    tet_vertices[bsp_faces[i].vertices[j]].is_on_bbox = true;
+                    vertex_store.set(bsp_faces[i].vertices[j], TetVertexStore::ON_BBOX, true);
             }
             continue;
         }
@@ -301,7 +304,7 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
                                                         vs_cdt2bsp[fit->vertex(2)->point()]}}));
             if (bsp_faces[i].conn_nodes.size() == 1) {
                 for (int j = 0; j < bsp_faces[i].vertices.size(); j++)
-                    tet_vertices[bsp_faces[i].vertices[j]].is_on_bbox = true;
+                    vertex_store.set(bsp_faces[i].vertices[j], TetVertexStore::ON_BBOX, true);
             }
         }
     }
@@ -328,15 +331,15 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
         vs.reserve(v_ids.size());
         for (int v_id:v_ids)
             vs.push_back(bsp_vertices[v_id]);
-        tet_vertices[c_id].pos = CGAL::centroid(vs.begin(), vs.end(), CGAL::Dimension_tag<0>());
+        vertex_store.setPos(c_id, CGAL::centroid(vs.begin(), vs.end(), CGAL::Dimension_tag<0>()));
 
         //insert new tets
         int t_cnt = 0;
         for (int j = 0; j < bsp_nodes[i].faces.size(); j++) {
             for (const std::array<int, 3> &f_ids:cdt_faces[bsp_nodes[i].faces[j]]) {
                 std::array<int, 4> t = {{c_id, f_ids[0], f_ids[1], f_ids[2]}};
-                if (CGAL::orientation(tet_vertices[t[0]].pos, tet_vertices[t[1]].pos, tet_vertices[t[2]].pos,
-                                      tet_vertices[t[3]].pos) != CGAL::POSITIVE) {
+                if (CGAL::orientation(vertex_store.pos(t[0]), vertex_store.pos(t[1]), vertex_store.pos(t[2]),
+                                      vertex_store.pos(t[3])) != CGAL::POSITIVE) {
                     int tmp = t[1];
                     t[1] = t[3];
                     t[3] = tmp;
@@ -347,28 +350,27 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
         }
 
         //round into float
-        Point_3 old_p = tet_vertices[c_id].pos;
-        tet_vertices[c_id].posf = Point_3f(CGAL::to_double(old_p[0]), CGAL::to_double(old_p[1]),
-                                           CGAL::to_double(old_p[2]));
-        tet_vertices[c_id].pos = Point_3(tet_vertices[c_id].posf[0], tet_vertices[c_id].posf[1],
-                                         tet_vertices[c_id].posf[2]);
+        Point_3 old_p = vertex_store.pos(c_id);
+        vertex_store.setPosf(c_id, Point_3f(CGAL::to_double(old_p[0]), CGAL::to_double(old_p[1]),
+                                           CGAL::to_double(old_p[2])));
+        vertex_store.releasePos(c_id);
         int tets_size = tets.size();
         bool is_rounded = true;
         for (int j = 0; j < t_cnt; j++) {
-            if (CGAL::orientation(tet_vertices[tets[tets_size - 1 - j][0]].pos,
-                                  tet_vertices[tets[tets_size - 1 - j][1]].pos,
-                                  tet_vertices[tets[tets_size - 1 - j][2]].pos,
-                                  tet_vertices[tets[tets_size - 1 - j][3]].pos) != CGAL::POSITIVE) {
+            if (CGAL::orientation(vertex_store.pos(tets[tets_size - 1 - j][0]),
+                                  vertex_store.pos(tets[tets_size - 1 - j][1]),
+                                  vertex_store.pos(tets[tets_size - 1 - j][2]),
+                                  vertex_store.pos(tets[tets_size - 1 - j][3])) != CGAL::POSITIVE) {
                 is_rounded = false;
                 break;
             }
         }
 
         if (is_rounded) {
-            tet_vertices[c_id].is_rounded = true;
+            vertex_store.set(c_id, TetVertexStore::ROUNDED, true);
             rounded_cnt++;
         } else {
-            tet_vertices[c_id].pos = old_p;
+            vertex_store.setPos(c_id, old_p);
             //todo: calculate a new position
         }
     }
@@ -380,7 +382,7 @@ void SimpleTetrahedralization::triangulation(std::vector<TetVertex>& tet_vertice
 
 void SimpleTetrahedralization::labelSurface(const std::vector<int>& m_f_tags, const std::vector<int>& m_e_tags,
                                             const std::vector<std::vector<int>>& conn_e4v,
-                                            std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets,
+                                            std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets,
                                             std::vector<std::array<int, 4>>& is_surface_fs) {
     std::vector<BSPFace> &bsp_faces = MC.bsp_faces;
     std::vector<Point_3> &bsp_vertices = MC.bsp_vertices;
@@ -477,7 +479,7 @@ void SimpleTetrahedralization::labelSurface(const std::vector<int>& m_f_tags, co
 
     for(unsigned int i=0;i<tet_vertices.size();i++){
         if(tet_vertices[i].on_face.size()>0)
-            tet_vertices[i].is_on_surface=true;
+            vertex_store.set(i, TetVertexStore::ON_SURFACE, true);
     }
 
     ////is face on surface////
@@ -509,8 +511,8 @@ void SimpleTetrahedralization::labelSurface(const std::vector<int>& m_f_tags, co
 //            }
 //            is_visited[i][j] = true;
 
-            if (!tet_vertices[tets[i][(j + 1) % 4]].is_on_surface || !tet_vertices[tets[i][(j + 2) % 4]].is_on_surface
-                || !tet_vertices[tets[i][(j + 3) % 4]].is_on_surface) {
+            if (!vertex_store.is(tets[i][(j + 1) % 4], TetVertexStore::ON_SURFACE) || !vertex_store.is(tets[i][(j + 2) % 4], TetVertexStore::ON_SURFACE)
+                || !vertex_store.is(tets[i][(j + 3) % 4], TetVertexStore::ON_SURFACE)) {
                 is_surface_fs[i][j] = state.NOT_SURFACE;
 //                if (opp_i >= 0)
 //                    is_visited[opp_i][opp_j] = state.NOT_SURFACE;
@@ -545,7 +547,7 @@ void SimpleTetrahedralization::labelSurface(const std::vector<int>& m_f_tags, co
             is_surface_fs[i][j] = 0;
             Plane_3 pln(m_vertices[m_faces[sf_faces[0]][0]], m_vertices[m_faces[sf_faces[0]][1]],
                         m_vertices[m_faces[sf_faces[0]][2]]);
-            CGAL::Oriented_side side = pln.oriented_side(tet_vertices[tets[i][j]].pos);
+            CGAL::Oriented_side side = pln.oriented_side(vertex_store.pos(tets[i][j]));
 
             if (side == CGAL::ON_ORIENTED_BOUNDARY) {
                 log_and_throw("ERROR: side == CGAL::ON_ORIENTED_BOUNDARY!!");
@@ -609,7 +611,7 @@ void SimpleTetrahedralization::labelSurface(const std::vector<int>& m_f_tags, co
     }
 }
 
-void SimpleTetrahedralization::labelBbox(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets){
+void SimpleTetrahedralization::labelBbox(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets){
     std::vector<Point_3> &bsp_vertices = MC.bsp_vertices;
 
     //label bbox
@@ -629,7 +631,7 @@ void SimpleTetrahedralization::labelBbox(std::vector<TetVertex>& tet_vertices, s
     int i=0;
     int i0=0, i7=0;
     for (int I = 0; I < tet_vertices.size(); I++) {
-        if (!tet_vertices[I].is_on_bbox)
+        if (!vertex_store.is(I, TetVertexStore::ON_BBOX))
             continue;
         if (i < 8) {
             tet_vertices[I].on_fixed_vertex = -2 - i;
@@ -668,19 +670,19 @@ void SimpleTetrahedralization::labelBbox(std::vector<TetVertex>& tet_vertices, s
     ProgressHandler::Debug("#v on bbox = {}", i);
 }
 
-void SimpleTetrahedralization::labelBoundary(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets,
+void SimpleTetrahedralization::labelBoundary(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets,
                                              const std::vector<std::array<int, 4>>& is_surface_fs) {
 
     std::vector<std::array<int, 2>> edges_tmp;
     for (int i = 0; i < tets.size(); i++) {
         for (int j = 1; j < 4; j++) {
-            if (tet_vertices[tets[i][0]].is_on_surface && tet_vertices[tets[i][j]].is_on_surface) {
+            if (vertex_store.is(tets[i][0], TetVertexStore::ON_SURFACE) && vertex_store.is(tets[i][j], TetVertexStore::ON_SURFACE)) {
                 std::array<int, 2> e = {{tets[i][0], tets[i][j]}};
                 if (e[1] < e[0])
                     e = {{e[1], e[0]}};
                 edges_tmp.push_back(e);
             }
-            if (tet_vertices[tets[i][j]].is_on_surface && tet_vertices[tets[i][j % 3 + 1]].is_on_surface) {
+            if (vertex_store.is(tets[i][j], TetVertexStore::ON_SURFACE) && vertex_store.is(tets[i][j % 3 + 1], TetVertexStore::ON_SURFACE)) {
                 std::array<int, 2> e = {{tets[i][j], tets[i][j % 3 + 1]}};
                 if (e[1] < e[0])
                     e = {{e[1], e[0]}};
@@ -710,16 +712,16 @@ void SimpleTetrahedralization::labelBoundary(std::vector<TetVertex>& tet_vertice
             }
         }
         if (cnt == 2) {//is boundary edge
-            tet_vertices[edges_tmp[i][0]].is_on_boundary = true;
-            tet_vertices[edges_tmp[i][1]].is_on_boundary = true;
+            vertex_store.set(edges_tmp[i][0], TetVertexStore::ON_BOUNDARY, true);
+            vertex_store.set(edges_tmp[i][1], TetVertexStore::ON_BOUNDARY, true);
         }
     }
 
     int cnt_boundary = 0, cnt_surface = 0;
     for (int i = 0; i < tet_vertices.size(); i++) {
-        if (tet_vertices[i].is_on_boundary)
+        if (vertex_store.is(i, TetVertexStore::ON_BOUNDARY))
             cnt_boundary++;
-        if (tet_vertices[i].is_on_surface)
+        if (vertex_store.is(i, TetVertexStore::ON_SURFACE))
             cnt_surface++;
     }
     ProgressHandler::Debug("{} vertices on boundary", cnt_boundary);
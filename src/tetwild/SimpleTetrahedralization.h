@@ -30,15 +30,15 @@ public:
 
     SimpleTetrahedralization(const State &st, MeshConformer& mc) : state(st), MC(mc) { }
 
-    void tetra(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets);
-    void triangulation(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets);
+    void tetra(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets);
+    void triangulation(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets);
 
     void labelSurface(const std::vector<int>& m_f_tags, const std::vector<int>& m_e_tags,
                       const std::vector<std::vector<int>>& conn_e4v,
-                      std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets,
+                      std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets,
                       std::vector<std::array<int, 4>>& is_surface_fs);
-    void labelBbox(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets);
-    void labelBoundary(std::vector<TetVertex>& tet_vertices, std::vector<std::array<int, 4>>& tets,
+    void labelBbox(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets);
+    void labelBoundary(std::vector<TetVertex>& tet_vertices, TetVertexStore& vertex_store, std::vector<std::array<int, 4>>& tets,
                        const std::vector<std::array<int, 4>>& is_surface_fs);
 
     void constructPlane(int bsp_f_id, Plane_3& pln);
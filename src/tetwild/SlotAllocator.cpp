@@ -0,0 +1,38 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/SlotAllocator.h>
+
+namespace tetwild {
+
+void SlotAllocator::build(const std::vector<bool>& is_removed) {
+    n_slots = is_removed.size();
+    free_ids.clear();
+    for (int i = n_slots - 1; i >= 0; i--) {//the smallest ids are reused first
+        if (is_removed[i])
+            free_ids.push_back(i);
+    }
+}
+
+void SlotAllocator::clear() {
+    free_ids.clear();
+    n_slots = 0;
+    n_allocs = 0;
+}
+
+int SlotAllocator::pop() {
+    if (free_ids.empty())
+        return -1;
+    int id = free_ids.back();
+    free_ids.pop_back();
+    n_allocs++;
+    return id;
+}
+
+} // namespace tetwild
@@ -0,0 +1,46 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <vector>
+
+namespace tetwild {
+
+///free slots of an element array (tets or vertices) flagged by an is_removed vector
+///the free ids are kept in a stack, so that getting a slot and counting the live elements are O(1)
+class SlotAllocator {
+public:
+    void build(const std::vector<bool>& is_removed);
+    void clear();
+
+    int size() const { return n_slots; }
+    int liveCount() const { return n_slots - (int) free_ids.size(); }
+    int freeCount() const { return (int) free_ids.size(); }
+    ///number of slots handed out since the last resetAllocCount(), kept by build()
+    int allocCount() const { return n_allocs; }
+    void resetAllocCount() { n_allocs = 0; }
+
+    ///returns a removed slot to reuse, or -1 if the element array has to grow
+    int pop();
+    ///slot id has just been removed
+    void push(int id) { free_ids.push_back(id); }
+    ///n live slots have been appended to the element array
+    void grow(int n) {
+        n_slots += n;
+        n_allocs += n;
+    }
+
+private:
+    std::vector<int> free_ids;
+    int n_slots = 0;
+    int n_allocs = 0;
+};
+
+} // namespace tetwild
@@ -14,6 +14,7 @@
 #include <string>
 #include <limits>
 #include <tetwild/ForwardDecls.h>
+#include <tetwild/EnvelopeStats.h>
 #include <Eigen/Dense>
 
 namespace tetwild {
@@ -96,6 +97,7 @@ struct MeshRecord {
     double avg_max_d_angle = -1;
     double max_energy = -1;
     double avg_energy = -1;
+    EnvelopeStats envelope;//of the operator, zero for the other records
 
     MeshRecord(int op_, double timing_, int n_v_, int n_t_, double min_min_d_angle_, double avg_min_d_angle_,
                double max_max_d_angle_, double avg_max_d_angle_, double max_energy_, double avg_energy_) {
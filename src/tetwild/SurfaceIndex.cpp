@@ -0,0 +1,108 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/SurfaceIndex.h>
+#include <algorithm>
+#include <cassert>
+
+namespace tetwild {
+
+void SurfaceIndex::clear() {
+    is_valid = false;
+    faces.clear();
+    edges.clear();
+}
+
+void SurfaceIndex::build(const std::vector<std::array<int, 4>>& tets,
+                         const std::vector<std::array<int, 4>>& is_surface_fs,
+                         const std::vector<bool>& t_is_removed, int not_sf) {
+    clear();
+    is_valid = true;
+    not_surface = not_sf;
+    for (int i = 0; i < tets.size(); i++) {
+        if (!t_is_removed[i])
+            addTet(i, tets[i], is_surface_fs[i]);
+    }
+}
+
+void SurfaceIndex::addTet(int t_id, const std::array<int, 4>& tet, const std::array<int, 4>& is_sf_fs) {
+    if (!is_valid)
+        return;
+    for (int j = 0; j < 4; j++) {
+        if (is_sf_fs[j] != not_surface)
+            addFace(faceKey(tet, j), t_id * 4 + j);
+    }
+}
+
+void SurfaceIndex::removeTet(int t_id, const std::array<int, 4>& tet, const std::array<int, 4>& is_sf_fs) {
+    if (!is_valid)
+        return;
+    for (int j = 0; j < 4; j++) {
+        if (is_sf_fs[j] != not_surface)
+            removeFace(faceKey(tet, j), t_id * 4 + j);
+    }
+}
+
+bool SurfaceIndex::isFaceOnSurface(int v1_id, int v2_id, int v3_id) const {
+    std::array<int, 3> f = {{v1_id, v2_id, v3_id}};
+    std::sort(f.begin(), f.end());
+    return faces.count(f) > 0;
+}
+
+void SurfaceIndex::getTetFaces(std::vector<int>& tf_ids) const {
+    tf_ids.clear();
+    tf_ids.reserve(faces.size() * 2);
+    for (const auto& f: faces) {
+        for (int tf_id: f.second) {
+            if (tf_id >= 0)
+                tf_ids.push_back(tf_id);
+        }
+    }
+    std::sort(tf_ids.begin(), tf_ids.end());
+}
+
+std::array<int, 3> SurfaceIndex::faceKey(const std::array<int, 4>& tet, int j) {
+    std::array<int, 3> f = {{tet[(j + 1) % 4], tet[(j + 2) % 4], tet[(j + 3) % 4]}};
+    std::sort(f.begin(), f.end());
+    return f;
+}
+
+void SurfaceIndex::addFace(const std::array<int, 3>& f, int tf_id) {
+    auto it = faces.find(f);
+    if (it == faces.end()) {
+        faces[f] = std::array<int, 2>({{tf_id, -1}});
+        for (int k = 0; k < 3; k++)
+            edges[edgeKey(f[k], f[(k + 1) % 3])]++;
+        return;
+    }
+    assert(it->second[1] < 0);//a face is shared by at most two tets
+    it->second[1] = tf_id;
+}
+
+void SurfaceIndex::removeFace(const std::array<int, 3>& f, int tf_id) {
+    auto it = faces.find(f);
+    if (it == faces.end())
+        return;
+    if (it->second[0] == tf_id)
+        it->second[0] = it->second[1];
+    else if (it->second[1] != tf_id)
+        return;
+    it->second[1] = -1;
+    if (it->second[0] >= 0)
+        return;
+
+    faces.erase(it);
+    for (int k = 0; k < 3; k++) {
+        auto jt = edges.find(edgeKey(f[k], f[(k + 1) % 3]));
+        if (--jt->second == 0)
+            edges.erase(jt);
+    }
+}
+
+} // namespace tetwild
@@ -0,0 +1,70 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tetwild {
+
+///hashed index of the tracked surface, i.e. of the tet faces with is_surface_fs != NOT_SURFACE
+///the faces and edges are keyed by their sorted vertex ids, an edge counts the surface faces containing it
+///a local operation removes the tets it changes before touching tets/is_surface_fs, and adds them back after
+class SurfaceIndex {
+public:
+    ///addTet()/removeTet() are ignored until build() is called again
+    bool isValid() const { return is_valid; }
+    void invalidate() { is_valid = false; }
+    void clear();
+
+    void build(const std::vector<std::array<int, 4>>& tets, const std::vector<std::array<int, 4>>& is_surface_fs,
+               const std::vector<bool>& t_is_removed, int not_surface);
+
+    void addTet(int t_id, const std::array<int, 4>& tet, const std::array<int, 4>& is_sf_fs);
+    void removeTet(int t_id, const std::array<int, 4>& tet, const std::array<int, 4>& is_sf_fs);
+
+    bool isEdgeOnSurface(int v1_id, int v2_id) const { return edges.count(edgeKey(v1_id, v2_id)) > 0; }
+    bool isFaceOnSurface(int v1_id, int v2_id, int v3_id) const;
+    int faceCount() const { return (int) faces.size(); }
+
+    ///the tracked tet faces as t_id * 4 + j, in the order of a scan over is_surface_fs
+    void getTetFaces(std::vector<int>& tf_ids) const;
+
+private:
+    struct FaceHash {
+        std::size_t operator()(const std::array<int, 3>& f) const {
+            uint64_t h = (uint32_t) f[0];
+            h = h * 0x9E3779B97F4A7C15ULL ^ (uint32_t) f[1];
+            h = h * 0x9E3779B97F4A7C15ULL ^ (uint32_t) f[2];
+            return (std::size_t) (h ^ (h >> 32));
+        }
+    };
+
+    static std::array<int, 3> faceKey(const std::array<int, 4>& tet, int j);
+    static uint64_t edgeKey(int v1_id, int v2_id) {
+        if (v1_id > v2_id)
+            std::swap(v1_id, v2_id);
+        return ((uint64_t) (uint32_t) v1_id << 32) | (uint32_t) v2_id;
+    }
+
+    void addFace(const std::array<int, 3>& f, int tf_id);
+    void removeFace(const std::array<int, 3>& f, int tf_id);
+
+    bool is_valid = false;
+    int not_surface = 0;
+
+    std::unordered_map<std::array<int, 3>, std::array<int, 2>, FaceHash> faces;//the (at most) two tet faces, -1 if none
+    std::unordered_map<uint64_t, int> edges;
+};
+
+} // namespace tetwild
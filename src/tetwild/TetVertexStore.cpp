@@ -0,0 +1,72 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#include <tetwild/TetVertexStore.h>
+
+namespace tetwild {
+
+void TetVertexStore::clear() {
+    xyz.clear();
+    adaptive_scale.clear();
+    flags.clear();
+    versions.clear();
+    exact_pos.clear();
+}
+
+void TetVertexStore::resize(int n) {
+    xyz.resize(3 * n, 0);
+    adaptive_scale.resize(n, 1.0);
+    flags.resize(n, 0);
+    //the new vertices are newer than everything computed so far
+    if (n > (int) versions.size())
+        version++;
+    versions.resize(n, version);
+    exact_pos.resize(n);
+}
+
+void TetVertexStore::reserve(int n) {
+    xyz.reserve(3 * n);
+    adaptive_scale.reserve(n);
+    flags.reserve(n);
+    versions.reserve(n);
+    exact_pos.reserve(n);
+}
+
+void TetVertexStore::reset(int v_id) {
+    if (v_id >= size())
+        resize(v_id + 1);
+    setPosf(v_id, Point_3f(0, 0, 0));
+    adaptive_scale[v_id] = 1.0;
+    flags[v_id] = 0;
+    exact_pos[v_id] = Point_3();
+    versions[v_id] = ++version;
+}
+
+void TetVertexStore::permute(const std::vector<int>& old_ids) {
+    std::vector<double> new_xyz(3 * old_ids.size());
+    std::vector<double> new_adaptive_scale(old_ids.size());
+    std::vector<uint8_t> new_flags(old_ids.size());
+    std::vector<uint64_t> new_versions(old_ids.size());
+    std::vector<Point_3> new_exact_pos(old_ids.size());
+    for (int i = 0; i < old_ids.size(); i++) {
+        for (int j = 0; j < 3; j++)
+            new_xyz[3 * i + j] = xyz[3 * old_ids[i] + j];
+        new_adaptive_scale[i] = adaptive_scale[old_ids[i]];
+        new_flags[i] = flags[old_ids[i]];
+        new_versions[i] = versions[old_ids[i]];
+        new_exact_pos[i] = exact_pos[old_ids[i]];
+    }
+    xyz.swap(new_xyz);
+    adaptive_scale.swap(new_adaptive_scale);
+    flags.swap(new_flags);
+    versions.swap(new_versions);
+    exact_pos.swap(new_exact_pos);
+}
+
+} // namespace tetwild
@@ -0,0 +1,161 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+#pragma once
+
+#include <tetwild/CGALTypes.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace tetwild {
+
+///hot/cold split of the vertices, indexed by the same vertex ids as std::vector<TetVertex>
+///the store is the only owner of the coordinates, the tags and adaptive_scale of the vertices,
+///the fields read in the inner loops (posf, the tags, adaptive_scale) are stored contiguously,
+///the exact coordinates are a cold side-table, and TetVertex keeps the surface tracking (on_edge/on_face, conn_tets)
+///each vertex is stamped with the version of the store at its last move, see TetQuality::energy_version
+class TetVertexStore {
+public:
+    enum Flag : uint8_t {
+        ROUNDED     = 1 << 0,
+        ON_SURFACE  = 1 << 1,
+        ON_BBOX     = 1 << 2,
+        ON_BOUNDARY = 1 << 3,
+        LOCKED      = 1 << 4,
+        EXACT       = 1 << 5//exact_pos[v_id] is stored, see pos()
+    };
+
+    std::vector<double> xyz;//x0 y0 z0 x1 y1 z1 ...
+    std::vector<double> adaptive_scale;
+    std::vector<uint8_t> flags;
+    std::vector<uint64_t> versions;//bumped when the position of the vertex changes
+    std::vector<Point_3> exact_pos;//a default Point_3 holds no exact value
+
+    int size() const { return (int) flags.size(); }
+    void clear();
+    void resize(int n);
+    void reserve(int n);
+    ///the new vertex gets the default values, at a reused slot or at the end of the store
+    void reset(int v_id);
+    ///vertex i becomes the old vertex old_ids[i], with its version
+    void permute(const std::vector<int>& old_ids);
+
+    const double* ptr(int v_id) const { return &xyz[3 * v_id]; }
+    Point_3f posf(int v_id) const { return Point_3f(xyz[3 * v_id], xyz[3 * v_id + 1], xyz[3 * v_id + 2]); }
+    void setPosf(int v_id, const Point_3f& p) {
+        if (xyz[3 * v_id] == p[0] && xyz[3 * v_id + 1] == p[1] && xyz[3 * v_id + 2] == p[2])
+            return;
+        versions[v_id] = ++version;
+        xyz[3 * v_id] = p[0];
+        xyz[3 * v_id + 1] = p[1];
+        xyz[3 * v_id + 2] = p[2];
+    }
+    ///posf becomes the rounded exact coordinates
+    void round(int v_id) {
+        const Point_3 p = pos(v_id);
+        setPosf(v_id, Point_3f(CGAL::to_double(p[0]), CGAL::to_double(p[1]), CGAL::to_double(p[2])));
+    }
+
+    ///undoes a tentative setPosf(), the vertex gets back the version of its last real move
+    ///so that the energies computed before stay valid, none may have been stored at the tentative position
+    void restorePosf(int v_id, const Point_3f& p, uint64_t v_version) {
+        versions[v_id] = v_version;
+        xyz[3 * v_id] = p[0];
+        xyz[3 * v_id + 1] = p[1];
+        xyz[3 * v_id + 2] = p[2];
+    }
+
+    ///exact coordinates, only stored while the vertex is not rounded, otherwise derived from posf
+    ///the callers that only need the rounded vertices read posf directly, see tetOrientation()
+    Point_3 pos(int v_id) const {
+        if (is(v_id, EXACT))
+            return exact_pos[v_id];
+        const double *p = ptr(v_id);
+        return Point_3(p[0], p[1], p[2]);
+    }
+    void setPos(int v_id, const Point_3& p) {
+        exact_pos[v_id] = p;
+        set(v_id, EXACT, true);
+    }
+    void releasePos(int v_id) {//pos() == posf from now on
+        exact_pos[v_id] = Point_3();
+        set(v_id, EXACT, false);
+    }
+    ///a rounded vertex keeps no exact coordinates
+    void setRounded(int v_id, bool is_rounded) {
+        set(v_id, ROUNDED, is_rounded);
+        if (is_rounded)
+            releasePos(v_id);
+    }
+
+    ///the stored exact coordinates, to undo a tentative move without building them from posf
+    struct SavedPos {
+        Point_3 p;
+        bool is_exact = false;
+    };
+    SavedPos savePos(int v_id) const {
+        SavedPos s;
+        if (is(v_id, EXACT)) {
+            s.p = exact_pos[v_id];
+            s.is_exact = true;
+        }
+        return s;
+    }
+    void restorePos(int v_id, const SavedPos& s) {
+        exact_pos[v_id] = s.p;
+        set(v_id, EXACT, s.is_exact);
+    }
+
+    ///the version of the last move of any vertex
+    uint64_t getVersion() const { return version; }
+    ///true if none of the vertices of t has moved since the given version
+    bool isUnchangedSince(const std::array<int, 4>& t, uint64_t v) const {
+        return versions[t[0]] <= v && versions[t[1]] <= v && versions[t[2]] <= v && versions[t[3]] <= v;
+    }
+
+    bool is(int v_id, Flag f) const { return (flags[v_id] & f) != 0; }
+    void set(int v_id, Flag f, bool b) {
+        if (b)
+            flags[v_id] |= f;
+        else
+            flags[v_id] &= ~f;
+    }
+
+    double squaredDistance(int v1_id, int v2_id) const {
+        const double *p1 = ptr(v1_id), *p2 = ptr(v2_id);
+        return (p1[0] - p2[0]) * (p1[0] - p2[0]) + (p1[1] - p2[1]) * (p1[1] - p2[1])
+               + (p1[2] - p2[2]) * (p1[2] - p2[2]);
+    }
+
+    void gatherTet(const std::array<int, 4>& t, double *T) const {
+        for (int j = 0; j < 4; j++) {
+            const double *p = ptr(t[j]);
+            T[j * 3] = p[0];
+            T[j * 3 + 1] = p[1];
+            T[j * 3 + 2] = p[2];
+        }
+    }
+
+private:
+    uint64_t version = 0;
+};
+
+///orientation of the tet t, on posf when its 4 vertices are rounded
+///so that no exact point is built for them
+inline CGAL::Orientation tetOrientation(const TetVertexStore& vertex_store, const std::array<int, 4>& t) {
+    if (vertex_store.is(t[0], TetVertexStore::ROUNDED) && vertex_store.is(t[1], TetVertexStore::ROUNDED)
+        && vertex_store.is(t[2], TetVertexStore::ROUNDED) && vertex_store.is(t[3], TetVertexStore::ROUNDED))
+        return CGAL::orientation(vertex_store.posf(t[0]), vertex_store.posf(t[1]), vertex_store.posf(t[2]),
+                                 vertex_store.posf(t[3]));
+    return CGAL::orientation(vertex_store.pos(t[0]), vertex_store.pos(t[1]), vertex_store.pos(t[2]),
+                             vertex_store.pos(t[3]));
+}
+
+} // namespace tetwild
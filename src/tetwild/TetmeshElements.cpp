@@ -16,13 +16,12 @@
 namespace tetwild {
 
 void TetVertex::printInfo() const {
-    ProgressHandler::Debug("is_on_surface = {}", is_on_surface);
-    ProgressHandler::Debug("is_on_bbox = {}", is_on_bbox);
-    ProgressHandler::Debug("conn_tets = {}", conn_tets);
+    ProgressHandler::Debug("on_fixed_vertex = {}", on_fixed_vertex);
+    ProgressHandler::Debug("conn_tets = {}", std::vector<int>(conn_tets.begin(), conn_tets.end()));
 }
 
 void Stage::serialize(std::string serialize_file) {
-    igl::serialize(tet_vertices, "tet_vertices", serialize_file, true);
+    igl::serialize(vertex_store, "vertex_store", serialize_file, true);
     igl::serialize(tets, "tets", serialize_file);
     igl::serialize(is_surface_fs, "tets", serialize_file);
     igl::serialize(v_is_removed, "v_is_removed", serialize_file);
@@ -34,7 +33,7 @@ void Stage::serialize(std::string serialize_file) {
 }
 
 void Stage::deserialize(std::string serialize_file) {
-    igl::deserialize(tet_vertices, "tet_vertices", serialize_file);
+    igl::deserialize(vertex_store, "vertex_store", serialize_file);
     igl::deserialize(tets, "tets", serialize_file);
     igl::deserialize(is_surface_fs, "tets", serialize_file);
     igl::deserialize(v_is_removed, "v_is_removed", serialize_file);
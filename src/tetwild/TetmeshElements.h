@@ -14,52 +14,33 @@
 
 #include <tetwild/State.h>
 #include <tetwild/CGALTypes.h>
+#include <tetwild/ConnTets.h>
+#include <tetwild/TetVertexStore.h>
+#include <array>
+#include <cstdint>
 #include <unordered_set>
+#include <vector>
 
 namespace tetwild {
 
 //const int ON_SURFACE_FALSE = 0;//delete
 //const int ON_SURFACE_TRUE_INSIDE = 1;//delete
 //const int ON_SURFACE_TRUE_OUTSIDE = 2;//delete
+///the cold part of the vertices, the coordinates and the tags are owned by TetVertexStore
 class TetVertex {
 public:
-    Point_3 pos;//todo: how to remove it?
-
     ///for surface conforming
     int on_fixed_vertex = -1;
     std::unordered_set<int> on_edge;//fixed points can be on more than one edges
     std::unordered_set<int> on_face;
-    bool is_on_surface = false;
 
     ///for local operations
-    std::unordered_set<int> conn_tets;
-
-    ///for hybrid rationals
-    Point_3f posf;
-    bool is_rounded = false;
-
-    void round() {
-        posf = Point_3f(CGAL::to_double(pos[0]), CGAL::to_double(pos[1]), CGAL::to_double(pos[2]));
-    }
-
-    ///for bbox
-    bool is_on_bbox = false;
-
-    ///for boundary
-    bool is_on_boundary = false;
-
-    //for adaptive refinement
-    double adaptive_scale = 1.0;
+    ConnTets conn_tets;
 
     TetVertex() = default;
 
-    TetVertex(const Point_3& p) {
-        pos = p;
-    }
-
     void printInfo() const;
 
-    bool is_locked = false;
     bool is_inside = false;
 };
 
@@ -71,6 +52,9 @@ public:
 
     double slim_energy = 0;
     double volume = 0;
+    ///TetVertexStore::getVersion() when slim_energy was computed, 0 if it is not an up to date AMIPS energy
+    ///it stays valid until one of the vertices of the tet moves, see LocalOperations::calTetQualities()
+    uint64_t energy_version = 0;
 
     TetQuality() = default;
     TetQuality(double d_min, double d_max, double r)
@@ -113,7 +97,7 @@ public:
 ///for visualization
 class Stage {
 public:
-    std::vector<TetVertex> tet_vertices;
+    TetVertexStore vertex_store;
     std::vector<std::array<int, 4>> tets;
     std::vector<std::array<int, 4>> is_surface_fs;
     std::vector<bool> t_is_removed;
@@ -124,10 +108,10 @@ public:
     double resolution;
 
     Stage() = default;
-    Stage(const std::vector<TetVertex>& tet_vs, const std::vector<std::array<int, 4>>& ts,
+    Stage(const TetVertexStore& v_store, const std::vector<std::array<int, 4>>& ts,
           const std::vector<std::array<int, 4>>& is_sf_fs,
           const std::vector<bool>& v_is_rd, const std::vector<bool>& t_is_rd, const std::vector<TetQuality>& tet_qs)
-        : tet_vertices(tet_vs), tets(ts), is_surface_fs(is_sf_fs)
+        : vertex_store(v_store), tets(ts), is_surface_fs(is_sf_fs)
         , v_is_removed(v_is_rd), t_is_removed(t_is_rd), tet_qualities(tet_qs)
     { }
 
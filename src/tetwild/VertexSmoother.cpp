@@ -20,10 +20,11 @@ void VertexSmoother::smooth() {
     tets_tss = std::vector<int>(tets.size(), 1);
     tet_vertices_tss = std::vector<int>(tet_vertices.size(), 0);
     ts = 1;
+    envelope_query.resetStats();
 
     igl::Timer tmp_timer0;
     int max_pass = 1;
-    double v_cnt = std::count(v_is_removed.begin(), v_is_removed.end(), false);
+    double v_cnt = v_slots.liveCount();
     for (int i = 0; i < max_pass; i++) {
         double suc_in = 0;
         double suc_surface = 0;
@@ -43,32 +44,32 @@ void VertexSmoother::smooth() {
         ProgressHandler::Debug("{}: {}s", breakdown_name[i], breakdown_timing[i]);
         breakdown_timing[i] = 0;//reset
     }
+    ProgressHandler::Debug("Envelop_cache: {} hits / {} queries", envelope_query.cache.hitCount(), envelope_query.cache.queryCount());
 }
 
 bool VertexSmoother::smoothSingleVertex(int v_id, bool is_cal_energy){
-    std::vector<std::array<int, 4>> new_tets;
-    std::vector<int> t_ids;
+    std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
+    std::vector<int>& t_ids = scratch.t_ids.get();
     for (int t_id:tet_vertices[v_id].conn_tets) {
         new_tets.push_back(tets[t_id]);
         t_ids.push_back(t_id);
     }
 
     ///try to round the vertex
-    if(!tet_vertices[v_id].is_rounded) {
-        Point_3 old_p = tet_vertices[v_id].pos;
-        tet_vertices[v_id].pos = Point_3(tet_vertices[v_id].posf[0], tet_vertices[v_id].posf[1],
-                                         tet_vertices[v_id].posf[2]);
-        if(isFlip(new_tets))
-            tet_vertices[v_id].pos = old_p;
+    if(!vertex_store.is(v_id, TetVertexStore::ROUNDED)) {
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+        vertex_store.releasePos(v_id);
+        if (isFlip(new_tets))
+            vertex_store.restorePos(v_id, old_p);
         else
-            tet_vertices[v_id].is_rounded = true;
+            vertex_store.setRounded(v_id, true);
     }
 
     ///check if should use exact smoothing
     bool is_valid = true;
     for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
-        CGAL::Orientation ori = CGAL::orientation(tet_vertices[tets[*it][0]].posf, tet_vertices[tets[*it][1]].posf,
-                                                  tet_vertices[tets[*it][2]].posf, tet_vertices[tets[*it][3]].posf);
+        CGAL::Orientation ori = CGAL::orientation(vertex_store.posf(tets[*it][0]), vertex_store.posf(tets[*it][1]),
+                                                  vertex_store.posf(tets[*it][2]), vertex_store.posf(tets[*it][3]));
         if (ori != CGAL::POSITIVE) {
             is_valid = false;
             break;
@@ -84,29 +85,23 @@ bool VertexSmoother::smoothSingleVertex(int v_id, bool is_cal_energy){
         }
 
         //assign new coordinate and try to round it
-        Point_3 old_p = tet_vertices[v_id].pos;
-        Point_3f old_pf = tet_vertices[v_id].posf;
-        bool old_is_rounded = tet_vertices[v_id].is_rounded;
-        Point_3 p = Point_3(pf[0], pf[1], pf[2]);
-        tet_vertices[v_id].pos = p;
-        tet_vertices[v_id].posf = pf;
-        tet_vertices[v_id].is_rounded = true;
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+        Point_3f old_pf = vertex_store.posf(v_id);
+        uint64_t old_version = vertex_store.versions[v_id];
+        bool old_is_rounded = vertex_store.is(v_id, TetVertexStore::ROUNDED);
+        vertex_store.releasePos(v_id);//rounded at pf
+        vertex_store.setPosf(v_id, pf);
+        vertex_store.setRounded(v_id, true);
         if (isFlip(new_tets)) {//TODO: why it happens?
             ProgressHandler::Debug("flip in the end");
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
-            tet_vertices[v_id].is_rounded = old_is_rounded;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
+            vertex_store.setRounded(v_id, old_is_rounded);
         }
     }
 
-    if(is_cal_energy){
-        std::vector<TetQuality> tet_qs;
-        calTetQualities(new_tets, tet_qs);
-        int cnt = 0;
-        for (int t_id:tet_vertices[v_id].conn_tets) {
-            tet_qualities[t_id] = tet_qs[cnt++];
-        }
-    }
+    if(is_cal_energy)
+        calTetQualities(t_ids);//nothing to do if the vertex is back at its old position
 
     return true;
 }
@@ -118,12 +113,12 @@ void VertexSmoother::smoothSingle() {
     for (int v_id = 0; v_id < tet_vertices.size(); v_id++) {
         if (v_is_removed[v_id])
             continue;
-        if (tet_vertices[v_id].is_on_bbox)
+        if (vertex_store.is(v_id, TetVertexStore::ON_BBOX))
             continue;
-        if (state.eps != state.EPSILON_INFINITE && tet_vertices[v_id].is_on_surface)
+        if (state.eps != state.EPSILON_INFINITE && vertex_store.is(v_id, TetVertexStore::ON_SURFACE))
             continue;
 
-        if (tet_vertices[v_id].is_locked)
+        if (vertex_store.is(v_id, TetVertexStore::LOCKED))
             continue;
 
         ///check if its one-ring is changed
@@ -142,29 +137,28 @@ void VertexSmoother::smoothSingle() {
 #if TIMING_BREAKDOWN
         igl_timer.start();
 #endif
-        std::vector<std::array<int, 4>> new_tets;
-        std::vector<int> t_ids;
+        std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
+        std::vector<int>& t_ids = scratch.t_ids.get();
         for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
             new_tets.push_back(tets[*it]);
             t_ids.push_back(*it);
         }
 
         ///try to round the vertex
-        if (!tet_vertices[v_id].is_rounded) {
-            Point_3 old_p = tet_vertices[v_id].pos;
-            tet_vertices[v_id].pos = Point_3(tet_vertices[v_id].posf[0], tet_vertices[v_id].posf[1],
-                                             tet_vertices[v_id].posf[2]);
+        if (!vertex_store.is(v_id, TetVertexStore::ROUNDED)) {
+            TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+            vertex_store.releasePos(v_id);
             if (isFlip(new_tets))
-                tet_vertices[v_id].pos = old_p;
+                vertex_store.restorePos(v_id, old_p);
             else
-                tet_vertices[v_id].is_rounded = true;
+                vertex_store.setRounded(v_id, true);
         }
 
         ///check if should use exact smoothing
         bool is_valid = true;
         for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
-            CGAL::Orientation ori = CGAL::orientation(tet_vertices[tets[*it][0]].posf, tet_vertices[tets[*it][1]].posf,
-                                                      tet_vertices[tets[*it][2]].posf, tet_vertices[tets[*it][3]].posf);
+            CGAL::Orientation ori = CGAL::orientation(vertex_store.posf(tets[*it][0]), vertex_store.posf(tets[*it][1]),
+                                                      vertex_store.posf(tets[*it][2]), vertex_store.posf(tets[*it][3]));
             if (ori != CGAL::POSITIVE) {
                 is_valid = false;
                 break;
@@ -186,18 +180,18 @@ void VertexSmoother::smoothSingle() {
             igl_timer.start();
 #endif
             //assign new coordinate and try to round it
-            Point_3 old_p = tet_vertices[v_id].pos;
-            Point_3f old_pf = tet_vertices[v_id].posf;
-            bool old_is_rounded = tet_vertices[v_id].is_rounded;
-            Point_3 p = Point_3(pf[0], pf[1], pf[2]);
-            tet_vertices[v_id].pos = p;
-            tet_vertices[v_id].posf = pf;
-            tet_vertices[v_id].is_rounded = true;
+            TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+            Point_3f old_pf = vertex_store.posf(v_id);
+            uint64_t old_version = vertex_store.versions[v_id];
+            bool old_is_rounded = vertex_store.is(v_id, TetVertexStore::ROUNDED);
+            vertex_store.releasePos(v_id);//rounded at pf
+            vertex_store.setPosf(v_id, pf);
+            vertex_store.setRounded(v_id, true);
             if (isFlip(new_tets)) {//TODO: why it happens?
                 ProgressHandler::Debug("flip in the end");
-                tet_vertices[v_id].pos = old_p;
-                tet_vertices[v_id].posf = old_pf;
-                tet_vertices[v_id].is_rounded = old_is_rounded;
+                vertex_store.restorePos(v_id, old_p);
+                vertex_store.restorePosf(v_id, old_pf, old_version);
+                vertex_store.setRounded(v_id, old_is_rounded);
             }
 #if TIMING_BREAKDOWN
             breakdown_timing[id_round] += igl_timer.getElapsedTime();
@@ -215,7 +209,7 @@ void VertexSmoother::smoothSingle() {
 
     //calculate the quality for all tets
     std::vector<std::array<int, 4>> new_tets;//todo: can be improve
-    new_tets.reserve(std::count(t_is_removed.begin(), t_is_removed.end(), false));
+    new_tets.reserve(t_slots.liveCount());
     for (int i = 0; i < tets.size(); i++) {
         if (t_is_removed[i])
             continue;
@@ -237,7 +231,7 @@ void VertexSmoother::smoothSingle() {
             continue;
 //        if(tets_tss[i]<=old_ts)
 //            continue;
-        tet_qualities[i] = tet_qs[cnt++];
+        setTetQuality(i, tet_qs[cnt++]);
     }
 }
 
@@ -250,47 +244,46 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
     for (int v_id = 0; v_id < tet_vertices.size(); v_id++) {
         if (v_is_removed[v_id])
             continue;
-        if (!tet_vertices[v_id].is_on_surface)
+        if (!vertex_store.is(v_id, TetVertexStore::ON_SURFACE))
             continue;
 
-        if (tet_vertices[v_id].is_locked)
+        if (vertex_store.is(v_id, TetVertexStore::LOCKED))
             continue;
 
         if (isIsolated(v_id)) {
-            tet_vertices[v_id].is_on_surface = false;
-            tet_vertices[v_id].is_on_boundary = false;
+            vertex_store.set(v_id, TetVertexStore::ON_SURFACE, false);
+            vertex_store.set(v_id, TetVertexStore::ON_BOUNDARY, false);
             tet_vertices[v_id].on_fixed_vertex = -1;
             tet_vertices[v_id].on_face.clear();
             tet_vertices[v_id].on_edge.clear();
             continue;
         }
         if (!isBoundaryPoint(v_id))
-            tet_vertices[v_id].is_on_boundary = false;
+            vertex_store.set(v_id, TetVertexStore::ON_BOUNDARY, false);
 
         counter++;
         sf_counter++;
 
-        std::vector<std::array<int, 4>> new_tets;
-        std::vector<int> old_t_ids;
+        std::vector<std::array<int, 4>>& new_tets = scratch.new_tets.get();
+        std::vector<int>& old_t_ids = scratch.old_t_ids.get();
         for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
             new_tets.push_back(tets[*it]);
             old_t_ids.push_back(*it);
         }
 
-        if (!tet_vertices[v_id].is_rounded) {
-            Point_3 old_p = tet_vertices[v_id].pos;
-            tet_vertices[v_id].pos = Point_3(tet_vertices[v_id].posf[0], tet_vertices[v_id].posf[1],
-                                             tet_vertices[v_id].posf[2]);
+        if (!vertex_store.is(v_id, TetVertexStore::ROUNDED)) {
+            TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+            vertex_store.releasePos(v_id);
             if (isFlip(new_tets))
-                tet_vertices[v_id].pos = old_p;
+                vertex_store.restorePos(v_id, old_p);
             else
-                tet_vertices[v_id].is_rounded = true;
+                vertex_store.setRounded(v_id, true);
         }
 
         bool is_valid = true;
         for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
-            CGAL::Orientation ori = CGAL::orientation(tet_vertices[tets[*it][0]].posf, tet_vertices[tets[*it][1]].posf,
-                                                      tet_vertices[tets[*it][2]].posf, tet_vertices[tets[*it][3]].posf);
+            CGAL::Orientation ori = CGAL::orientation(vertex_store.posf(tets[*it][0]), vertex_store.posf(tets[*it][1]),
+                                                      vertex_store.posf(tets[*it][2]), vertex_store.posf(tets[*it][3]));
             if (ori != CGAL::POSITIVE) {
                 is_valid = false;
                 break;
@@ -313,7 +306,7 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
 #if TIMING_BREAKDOWN
         igl_timer.start();
 #endif
-        std::vector<std::array<int, 3>> tri_ids;
+        std::vector<std::array<int, 3>>& tri_ids = scratch.tri_ids.get();
         for (auto it = tet_vertices[v_id].conn_tets.begin(); it != tet_vertices[v_id].conn_tets.end(); it++) {
             for (int j = 0; j < 4; j++) {
                 if (tets[*it][j] != v_id && is_surface_fs[*it][j] != state.NOT_SURFACE) {
@@ -329,10 +322,10 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
         Point_3f pf;
         Point_3 p;
         if (state.use_onering_projection) {//we have to use exact construction here. Or the projecting points may be not exactly on the plane.
-            std::vector<Triangle_3> tris;
+            std::vector<Triangle_3>& tris = scratch.exact_tris.get();
             for (int i = 0; i < tri_ids.size(); i++) {
-                tris.push_back(Triangle_3(tet_vertices[tri_ids[i][0]].pos, tet_vertices[tri_ids[i][1]].pos,
-                                          tet_vertices[tri_ids[i][2]].pos));
+                tris.push_back(Triangle_3(vertex_store.pos(tri_ids[i][0]), vertex_store.pos(tri_ids[i][1]),
+                                          vertex_store.pos(tri_ids[i][2])));
             }
 
             is_valid = false;
@@ -349,32 +342,31 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
             if (!is_valid)
                 continue;
             pf = Point_3f(CGAL::to_double(p[0]), CGAL::to_double(p[1]), CGAL::to_double(p[2]));
-            p = Point_3(pf[0], pf[1], pf[2]);
         } else {
             GEO::vec3 geo_pf(pf_out[0], pf_out[1], pf_out[2]);
             GEO::vec3 nearest_pf;
             double _;
-            if (tet_vertices[v_id].is_on_boundary)
-                geo_b_tree.nearest_facet(geo_pf, nearest_pf, _);
+            if (vertex_store.is(v_id, TetVertexStore::ON_BOUNDARY))
+                geo_b_tree.nearestSegment(geo_pf, nearest_pf, _);
             else
                 geo_sf_tree.nearest_facet(geo_pf, nearest_pf, _);
             pf = Point_3f(nearest_pf[0], nearest_pf[1], nearest_pf[2]);
-            p = Point_3(nearest_pf[0], nearest_pf[1], nearest_pf[2]);
         }
 #if TIMING_BREAKDOWN
         breakdown_timing[id_project] += igl_timer.getElapsedTime();
 #endif
 
-        Point_3 old_p = tet_vertices[v_id].pos;
-        Point_3f old_pf = tet_vertices[v_id].posf;
-        std::vector<TetQuality> tet_qs;
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+        Point_3f old_pf = vertex_store.posf(v_id);
+        uint64_t old_version = vertex_store.versions[v_id];
+        std::vector<TetQuality>& tet_qs = scratch.tet_qs.get();
         bool is_found = false;
 
-        tet_vertices[v_id].posf = pf;
-        tet_vertices[v_id].pos = p;
+        vertex_store.setPosf(v_id, pf);
+        vertex_store.releasePos(v_id);//pos() == pf
         if (isFlip(new_tets)) {
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
             continue;
         }
         TetQuality old_tq, new_tq;
@@ -382,15 +374,15 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
         calTetQualities(new_tets, tet_qs);
         getCheckQuality(tet_qs, new_tq);
         if (!new_tq.isBetterThan(old_tq, energy_type, state)) {
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
             continue;
         }
         is_found = true;
 
         if (!is_found) {
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
             continue;
         }
 
@@ -398,10 +390,10 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
         igl_timer.start();
 #endif
         ///check if the boundary is sliding
-        if (tet_vertices[v_id].is_on_boundary) {
+        if (vertex_store.is(v_id, TetVertexStore::ON_BOUNDARY)) {
             if (isBoundarySlide(v_id, -1, old_pf)) {
-                tet_vertices[v_id].pos = old_p;
-                tet_vertices[v_id].posf = old_pf;
+                vertex_store.restorePos(v_id, old_p);
+                vertex_store.restorePosf(v_id, old_pf, old_version);
 #if TIMING_BREAKDOWN
                 breakdown_timing[id_aabb] += igl_timer.getElapsedTime();
 #endif
@@ -410,29 +402,22 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
         }
 
         ///check if tris outside the envelop
-        std::vector<Triangle_3f> trisf;
+        std::vector<Triangle_3f>& trisf = scratch.tris.get();
         for (int i = 0; i < tri_ids.size(); i++) {
             auto jt = std::find(tri_ids[i].begin(), tri_ids[i].end(), v_id);
             int k = jt - tri_ids[i].begin();
-            Triangle_3f tri(Point_3f(CGAL::to_double(p[0]), CGAL::to_double(p[1]), CGAL::to_double(p[2])),
-                            tet_vertices[tri_ids[i][(k + 1) % 3]].posf, tet_vertices[tri_ids[i][(k + 2) % 3]].posf);
+            Triangle_3f tri(pf, vertex_store.posf(tri_ids[i][(k + 1) % 3]), vertex_store.posf(tri_ids[i][(k + 2) % 3]));
             if (!tri.is_degenerate())
                 trisf.push_back(tri);
         }
 
-        is_valid = true;
-        for (int i = 0; i < trisf.size(); i++) {
-            if (isFaceOutEnvelop(trisf[i])) {
-                is_valid = false;
-                break;
-            }
-        }
+        is_valid = !isFacesOutEnvelop(trisf);
 #if TIMING_BREAKDOWN
         breakdown_timing[id_aabb] += igl_timer.getElapsedTime();
 #endif
         if (!is_valid) {
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
             continue;
         }
 
@@ -443,16 +428,15 @@ void VertexSmoother::smoothSurface() {//smoothing surface using two methods
             tets_tss[*it] = ts;
         tet_vertices_tss[v_id] = ts;
 
-        if (!tet_vertices[v_id].is_rounded) {
-            tet_vertices[v_id].pos = Point_3(pf[0], pf[1], pf[2]);
+        if (!vertex_store.is(v_id, TetVertexStore::ROUNDED)) {
             if (isFlip(new_tets)) {
-                tet_vertices[v_id].pos = old_p;
-                tet_vertices[v_id].is_rounded = false;
+                vertex_store.restorePos(v_id, old_p);
+                vertex_store.setRounded(v_id, false);
             } else
-                tet_vertices[v_id].is_rounded = true;
+                vertex_store.setRounded(v_id, true);
         }
         for (int i = 0; i < old_t_ids.size(); i++)
-            tet_qualities[old_t_ids[i]] = tet_qs[i];
+            setTetQuality(old_t_ids[i], tet_qs[i]);
 
         suc_counter++;
         sf_suc_counter++;
@@ -468,8 +452,9 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
     bool is_moved = false;
     const int MAX_STEP = 15;
     const int MAX_IT = 20;
-    Point_3f pf0 = tet_vertices[v_id].posf;
-    Point_3 p0 = tet_vertices[v_id].pos;
+    Point_3f pf0 = vertex_store.posf(v_id);
+    uint64_t version0 = vertex_store.versions[v_id];
+    TetVertexStore::SavedPos p0 = vertex_store.savePos(v_id);
 
     double old_energy = 0;
     Eigen::Vector3d J;
@@ -478,8 +463,9 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
     for (int step = 0; step < MAX_STEP; step++) {
         if (NewtonsUpdate(t_ids, v_id, old_energy, J, H, X0) == false)
             break;
-        Point_3f old_pf = tet_vertices[v_id].posf;
-        Point_3 old_p = tet_vertices[v_id].pos;
+        Point_3f old_pf = vertex_store.posf(v_id);
+        uint64_t old_version = vertex_store.versions[v_id];
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
         double a = 1;
         bool step_taken = false;
         double new_energy;
@@ -496,14 +482,14 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
                 continue;
             }
 
-            tet_vertices[v_id].posf = Point_3f(X(0), X(1), X(2));
-            tet_vertices[v_id].pos = Point_3(X(0), X(1), X(2));
+            vertex_store.setPosf(v_id, Point_3f(X(0), X(1), X(2)));
+            vertex_store.releasePos(v_id);//pos() == posf
 //            tet_vertices[v_id].is_rounded=true;//need to remember old value?
 
             //check flipping
             if (isFlip(new_tets)) {
-                tet_vertices[v_id].posf = old_pf;
-                tet_vertices[v_id].pos = old_p;
+                vertex_store.restorePosf(v_id, old_pf, old_version);
+                vertex_store.restorePos(v_id, old_p);
                 a /= 2.0;
                 continue;
             }
@@ -513,8 +499,8 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
             new_energy = getNewEnergy(t_ids);
             breakdown_timing[id_value_e] += igl_timer.getElapsedTime();
             if (new_energy >= old_energy || std::isinf(new_energy) || std::isnan(new_energy)) {
-                tet_vertices[v_id].posf = old_pf;
-                tet_vertices[v_id].pos = old_p;
+                vertex_store.restorePosf(v_id, old_pf, old_version);
+                vertex_store.restorePos(v_id, old_p);
                 a /= 2.0;
                 continue;
             }
@@ -534,9 +520,9 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
         } else
             is_moved = true;
     }
-    p = tet_vertices[v_id].posf;
-    tet_vertices[v_id].posf = pf0;
-    tet_vertices[v_id].pos = p0;
+    p = vertex_store.posf(v_id);
+    vertex_store.restorePosf(v_id, pf0, version0);
+    vertex_store.restorePos(v_id, p0);
 
     return is_moved;
 }
@@ -544,78 +530,18 @@ bool VertexSmoother::NewtonsMethod(const std::vector<int>& t_ids, const std::vec
 double VertexSmoother::getNewEnergy(const std::vector<int>& t_ids) {
     double s_energy = 0;
 
-#ifdef TETWILD_WITH_ISPC
-    int n = t_ids.size();
-
-    static thread_local std::vector<double> T0;
-    static thread_local std::vector<double> T1;
-    static thread_local std::vector<double> T2;
-    static thread_local std::vector<double> T3;
-    static thread_local std::vector<double> T4;
-    static thread_local std::vector<double> T5;
-    static thread_local std::vector<double> T6;
-    static thread_local std::vector<double> T7;
-    static thread_local std::vector<double> T8;
-    static thread_local std::vector<double> T9;
-    static thread_local std::vector<double> T10;
-    static thread_local std::vector<double> T11;
-    static thread_local std::vector<double> energy;
-
-    if (T0.empty()) {
-        // logger().trace("Initial ISPC allocation: n = {}", n);
-    } else if (T0.size() != n) {
-        // logger().trace("ISPC reallocation: n = {}", n);
-    }
-
-    T0.resize(n);
-    T1.resize(n);
-    T2.resize(n);
-    T3.resize(n);
-    T4.resize(n);
-    T5.resize(n);
-    T6.resize(n);
-    T7.resize(n);
-    T8.resize(n);
-    T9.resize(n);
-    T10.resize(n);
-    T11.resize(n);
-    energy.resize(n);
-
-    for (int i = 0; i < n; i++) {
-        T0[i] = tet_vertices[tets[t_ids[i]][0]].posf[0];
-        T1[i] = tet_vertices[tets[t_ids[i]][0]].posf[1];
-        T2[i] = tet_vertices[tets[t_ids[i]][0]].posf[2];
-        T3[i] = tet_vertices[tets[t_ids[i]][1]].posf[0];
-        T4[i] = tet_vertices[tets[t_ids[i]][1]].posf[1];
-        T5[i] = tet_vertices[tets[t_ids[i]][1]].posf[2];
-        T6[i] = tet_vertices[tets[t_ids[i]][2]].posf[0];
-        T7[i] = tet_vertices[tets[t_ids[i]][2]].posf[1];
-        T8[i] = tet_vertices[tets[t_ids[i]][2]].posf[2];
-        T9[i] = tet_vertices[tets[t_ids[i]][3]].posf[0];
-        T10[i] = tet_vertices[tets[t_ids[i]][3]].posf[1];
-        T11[i] = tet_vertices[tets[t_ids[i]][3]].posf[2];
-    }
-
-    ispc::energy_ispc(T0.data(), T1.data(), T2.data(), T3.data(), T4.data(),
-        T5.data(), T6.data(), T7.data(), T8.data(),
-        T9.data(), T10.data(), T11.data(), energy.data(), n);
-
-    for (int i = 0; i < n; i++) {
-        s_energy += energy[i]; //s_energy intialized in the beginning
-    }
-#else
-    for (int i = 0; i < t_ids.size(); i++) {
-        std::array<double, 12> t;
-        for (int j = 0; j < 4; j++) {
-            for (int k = 0; k < 3; k++) {
-                t[j*3 + k] = tet_vertices[tets[t_ids[i]][j]].posf[k];
-            }
-        }
-        if (energy_type == state.ENERGY_AMIPS) {
-            s_energy += comformalAMIPSEnergy_new(t.data());
+    if (energy_type == state.ENERGY_AMIPS) {
+        static thread_local AMIPSBatch batch;
+        batch.resize(t_ids.size());
+        for (int i = 0; i < t_ids.size(); i++) {
+            std::array<double, 12> t;
+            vertex_store.gatherTet(tets[t_ids[i]], t.data());
+            batch.setTet(i, t.data());
         }
+        batch.computeEnergies();
+        for (int i = 0; i < t_ids.size(); i++)
+            s_energy += batch.energy(i);
     }
-#endif
     if (std::isinf(s_energy) || std::isnan(s_energy) || s_energy <= 0 || s_energy > state.MAX_ENERGY) {
         ProgressHandler::Debug("new E inf");
         s_energy = state.MAX_ENERGY;
@@ -626,15 +552,13 @@ double VertexSmoother::getNewEnergy(const std::vector<int>& t_ids) {
 
 bool VertexSmoother::NewtonsUpdate(const std::vector<int>& t_ids, int v_id,
                                    double& energy, Eigen::Vector3d& J, Eigen::Matrix3d& H, Eigen::Vector3d& X0) {
-    energy = 0;
-    for (int i = 0; i < 3; i++) {
-        J(i) = 0;
-        for (int j = 0; j < 3; j++) {
-            H(i, j) = 0;
-        }
-        X0(i) = tet_vertices[v_id].posf[i];
-    }
+    for (int i = 0; i < 3; i++)
+        X0(i) = vertex_store.ptr(v_id)[i];
 
+    //the one ring with v_id first in each tet, the energy, jacobian and hessian of all the tets are evaluated at once
+    igl_timer.start();
+    static thread_local AMIPSBatch batch;
+    batch.resize(t_ids.size());
     for (int i = 0; i < t_ids.size(); i++) {
         std::array<double, 12> t;
         int start = 0;
@@ -645,37 +569,26 @@ bool VertexSmoother::NewtonsUpdate(const std::vector<int>& t_ids, int v_id,
             }
         }
         for (int j = 0; j < 4; j++) {
+            const double *p = vertex_store.ptr(tets[t_ids[i]][(start + j) % 4]);
             for (int k = 0; k < 3; k++) {
-                t[j*3+k] = tet_vertices[tets[t_ids[i]][(start + j) % 4]].posf[k];
+                t[j*3+k] = p[k];
             }
         }
-#ifndef TETWILD_WITH_ISPC
-        igl_timer.start();
-        energy += comformalAMIPSEnergy_new(t.data());
-        breakdown_timing[id_value_e] += igl_timer.getElapsedTime();
-#endif
-
-        double J_1[3];
-        double H_1[9];
-        igl_timer.start();
-        comformalAMIPSJacobian_new(t.data(), J_1);
-        breakdown_timing[id_value_j] += igl_timer.getElapsedTime();
-        igl_timer.start();
-        comformalAMIPSHessian_new(t.data(), H_1);
-        breakdown_timing[id_value_h] += igl_timer.getElapsedTime();
-
-        for (int j = 0; j < 3; j++) {
-            J(j) += J_1[j];
-            H(j, 0) += H_1[j * 3 + 0];
-            H(j, 1) += H_1[j * 3 + 1];
-            H(j, 2) += H_1[j * 3 + 2];
-        }
+        batch.setTet(i, t.data());
     }
-#ifdef TETWILD_WITH_ISPC
+    breakdown_timing[id_gather] += igl_timer.getElapsedTime();
+
     igl_timer.start();
-    energy = getNewEnergy(t_ids);
-    breakdown_timing[id_value_e] += igl_timer.getElapsedTime();
-#endif
+    double J_1[3];
+    double H_1[9];
+    batch.computeNewtonSystem(energy, J_1, H_1);
+    for (int j = 0; j < 3; j++) {
+        J(j) = J_1[j];
+        H(j, 0) = H_1[j * 3 + 0];
+        H(j, 1) = H_1[j * 3 + 1];
+        H(j, 2) = H_1[j * 3 + 2];
+    }
+    breakdown_timing[id_value_ejh] += igl_timer.getElapsedTime();
 
     if (std::isinf(energy)) {
         ProgressHandler::Debug("{} E inf", v_id);
@@ -725,7 +638,7 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
                     tmp_n_sf_v_ids.insert(tets[t_id][j]);
                     continue;
                 }
-                if(!tet_vertices[tets[t_id][j]].is_on_surface)
+                if(!vertex_store.is(tets[t_id][j], TetVertexStore::ON_SURFACE))
                     n_v_ids.insert(tets[t_id][j]);
             }
             new_tets.push_back(tets[t_id]);
@@ -754,15 +667,16 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
         std::array<double, 3> vec ={{0, 0, 0}};
         for(int n_sf_v_id:n_sf_v_ids) {
             for (int j = 0; j < 3; j++)
-                vec[j] += tet_vertices[n_sf_v_id].posf[j];
+                vec[j] += vertex_store.ptr(n_sf_v_id)[j];
         }
         for(int j=0;j<3;j++) {
-            vec[j] = (vec[j] / n_sf_v_ids.size()) - tet_vertices[v_id].posf[j];
+            vec[j] = (vec[j] / n_sf_v_ids.size()) - vertex_store.ptr(v_id)[j];
         }
 
         // do bisection and check flipping
-        Point_3 old_p = tet_vertices[v_id].pos;
-        Point_3f old_pf = tet_vertices[v_id].posf;
+        TetVertexStore::SavedPos old_p = vertex_store.savePos(v_id);
+        Point_3f old_pf = vertex_store.posf(v_id);
+        uint64_t old_version = vertex_store.versions[v_id];
         double a = 1;
         bool is_suc = false;
         while(true) {
@@ -773,8 +687,8 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
                     is_stop = false;
             if (is_stop)
                 break;
-            tet_vertices[v_id].pos = Point_3(old_pf[0] + vec[0] * a, old_pf[1] + vec[1] * a, old_pf[2] + vec[2] * a);
-            tet_vertices[v_id].posf = Point_3f(old_pf[0] + vec[0] * a, old_pf[1] + vec[1] * a, old_pf[2] + vec[2] * a);
+            vertex_store.releasePos(v_id);//pos() == posf
+            vertex_store.setPosf(v_id, Point_3f(old_pf[0] + vec[0] * a, old_pf[1] + vec[1] * a, old_pf[2] + vec[2] * a));
             if (isFlip(new_tets)) {
                 a /= 2;
                 continue;
@@ -794,7 +708,7 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
 
             int cnt = 0;
             for (int t_id:tet_vertices[v_id].conn_tets) {
-                tet_qualities[t_id] = tet_qs[cnt++];
+                setTetQuality(t_id, tet_qs[cnt++]);
             }
 
             is_suc = true;
@@ -802,8 +716,8 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
             break;
         }
         if(!is_suc) {
-            tet_vertices[v_id].pos = old_p;
-            tet_vertices[v_id].posf = old_pf;
+            vertex_store.restorePos(v_id, old_p);
+            vertex_store.restorePosf(v_id, old_pf, old_version);
             continue;
         }
 
@@ -811,7 +725,7 @@ int VertexSmoother::laplacianBoundary(const std::vector<int>& b_v_ids, const std
         calTetQualities(new_tets, tet_qs);
         int cnt = 0;
         for (int t_id:tet_vertices[v_id].conn_tets) {
-            tet_qualities[t_id] = tet_qs[cnt++];
+            setTetQuality(t_id, tet_qs[cnt++]);
         }
 
         // do normal smoothing on neighbor vertices
@@ -852,7 +766,7 @@ void VertexSmoother::outputOneRing(int v_id, std::string s){
     Eigen::VectorXi oT(tet_vertices[v_id].conn_tets.size() * 4);
     for (int i = 0; i < v_ids.size(); i++) {
         for (int j = 0; j < 3; j++)
-            oV(i * 3 + j) = tet_vertices[v_ids[i]].posf[j];
+            oV(i * 3 + j) = vertex_store.ptr(v_ids[i])[j];
     }
     cnt = 0;
     for (int t_id: tet_vertices[v_id].conn_tets) {
@@ -39,14 +39,14 @@ public:
                           const std::vector<bool>& tmp_t_is_removed);
 
     int id_value_e=0;
-    int id_value_j=1;
-    int id_value_h=2;
+    int id_gather=1;
+    int id_value_ejh=2;
     int id_solve=3;
     int id_aabb=4;
     int id_project = 5;
     int id_round = 6;
     std::array<double, 7> breakdown_timing={{0,0,0,0,0,0,0}};
-    std::array<std::string, 7> breakdown_name={{"Computing E", "Computing J", "Computing H", "Solving linear system", "AABB", "Project", "Rounding"}};
+    std::array<std::string, 7> breakdown_name={{"Computing E", "Gathering one ring", "Computing E, J and H", "Solving linear system", "AABB", "Project", "Rounding"}};
     igl::Timer igl_timer;
 };
 
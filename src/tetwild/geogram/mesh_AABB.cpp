@@ -44,11 +44,17 @@
  */
 
 #include <tetwild/geogram/mesh_AABB.h>
+#include <tetwild/AMIPSEnergy.h>
 #include <geogram/mesh/mesh_reorder.h>
 #include <geogram/mesh/mesh_geometry.h>
 #include <geogram/mesh/mesh_repair.h>
 #include <geogram/numerics/predicates.h>
 #include <geogram/basic/geometry_nd.h>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace {
 
@@ -237,6 +243,174 @@ namespace {
         return result;
     }
 
+    /**
+     * \brief Relative tolerance of the packet distances, below which
+     *  points_in_envelope() falls back to the scalar distance.
+     */
+    const double PACKET_TOLERANCE = 1e-10;
+
+    /*
+     * Lanes of doubles of the kernels of mesh_AABB_kernels.h for the build
+     * flags: 2 with SSE2 (always there on x86_64), else 1. The compilers do
+     * not vectorize the plain loops by themselves, since min/max/select on
+     * doubles are branches unless floating point traps are ignored.
+     * The cpus with AVX2 use the 4 lanes of mesh_AABB_avx2.cpp instead,
+     * selected at runtime as the AMIPS energy kernels.
+     */
+#if defined(__SSE2__)
+    typedef __m128d vdouble;
+    const int VDOUBLE_WIDTH = 2;
+    inline vdouble vset1(double x) { return _mm_set1_pd(x); }
+    inline vdouble vload(const double* p) { return _mm_loadu_pd(p); }
+    inline vdouble vload(const float* p) { return _mm_set_pd(double(p[1]), double(p[0])); }
+    inline void vstore(double* p, vdouble x) { _mm_storeu_pd(p, x); }
+    inline vdouble vadd(vdouble a, vdouble b) { return _mm_add_pd(a, b); }
+    inline vdouble vsub(vdouble a, vdouble b) { return _mm_sub_pd(a, b); }
+    inline vdouble vmul(vdouble a, vdouble b) { return _mm_mul_pd(a, b); }
+    inline vdouble vmin(vdouble a, vdouble b) { return _mm_min_pd(a, b); }
+    inline vdouble vmax(vdouble a, vdouble b) { return _mm_max_pd(a, b); }
+    inline vdouble vlt(vdouble a, vdouble b) { return _mm_cmplt_pd(a, b); }
+    inline vdouble vle(vdouble a, vdouble b) { return _mm_cmple_pd(a, b); }
+    inline vdouble vand(vdouble a, vdouble b) { return _mm_and_pd(a, b); }
+    inline vdouble vselect(vdouble mask, vdouble a, vdouble b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+#else
+    typedef double vdouble;
+    const int VDOUBLE_WIDTH = 1;
+    // A mask is 1.0 (true) or 0.0 (false)
+    inline vdouble vset1(double x) { return x; }
+    inline vdouble vload(const double* p) { return *p; }
+    inline vdouble vload(const float* p) { return double(*p); }
+    inline void vstore(double* p, vdouble x) { *p = x; }
+    inline vdouble vadd(vdouble a, vdouble b) { return a + b; }
+    inline vdouble vsub(vdouble a, vdouble b) { return a - b; }
+    inline vdouble vmul(vdouble a, vdouble b) { return a * b; }
+    inline vdouble vmin(vdouble a, vdouble b) { return a < b ? a : b; }
+    inline vdouble vmax(vdouble a, vdouble b) { return a > b ? a : b; }
+    inline vdouble vlt(vdouble a, vdouble b) { return a < b ? 1.0 : 0.0; }
+    inline vdouble vle(vdouble a, vdouble b) { return a <= b ? 1.0 : 0.0; }
+    inline vdouble vand(vdouble a, vdouble b) { return a * b; }
+    inline vdouble vselect(vdouble mask, vdouble a, vdouble b) { return mask != 0.0 ? a : b; }
+#endif
+}
+
+#include <tetwild/geogram/mesh_AABB_kernels.h>
+
+namespace {
+
+    using namespace GEO;
+
+    static_assert(KERNEL_PACKET_SIZE == int(MeshFacetsAABBWithEps::PACKET_SIZE), "packet size of the kernels");
+    static_assert(KERNEL_WIDE_ARITY == int(MeshFacetsAABBWithEps::WIDE_ARITY), "arity of the kernels");
+
+#ifdef TETWILD_WITH_SIMD
+    /**
+     * \brief Tells whether the kernels of mesh_AABB_avx2.cpp can be used,
+     *  they are only compiled with TETWILD_WITH_SIMD.
+     */
+    inline bool use_avx2_kernels() {
+        return tetwild::getSimdLevel() >= tetwild::SimdLevel::AVX2;
+    }
+#endif
+
+    /**
+     * \brief Computes the squared distances between a triangle and
+     *  a packet of points, see packet_triangle_squared_distance_lanes().
+     */
+    void packet_triangle_squared_distance(
+        const vec3& p1, const vec3& p2, const vec3& p3,
+        const double* x, const double* y, const double* z,
+        double* sq_dist, double* scale
+    ) {
+#ifdef TETWILD_WITH_SIMD
+        if(use_avx2_kernels()) {
+            packet_triangle_squared_distance_avx2(
+                p1.data(), p2.data(), p3.data(), x, y, z, sq_dist, scale
+            );
+            return;
+        }
+#endif
+        packet_triangle_squared_distance_lanes(
+            p1.data(), p2.data(), p3.data(), x, y, z, sq_dist, scale
+        );
+    }
+
+    /**
+     * \brief Computes the squared distances between a Box and a packet
+     *  of points, zero for the points inside the Box.
+     * \param[in] B the box
+     * \param[in] x , y , z the coordinates of the points
+     * \param[out] sq_dist the squared distances
+     */
+    void packet_box_squared_distance(
+        const Box& B,
+        const double* x, const double* y, const double* z,
+        double* sq_dist
+    ) {
+#ifdef TETWILD_WITH_SIMD
+        if(use_avx2_kernels()) {
+            packet_box_squared_distance_avx2(B.xyz_min, B.xyz_max, x, y, z, sq_dist);
+            return;
+        }
+#endif
+        packet_box_squared_distance_lanes(B.xyz_min, B.xyz_max, x, y, z, sq_dist);
+    }
+
+    /**
+     * \brief Computes the squared distances between a point and the
+     *  boxes of the children of a node of the wide layout, see
+     *  wide_box_squared_distance_lanes().
+     */
+    void wide_box_squared_distance(
+        const float xyz_min[3][MeshFacetsAABBWithEps::WIDE_ARITY],
+        const float xyz_max[3][MeshFacetsAABBWithEps::WIDE_ARITY],
+        const vec3& p, double* sq_dist, double* signed_sq_dist
+    ) {
+#ifdef TETWILD_WITH_SIMD
+        if(use_avx2_kernels()) {
+            wide_box_squared_distance_avx2(xyz_min, xyz_max, p.data(), sq_dist, signed_sq_dist);
+            return;
+        }
+#endif
+        wide_box_squared_distance_lanes(xyz_min, xyz_max, p.data(), sq_dist, signed_sq_dist);
+    }
+
+    /**
+     * \brief Rounds a coordinate to single precision, towards -infinity
+     *  or +infinity.
+     * \param[in] x the coordinate
+     * \param[in] up true to round towards +infinity
+     * \return the nearest float below (or above) \p x
+     */
+    float round_float(double x, bool up) {
+        float result = float(x);
+        if(up && double(result) < x) {
+            result = std::nextafter(result, std::numeric_limits<float>::max());
+        } else if(!up && double(result) > x) {
+            result = std::nextafter(result, -std::numeric_limits<float>::max());
+        }
+        return result;
+    }
+
+    /**
+     * \brief Sorts the children of a wide node by increasing distance.
+     * \param[in] sq_dist the squared distances to the children
+     * \param[out] order the indices of the children, nearest first
+     */
+    void wide_sort_children(
+        const double* sq_dist, index_t* order
+    ) {
+        const index_t N = MeshFacetsAABBWithEps::WIDE_ARITY;
+        for(index_t i = 0; i < N; ++i) {
+            index_t j = i;
+            for(; j > 0 && sq_dist[order[j - 1]] > sq_dist[i]; --j) {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+    }
+
     /**
      * \brief Tests whether a segment intersects a triangle.
      * \param[in] q1 , q2 the two extremities of the segment.
@@ -354,9 +528,10 @@ namespace {
 namespace GEO {
 
     MeshFacetsAABBWithEps::MeshFacetsAABBWithEps(
-        Mesh& M, bool reorder
+        Mesh& M, bool reorder, bool wide
     ) :
-        mesh_(M) {
+        mesh_(M),
+        wide_(false) {
         if(!M.facets.are_simplices()) {
             mesh_repair(
                 M,
@@ -376,6 +551,75 @@ namespace GEO {
         init_bboxes_recursive(
             mesh_, bboxes_, 1, 0, mesh_.facets.nb(), get_facet_bbox
         );
+        set_wide_layout(wide);
+    }
+
+    void MeshFacetsAABBWithEps::set_wide_layout(bool wide) {
+        if(wide && wide_nodes_.empty()) {
+            init_wide_node_recursive(1, 0, mesh_.facets.nb());
+        }
+        wide_ = wide;
+    }
+
+    index_t MeshFacetsAABBWithEps::init_wide_node_recursive(
+        index_t n, index_t b, index_t e
+    ) {
+        geo_debug_assert(e > b);
+
+        // Expand the largest binary subtree until there are WIDE_ARITY
+        // of them, or all of them fit in a leaf
+        index_t nodes[WIDE_ARITY];
+        index_t begins[WIDE_ARITY];
+        index_t ends[WIDE_ARITY];
+        index_t nb = 1;
+        nodes[0] = n;
+        begins[0] = b;
+        ends[0] = e;
+        while(nb < WIDE_ARITY) {
+            index_t largest = nb;
+            for(index_t i = 0; i < nb; ++i) {
+                if(
+                    ends[i] - begins[i] > WIDE_LEAF_SIZE &&
+                    (largest == nb ||
+                     ends[i] - begins[i] > ends[largest] - begins[largest])
+                ) {
+                    largest = i;
+                }
+            }
+            if(largest == nb) {
+                break;
+            }
+            index_t m = begins[largest] + (ends[largest] - begins[largest]) / 2;
+            nodes[nb] = 2 * nodes[largest] + 1;
+            begins[nb] = m;
+            ends[nb] = ends[largest];
+            nodes[largest] = 2 * nodes[largest];
+            ends[largest] = m;
+            ++nb;
+        }
+
+        index_t result = wide_nodes_.size();
+        WideNode node;
+        for(index_t i = 0; i < WIDE_ARITY; ++i) {
+            for(coord_index_t c = 0; c < 3; ++c) {
+                node.xyz_min[c][i] = i < nb ? round_float(bboxes_[nodes[i]].xyz_min[c], false) : std::numeric_limits<float>::max();
+                node.xyz_max[c][i] = i < nb ? round_float(bboxes_[nodes[i]].xyz_max[c], true) : -std::numeric_limits<float>::max();
+            }
+            bool is_leaf = i < nb && ends[i] - begins[i] <= WIDE_LEAF_SIZE;
+            node.first[i] = i < nb ? begins[i] : 0;
+            node.nb_facets[i] = Numeric::uint8(is_leaf ? ends[i] - begins[i] : 0);
+        }
+        wide_nodes_.push_back(node);
+
+        // The children are created after their parent, so that a
+        // subtree is contiguous in wide_nodes_
+        for(index_t i = 0; i < nb; ++i) {
+            if(ends[i] - begins[i] > WIDE_LEAF_SIZE) {
+                index_t child = init_wide_node_recursive(nodes[i], begins[i], ends[i]);
+                wide_nodes_[result].first[i] = child;
+            }
+        }
+        return result;
     }
 
     void MeshFacetsAABBWithEps::get_nearest_facet_hint(
@@ -570,6 +814,323 @@ namespace GEO {
         );
     }
 
+/****************************************************************************/
+
+    const index_t MeshFacetsAABBWithEps::PACKET_SIZE;
+
+    /**
+     * \brief The query points of points_in_envelope(), stored by
+     *  coordinate for the packet kernels.
+     * \details The lanes past \p nb are copies of the first point that
+     *  are already marked in the envelope, so that the kernels always
+     *  run on full packets.
+     */
+    struct MeshFacetsAABBWithEps::PointPacket {
+        const vec3* p;
+        index_t nb;
+        double sq_epsilon;
+        double x[PACKET_SIZE];
+        double y[PACKET_SIZE];
+        double z[PACKET_SIZE];
+        double sq_dist[PACKET_SIZE];
+        index_t facet[PACKET_SIZE];
+        index_t nb_out;  // number of points with sq_dist > sq_epsilon
+        index_t nb_nodes;
+        index_t nb_facets;
+
+        /**
+         * \brief Tests whether a subtree may contain a facet that puts
+         *  one of the points out of the envelope into it.
+         * \param[in] box_sq_dist the squared distances between the
+         *  points and the box of the subtree
+         */
+        bool reaches(const double* box_sq_dist) const {
+            for(index_t k = 0; k < nb; ++k) {
+                if(
+                    sq_dist[k] > sq_epsilon &&
+                    box_sq_dist[k] < sq_dist[k] &&
+                    box_sq_dist[k] <= sq_epsilon
+                ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    index_t MeshFacetsAABBWithEps::points_in_envelope(
+        const vec3* p, index_t nb, double sq_epsilon,
+        index_t& hint_facet, TraversalStats* stats
+    ) const {
+        geo_debug_assert(nb > 0 && nb <= PACKET_SIZE);
+        PointPacket P;
+        P.p = p;
+        P.nb = nb;
+        P.sq_epsilon = sq_epsilon;
+        P.nb_out = nb;
+        P.nb_nodes = 0;
+        P.nb_facets = 0;
+        for(index_t k = 0; k < PACKET_SIZE; ++k) {
+            const vec3& q = p[k < nb ? k : 0];
+            P.x[k] = q.x;
+            P.y[k] = q.y;
+            P.z[k] = q.z;
+            P.sq_dist[k] = k < nb ? std::numeric_limits<double>::max() : 0.0;
+            P.facet[k] = NO_FACET;
+        }
+
+        if(hint_facet == NO_FACET) {
+            vec3 nearest_point;
+            double sq_dist;
+            get_nearest_facet_hint(p[0], hint_facet, nearest_point, sq_dist);
+        }
+        packet_facet_test(P, hint_facet);
+        if(stats != nullptr) {
+            stats->nb_hint_hits += nb - P.nb_out;
+        }
+        if(wide_) {
+            wide_points_in_envelope(P);
+        } else {
+            points_in_envelope_recursive(P, 1, 0, mesh_.facets.nb());
+        }
+        if(stats != nullptr) {
+            stats->nb_nodes += P.nb_nodes;
+            stats->nb_facets += P.nb_facets;
+        }
+
+        if(P.facet[nb - 1] != NO_FACET) {
+            hint_facet = P.facet[nb - 1];
+        }
+        for(index_t k = 0; k < nb; ++k) {
+            if(P.sq_dist[k] > sq_epsilon) {
+                return k;
+            }
+        }
+        return nb;
+    }
+
+    void MeshFacetsAABBWithEps::packet_facet_test(
+        PointPacket& P, index_t f
+    ) const {
+        geo_debug_assert(mesh_.facets.nb_vertices(f) == 3);
+        ++P.nb_facets;
+        index_t c = mesh_.facets.corners_begin(f);
+        const vec3& p1 = Geom::mesh_vertex(mesh_, mesh_.facet_corners.vertex(c));
+        ++c;
+        const vec3& p2 = Geom::mesh_vertex(mesh_, mesh_.facet_corners.vertex(c));
+        ++c;
+        const vec3& p3 = Geom::mesh_vertex(mesh_, mesh_.facet_corners.vertex(c));
+
+        double sq_dist[PACKET_SIZE];
+        double scale[PACKET_SIZE];
+        packet_triangle_squared_distance(
+            p1, p2, p3, P.x, P.y, P.z, sq_dist, scale
+        );
+
+        for(index_t k = 0; k < P.nb; ++k) {
+            if(P.sq_dist[k] <= P.sq_epsilon) {
+                continue;
+            }
+            double d = sq_dist[k];
+            // Close to the envelope boundary, decide with the same distance
+            // as facet_in_envelope_with_hint() so that the answer does not
+            // depend on rounding.
+            if(std::fabs(d - P.sq_epsilon) <= PACKET_TOLERANCE * scale[k]) {
+                vec3 nearest_point;
+                get_point_facet_nearest_point(mesh_, P.p[k], f, nearest_point, d);
+            }
+            if(d < P.sq_dist[k]) {
+                P.sq_dist[k] = d;
+                P.facet[k] = f;
+                if(d <= P.sq_epsilon) {
+                    --P.nb_out;
+                }
+            }
+        }
+    }
+
+    void MeshFacetsAABBWithEps::points_in_envelope_recursive(
+        PointPacket& P, index_t n, index_t b, index_t e
+    ) const {
+        geo_debug_assert(e > b);
+
+        if(P.nb_out == 0) {
+            return;
+        }
+        ++P.nb_nodes;
+
+        // If node is a leaf: test the facet against all the points
+        // that are still out
+        if(b + 1 == e) {
+            packet_facet_test(P, b);
+            return;
+        }
+        index_t m = b + (e - b) / 2;
+        index_t childl = 2 * n;
+        index_t childr = 2 * n + 1;
+
+        double dl[PACKET_SIZE];
+        double dr[PACKET_SIZE];
+        packet_box_squared_distance(bboxes_[childl], P.x, P.y, P.z, dl);
+        packet_box_squared_distance(bboxes_[childr], P.x, P.y, P.z, dr);
+
+        // Traverse first the child that is nearest to the points that
+        // are still out, so that it has more chances to prune the other one.
+        double min_dl = std::numeric_limits<double>::max();
+        double min_dr = std::numeric_limits<double>::max();
+        for(index_t k = 0; k < P.nb; ++k) {
+            if(P.sq_dist[k] > P.sq_epsilon) {
+                min_dl = std::min(min_dl, dl[k]);
+                min_dr = std::min(min_dr, dr[k]);
+            }
+        }
+        if(min_dl < min_dr) {
+            if(P.reaches(dl)) {
+                points_in_envelope_recursive(P, childl, b, m);
+            }
+            if(P.reaches(dr)) {
+                points_in_envelope_recursive(P, childr, m, e);
+            }
+        } else {
+            if(P.reaches(dr)) {
+                points_in_envelope_recursive(P, childr, m, e);
+            }
+            if(P.reaches(dl)) {
+                points_in_envelope_recursive(P, childl, b, m);
+            }
+        }
+    }
+
+    void MeshFacetsAABBWithEps::wide_nearest_facet(
+        const vec3& p, double sq_epsilon,
+        index_t& nearest_f, vec3& nearest_point, double& sq_dist
+    ) const {
+        // The boxes farther than this cannot contain a facet in the envelope
+        double max_sq_dist = sq_epsilon < 0.0 ? std::numeric_limits<double>::max() : sq_epsilon;
+
+        // The nodes to visit with the distances to their boxes, the
+        // nearest on top. A node pushes at most WIDE_ARITY - 1 more
+        // entries than it pops, once per level of the tree.
+        const index_t STACK_SIZE = 32 * WIDE_ARITY;
+        index_t stack_node[STACK_SIZE];
+        double stack_sq_dist[STACK_SIZE];
+        index_t top = 0;
+        stack_node[top] = 0;
+        stack_sq_dist[top] = 0.0;
+        ++top;
+
+        while(top > 0) {
+            if(sq_dist <= sq_epsilon) {
+                return;
+            }
+            --top;
+            // Prune the nodes that a facet found since their push is nearer than
+            if(stack_sq_dist[top] >= sq_dist) {
+                continue;
+            }
+            const WideNode& node = wide_nodes_[stack_node[top]];
+
+            double d[WIDE_ARITY];
+            double signed_d[WIDE_ARITY];
+            wide_box_squared_distance(node.xyz_min, node.xyz_max, p, d, signed_d);
+            index_t order[WIDE_ARITY];
+            wide_sort_children(signed_d, order);
+
+            // Test the leaves nearest first, then push the inner
+            // nodes farthest first
+            for(index_t i = 0; i < WIDE_ARITY; ++i) {
+                index_t c = order[i];
+                if(node.nb_facets[c] == 0 || !(d[c] < sq_dist && d[c] <= max_sq_dist)) {
+                    continue;
+                }
+                for(index_t f = node.first[c]; f < node.first[c] + node.nb_facets[c]; ++f) {
+                    vec3 cur_nearest_point;
+                    double cur_sq_dist;
+                    get_point_facet_nearest_point(
+                        mesh_, p, f, cur_nearest_point, cur_sq_dist
+                    );
+                    if(cur_sq_dist < sq_dist) {
+                        nearest_f = f;
+                        nearest_point = cur_nearest_point;
+                        sq_dist = cur_sq_dist;
+                    }
+                }
+                if(sq_dist <= sq_epsilon) {
+                    return;
+                }
+            }
+            for(index_t i = WIDE_ARITY; i-- > 0;) {
+                index_t c = order[i];
+                if(node.nb_facets[c] != 0 || !(d[c] < sq_dist && d[c] <= max_sq_dist)) {
+                    continue;
+                }
+                geo_debug_assert(top < STACK_SIZE);
+                stack_node[top] = node.first[c];
+                stack_sq_dist[top] = d[c];
+                ++top;
+            }
+        }
+    }
+
+    void MeshFacetsAABBWithEps::wide_points_in_envelope(
+        PointPacket& P
+    ) const {
+        const index_t STACK_SIZE = 32 * WIDE_ARITY;
+        index_t stack_node[STACK_SIZE];
+        index_t top = 0;
+        stack_node[top] = 0;
+        ++top;
+
+        while(top > 0 && P.nb_out > 0) {
+            --top;
+            const WideNode& node = wide_nodes_[stack_node[top]];
+            ++P.nb_nodes;
+
+            // Distances between all the children and all the points, and
+            // for each child its distance to the nearest point still out
+            double d[WIDE_ARITY][PACKET_SIZE];
+            double min_d[WIDE_ARITY];
+            for(index_t c = 0; c < WIDE_ARITY; ++c) {
+                Box B;
+                for(coord_index_t coord = 0; coord < 3; ++coord) {
+                    B.xyz_min[coord] = node.xyz_min[coord][c];
+                    B.xyz_max[coord] = node.xyz_max[coord][c];
+                }
+                packet_box_squared_distance(B, P.x, P.y, P.z, d[c]);
+                min_d[c] = std::numeric_limits<double>::max();
+                for(index_t k = 0; k < P.nb; ++k) {
+                    if(P.sq_dist[k] > P.sq_epsilon) {
+                        min_d[c] = std::min(min_d[c], d[c][k]);
+                    }
+                }
+            }
+            index_t order[WIDE_ARITY];
+            wide_sort_children(min_d, order);
+
+            for(index_t i = 0; i < WIDE_ARITY; ++i) {
+                index_t c = order[i];
+                if(node.nb_facets[c] == 0 || !P.reaches(d[c])) {
+                    continue;
+                }
+                for(index_t f = node.first[c]; f < node.first[c] + node.nb_facets[c]; ++f) {
+                    packet_facet_test(P, f);
+                }
+                if(P.nb_out == 0) {
+                    return;
+                }
+            }
+            for(index_t i = WIDE_ARITY; i-- > 0;) {
+                index_t c = order[i];
+                if(node.nb_facets[c] != 0 || !P.reaches(d[c])) {
+                    continue;
+                }
+                geo_debug_assert(top < STACK_SIZE);
+                stack_node[top] = node.first[c];
+                ++top;
+            }
+        }
+    }
+
 /****************************************************************************/
 
 }
@@ -72,9 +72,32 @@ namespace GEO {
          * \param[in] reorder if not set, Morton re-ordering is
          *  skipped (but it means that mesh_reorder() was previously
          *  called else the algorithm will be pretty unefficient).
+         * \param[in] wide if set, the queries traverse the wide
+         *  layout of the tree (see set_wide_layout())
          * \pre M.facets.are_simplices()
          */
-        MeshFacetsAABBWithEps(Mesh& M, bool reorder = true);
+        MeshFacetsAABBWithEps(Mesh& M, bool reorder = true, bool wide = false);
+
+        /**
+         * \brief Selects the layout traversed by the distance queries.
+         * \details The binary layout is an implicit heap of boxes
+         *  traversed recursively. The wide layout groups the binary
+         *  nodes by WIDE_ARITY, stores the boxes of the children of a
+         *  node by coordinate so that they are tested at once, stops at
+         *  leaves of up to WIDE_LEAF_SIZE facets, and is traversed
+         *  front-to-back with an explicit stack. It is built on first
+         *  use. Both layouts give the same answers.
+         * \param[in] wide true for the wide layout, false for the
+         *  binary one
+         */
+        void set_wide_layout(bool wide);
+
+        /**
+         * \return true if the distance queries traverse the wide layout
+         */
+        bool is_wide_layout() const {
+            return wide_;
+        }
 
         /**
          * \brief Computes all the pairs of intersecting facets.
@@ -132,6 +155,12 @@ namespace GEO {
         ) const {
             index_t nearest_facet;
             get_nearest_facet_hint(p, nearest_facet, nearest_point, sq_dist);
+            if(wide_) {
+                wide_nearest_facet(
+                    p, -1.0, nearest_facet, nearest_point, sq_dist
+                );
+                return nearest_facet;
+            }
             nearest_facet_recursive(
                 p,
                 nearest_facet, nearest_point, sq_dist,
@@ -168,6 +197,12 @@ namespace GEO {
                     p, nearest_facet, nearest_point, sq_dist
                 );
             }
+            if(wide_) {
+                wide_nearest_facet(
+                    p, -1.0, nearest_facet, nearest_point, sq_dist
+                );
+                return;
+            }
             nearest_facet_recursive(
                 p,
                 nearest_facet, nearest_point, sq_dist,
@@ -184,6 +219,12 @@ namespace GEO {
         ) const {
             index_t nearest_facet;
             get_nearest_facet_hint(p, nearest_facet, nearest_point, sq_dist);
+            if(wide_) {
+                wide_nearest_facet(
+                    p, sq_epsilon, nearest_facet, nearest_point, sq_dist
+                );
+                return nearest_facet;
+            }
             facet_in_envelope_recursive(
                 p, sq_epsilon,
                 nearest_facet, nearest_point, sq_dist,
@@ -205,6 +246,12 @@ namespace GEO {
                     p, nearest_facet, nearest_point, sq_dist
                 );
             }
+            if(wide_) {
+                wide_nearest_facet(
+                    p, sq_epsilon, nearest_facet, nearest_point, sq_dist
+                );
+                return;
+            }
             facet_in_envelope_recursive(
                 p, sq_epsilon,
                 nearest_facet, nearest_point, sq_dist,
@@ -235,6 +282,57 @@ namespace GEO {
 	 */
 	bool segment_intersection(const vec3& q1, const vec3& q2) const;
 
+        /**
+         * \brief Maximum number of query points of points_in_envelope().
+         */
+        static const index_t PACKET_SIZE = 8;
+
+        /**
+         * \brief Number of children of a node of the wide layout.
+         */
+        static const index_t WIDE_ARITY = 4;
+
+        /**
+         * \brief Maximum number of facets in a leaf of the wide layout.
+         * \details With one facet, the nodes of the last level hold
+         *  WIDE_ARITY facets and their boxes, and a facet is only tested
+         *  if its own box is near enough.
+         */
+        static const index_t WIDE_LEAF_SIZE = 1;
+
+        /**
+         * \brief Work done by points_in_envelope(), added to by each call.
+         */
+        struct TraversalStats {
+            index_t nb_nodes = 0;      ///< nodes of the tree visited
+            index_t nb_facets = 0;     ///< facets tested against a packet
+            index_t nb_hint_hits = 0;  ///< points in the envelope of the hint facet
+        };
+
+        /**
+         * \brief Tests whether a packet of query points are all within
+         *  a given distance from the surface.
+         * \details Gives the same answer as calling
+         *  facet_in_envelope_with_hint() on each point, but the points
+         *  share a single traversal of the tree: a node is visited once
+         *  for all the points that can still reach it, and each leaf
+         *  facet is tested against all of them at once. It is meant for
+         *  coherent points, such as the samples of a triangle.
+         * \param[in] p the query points
+         * \param[in] nb the number of query points, at most PACKET_SIZE
+         * \param[in] sq_epsilon the squared envelope size
+         * \param[in,out] hint_facet a facet tested first for all the
+         *  points, or NO_FACET. On exit, a facet near the last point.
+         * \param[in,out] stats if not null, the work of the call is
+         *  added to it
+         * \return the index of the first point out of the envelope,
+         *  or \p nb if all the points are in
+         */
+        index_t points_in_envelope(
+            const vec3* p, index_t nb, double sq_epsilon,
+            index_t& hint_facet, TraversalStats* stats = nullptr
+        ) const;
+
     protected:
 
 
@@ -415,9 +513,83 @@ namespace GEO {
 	    const vec3& q1, const vec3& q2, index_t n, index_t b, index_t e
 	) const;
 
+        struct PointPacket;
+
+        /**
+         * \brief Tests a facet against all the points of a packet
+         *  that are not in the envelope yet.
+         * \param[in,out] P the packet
+         * \param[in] f index of the facet
+         */
+        void packet_facet_test(PointPacket& P, index_t f) const;
+
+        /**
+         * \brief The recursive function used by the implementation
+         *  of points_in_envelope().
+         * \param[in,out] P the packet
+         * \param[in] n index of the current node in the AABB tree
+         * \param[in] b index of the first facet in the subtree under node \p n
+         * \param[in] e one position past the index of the last facet in the
+         *  subtree under node \p n
+         */
+        void points_in_envelope_recursive(
+            PointPacket& P, index_t n, index_t b, index_t e
+        ) const;
+
+        /**
+         * \brief A node of the wide layout, that fits in two cache lines.
+         * \details The boxes of the children are stored by coordinate, in
+         *  single precision rounded outwards so that they still contain
+         *  the facets. A child is either another node (nb_facets is 0 and
+         *  first is its index), or a leaf with the facets
+         *  [first, first + nb_facets). The unused children have an empty
+         *  box, so that no query visits them.
+         */
+        struct WideNode {
+            float xyz_min[3][WIDE_ARITY];
+            float xyz_max[3][WIDE_ARITY];
+            index_t first[WIDE_ARITY];
+            Numeric::uint8 nb_facets[WIDE_ARITY];
+        };
+
+        /**
+         * \brief Creates the wide node that groups the binary subtrees
+         *  below a binary node, and recursively its children.
+         * \param[in] n index of the binary node
+         * \param[in] b index of the first facet in the subtree under node \p n
+         * \param[in] e one position past the index of the last facet in the
+         *  subtree under node \p n
+         * \return the index of the created node in wide_nodes_
+         */
+        index_t init_wide_node_recursive(index_t n, index_t b, index_t e);
+
+        /**
+         * \brief The traversal of the wide layout used by the
+         *  implementation of nearest_facet() and facet_in_envelope().
+         * \param[in] p query point
+         * \param[in] sq_epsilon stops as soon as a facet within this
+         *  squared distance is found, negative to find the nearest facet
+         * \param[in,out] nearest_facet the nearest facet so far
+         * \param[in,out] nearest_point a point in nearest_facet
+         * \param[in,out] sq_dist squared distance between p and nearest_point
+         */
+        void wide_nearest_facet(
+            const vec3& p, double sq_epsilon,
+            index_t& nearest_facet, vec3& nearest_point, double& sq_dist
+        ) const;
+
+        /**
+         * \brief The traversal of the wide layout used by the
+         *  implementation of points_in_envelope().
+         * \param[in,out] P the packet
+         */
+        void wide_points_in_envelope(PointPacket& P) const;
+
     protected:
         vector<Box> bboxes_;
         Mesh& mesh_;
+        bool wide_;
+        vector<WideNode> wide_nodes_;
     };
 
 }
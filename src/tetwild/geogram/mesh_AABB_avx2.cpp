@@ -0,0 +1,57 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+//compiled with -mavx2, only includes the headers of the kernels, see mesh_AABB_kernels.h
+#include <immintrin.h>
+
+namespace {
+    typedef __m256d vdouble;
+    const int VDOUBLE_WIDTH = 4;
+    inline vdouble vset1(double x) { return _mm256_set1_pd(x); }
+    inline vdouble vload(const double* p) { return _mm256_loadu_pd(p); }
+    inline vdouble vload(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    inline void vstore(double* p, vdouble x) { _mm256_storeu_pd(p, x); }
+    inline vdouble vadd(vdouble a, vdouble b) { return _mm256_add_pd(a, b); }
+    inline vdouble vsub(vdouble a, vdouble b) { return _mm256_sub_pd(a, b); }
+    inline vdouble vmul(vdouble a, vdouble b) { return _mm256_mul_pd(a, b); }
+    inline vdouble vmin(vdouble a, vdouble b) { return _mm256_min_pd(a, b); }
+    inline vdouble vmax(vdouble a, vdouble b) { return _mm256_max_pd(a, b); }
+    inline vdouble vlt(vdouble a, vdouble b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    inline vdouble vle(vdouble a, vdouble b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    inline vdouble vand(vdouble a, vdouble b) { return _mm256_and_pd(a, b); }
+    inline vdouble vselect(vdouble mask, vdouble a, vdouble b) { return _mm256_blendv_pd(b, a, mask); }
+}
+
+#include <tetwild/geogram/mesh_AABB_kernels.h>
+
+namespace GEO {
+
+    void packet_triangle_squared_distance_avx2(
+        const double* p1, const double* p2, const double* p3,
+        const double* x, const double* y, const double* z,
+        double* sq_dist, double* scale
+    ) {
+        packet_triangle_squared_distance_lanes(p1, p2, p3, x, y, z, sq_dist, scale);
+    }
+
+    void packet_box_squared_distance_avx2(
+        const double* xyz_min, const double* xyz_max,
+        const double* x, const double* y, const double* z,
+        double* sq_dist
+    ) {
+        packet_box_squared_distance_lanes(xyz_min, xyz_max, x, y, z, sq_dist);
+    }
+
+    void wide_box_squared_distance_avx2(
+        const float xyz_min[3][4], const float xyz_max[3][4],
+        const double* p, double* sq_dist, double* signed_sq_dist
+    ) {
+        wide_box_squared_distance_lanes(xyz_min, xyz_max, p, sq_dist, signed_sq_dist);
+    }
+}
@@ -0,0 +1,209 @@
+// This file is part of TetWild, a software for generating tetrahedral meshes.
+//
+// Copyright (C) 2018 Yixin Hu <yixin.hu@nyu.edu>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+//
+
+/*
+ * Distance kernels of the packet queries and of the wide nodes of
+ * MeshFacetsAABBWithEps, written once for the lanes of doubles vdouble
+ * of width VDOUBLE_WIDTH. The file that includes this one defines them
+ * before, in an unnamed namespace, with:
+ *   vset1, vload (of doubles and of floats), vstore,
+ *   vadd, vsub, vmul, vmin, vmax,
+ *   vlt, vle (masks), vand (of masks), vselect(mask, a, b).
+ * mesh_AABB.cpp includes it with the lanes of the build flags (SSE2 on
+ * x86_64) and mesh_AABB_avx2.cpp with the ones of AVX2, the kernel of
+ * the cpu is selected at runtime. The kernels only use arrays, so that
+ * the AVX2 file instantiates no inline function of geogram or of the
+ * standard library.
+ */
+
+#pragma once
+
+#include <cfloat>
+
+namespace GEO {
+
+    /**
+     * \brief The AVX2 kernels, see mesh_AABB_avx2.cpp.
+     * \details Same parameters as the lanes versions below.
+     */
+    void packet_triangle_squared_distance_avx2(
+        const double* p1, const double* p2, const double* p3,
+        const double* x, const double* y, const double* z,
+        double* sq_dist, double* scale
+    );
+    void packet_box_squared_distance_avx2(
+        const double* xyz_min, const double* xyz_max,
+        const double* x, const double* y, const double* z,
+        double* sq_dist
+    );
+    void wide_box_squared_distance_avx2(
+        const float xyz_min[3][4], const float xyz_max[3][4],
+        const double* p, double* sq_dist, double* signed_sq_dist
+    );
+}
+
+namespace {
+
+    /**
+     * \brief Number of points of a packet and number of children of
+     *  a wide node, MeshFacetsAABBWithEps::PACKET_SIZE and WIDE_ARITY.
+     */
+    const int KERNEL_PACKET_SIZE = 8;
+    const int KERNEL_WIDE_ARITY = 4;
+
+    /**
+     * \brief Computes the squared distances between a triangle and
+     *  a packet of points.
+     * \details The squared distance is the one to the supporting plane
+     *  if the projection falls inside the triangle, else the one to the
+     *  nearest edge. It may differ from Geom::point_triangle_squared_distance()
+     *  by a few ulps of \p scale.
+     * \param[in] p1 , p2 , p3 the three vertices of the triangle
+     * \param[in] x , y , z the coordinates of the points
+     * \param[out] sq_dist the squared distances
+     * \param[out] scale a bound of the magnitude of the terms in \p sq_dist
+     */
+    inline void packet_triangle_squared_distance_lanes(
+        const double* p1, const double* p2, const double* p3,
+        const double* x, const double* y, const double* z,
+        double* sq_dist, double* scale
+    ) {
+        const double* v[3] = { p1, p2, p3 };
+        double e[3][3];
+        for(int i = 0; i < 3; ++i) {
+            for(int c = 0; c < 3; ++c) {
+                e[i][c] = v[(i + 1) % 3][c] - v[i][c];
+            }
+        }
+        // n = cross(p2 - p1, p3 - p1)
+        double n[3] = {
+            e[0][1] * (p3[2] - p1[2]) - e[0][2] * (p3[1] - p1[1]),
+            e[0][2] * (p3[0] - p1[0]) - e[0][0] * (p3[2] - p1[2]),
+            e[0][0] * (p3[1] - p1[1]) - e[0][1] * (p3[0] - p1[0])
+        };
+        double nn = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+        // A degenerate triangle is the union of its edges
+        bool is_proper = nn > 0.0;
+
+        vdouble E[3][3];      // edges
+        vdouble inv_ee[3];    // inverse squared lengths of the edges
+        vdouble En[3][3];     // in-plane normals of the edges, pointing inside
+        vdouble V[3][3];      // vertices
+        double max_ee = 0.0;
+        for(int i = 0; i < 3; ++i) {
+            // en = cross(n, e)
+            double en[3] = {
+                n[1] * e[i][2] - n[2] * e[i][1],
+                n[2] * e[i][0] - n[0] * e[i][2],
+                n[0] * e[i][1] - n[1] * e[i][0]
+            };
+            double ee = e[i][0] * e[i][0] + e[i][1] * e[i][1] + e[i][2] * e[i][2];
+            max_ee = ee > max_ee ? ee : max_ee;
+            inv_ee[i] = vset1(ee > 0.0 ? 1.0 / ee : 0.0);
+            for(int c = 0; c < 3; ++c) {
+                E[i][c] = vset1(e[i][c]);
+                En[i][c] = vset1(en[c]);
+                V[i][c] = vset1(v[i][c]);
+            }
+        }
+        vdouble N[3] = { vset1(n[0]), vset1(n[1]), vset1(n[2]) };
+        vdouble inv_nn = vset1(is_proper ? 1.0 / nn : 0.0);
+        vdouble zero = vset1(0.0);
+        vdouble one = vset1(1.0);
+
+        for(int k = 0; k < KERNEL_PACKET_SIZE; k += VDOUBLE_WIDTH) {
+            vdouble P[3] = { vload(x + k), vload(y + k), vload(z + k) };
+            vdouble d_edges = vset1(DBL_MAX);
+            vdouble inside = vle(zero, zero);
+            for(int i = 0; i < 3; ++i) {
+                vdouble px = vsub(P[0], V[i][0]);
+                vdouble py = vsub(P[1], V[i][1]);
+                vdouble pz = vsub(P[2], V[i][2]);
+                vdouble t = vmul(
+                    vadd(vadd(vmul(px, E[i][0]), vmul(py, E[i][1])), vmul(pz, E[i][2])),
+                    inv_ee[i]
+                );
+                t = vmin(vmax(t, zero), one);
+                vdouble dx = vsub(px, vmul(t, E[i][0]));
+                vdouble dy = vsub(py, vmul(t, E[i][1]));
+                vdouble dz = vsub(pz, vmul(t, E[i][2]));
+                d_edges = vmin(d_edges, vadd(vadd(vmul(dx, dx), vmul(dy, dy)), vmul(dz, dz)));
+                vdouble side = vadd(vadd(vmul(px, En[i][0]), vmul(py, En[i][1])), vmul(pz, En[i][2]));
+                inside = vand(inside, vle(zero, side));
+            }
+            vdouble px = vsub(P[0], V[0][0]);
+            vdouble py = vsub(P[1], V[0][1]);
+            vdouble pz = vsub(P[2], V[0][2]);
+            vdouble h = vadd(vadd(vmul(px, N[0]), vmul(py, N[1])), vmul(pz, N[2]));
+            vdouble d = is_proper ? vselect(inside, vmul(vmul(h, h), inv_nn), d_edges) : d_edges;
+            vstore(sq_dist + k, d);
+            vstore(scale + k, vadd(vadd(vadd(vmul(px, px), vmul(py, py)), vmul(pz, pz)), vset1(max_ee)));
+        }
+    }
+
+    /**
+     * \brief Computes the squared distances between a box and a packet
+     *  of points, zero for the points inside the box.
+     * \param[in] xyz_min , xyz_max the corners of the box
+     * \param[in] x , y , z the coordinates of the points
+     * \param[out] sq_dist the squared distances
+     */
+    inline void packet_box_squared_distance_lanes(
+        const double* xyz_min, const double* xyz_max,
+        const double* x, const double* y, const double* z,
+        double* sq_dist
+    ) {
+        vdouble zero = vset1(0.0);
+        vdouble B_min[3] = { vset1(xyz_min[0]), vset1(xyz_min[1]), vset1(xyz_min[2]) };
+        vdouble B_max[3] = { vset1(xyz_max[0]), vset1(xyz_max[1]), vset1(xyz_max[2]) };
+        for(int k = 0; k < KERNEL_PACKET_SIZE; k += VDOUBLE_WIDTH) {
+            vdouble P[3] = { vload(x + k), vload(y + k), vload(z + k) };
+            vdouble result = zero;
+            for(int c = 0; c < 3; ++c) {
+                vdouble d = vmax(vmax(vsub(B_min[c], P[c]), vsub(P[c], B_max[c])), zero);
+                result = vadd(result, vmul(d, d));
+            }
+            vstore(sq_dist + k, result);
+        }
+    }
+
+    /**
+     * \brief Computes the squared distances between a point and the
+     *  boxes of the children of a node of the wide layout, zero for
+     *  the boxes that contain the point.
+     * \param[in] xyz_min , xyz_max the boxes, stored by coordinate
+     * \param[in] p the point
+     * \param[out] sq_dist the squared distances
+     * \param[out] signed_sq_dist the squared distances, with negative
+     *  sign and to the nearest side for the boxes that contain the point
+     */
+    inline void wide_box_squared_distance_lanes(
+        const float xyz_min[3][KERNEL_WIDE_ARITY],
+        const float xyz_max[3][KERNEL_WIDE_ARITY],
+        const double* p, double* sq_dist, double* signed_sq_dist
+    ) {
+        vdouble zero = vset1(0.0);
+        vdouble P[3] = { vset1(p[0]), vset1(p[1]), vset1(p[2]) };
+        for(int i = 0; i < KERNEL_WIDE_ARITY; i += VDOUBLE_WIDTH) {
+            vdouble result = zero;
+            vdouble inner = vset1(DBL_MAX);
+            for(int c = 0; c < 3; ++c) {
+                vdouble d_min = vsub(vload(xyz_min[c] + i), P[c]);
+                vdouble d_max = vsub(P[c], vload(xyz_max[c] + i));
+                vdouble d = vmax(vmax(d_min, d_max), zero);
+                result = vadd(result, vmul(d, d));
+                inner = vmin(inner, vmin(vsub(zero, d_min), vsub(zero, d_max)));
+            }
+            vstore(sq_dist + i, result);
+            // Same as point_box_signed_squared_distance() inside the box
+            vdouble is_outside = vlt(zero, result);
+            vstore(signed_sq_dist + i, vselect(is_outside, result, vsub(zero, vmul(inner, inner))));
+        }
+    }
+}
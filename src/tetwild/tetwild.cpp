@@ -13,6 +13,7 @@
 #include <tetwild/Common.h>
 #include <tetwild/ProgressHandler.h>
 #include <tetwild/Preprocess.h>
+#include <tetwild/EnvelopeGrid.h>
 #include <tetwild/DelaunayTetrahedralization.h>
 #include <tetwild/BSPSubdivision.h>
 #include <tetwild/SimpleTetrahedralization.h>
@@ -28,7 +29,7 @@ namespace tetwild {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void printFinalQuality(double time, const std::vector<TetVertex>& tet_vertices,
+void printFinalQuality(double time, const TetVertexStore& vertex_store,
                        const std::vector<std::array<int, 4>>& tets,
                        const std::vector<bool> &t_is_removed,
                        const std::vector<TetQuality>& tet_qualities,
@@ -81,7 +82,7 @@ void printFinalQuality(double time, const std::vector<TetVertex>& tet_vertices,
     // output unrounded vertices:
     cnt = 0;
     for (int v_id: v_ids) {
-        if (!tet_vertices[v_id].is_rounded) {
+        if (!vertex_store.is(v_id, TetVertexStore::ROUNDED)) {
             cnt++;
         }
     }
@@ -106,19 +107,18 @@ void extractFinalTetmesh(MeshRefinement& MR,
     Eigen::MatrixXd &V_out, Eigen::MatrixXi &T_out, Eigen::VectorXd &A_out,
     const Args &args, const State &state)
 {
-    std::vector<TetVertex> &tet_vertices = MR.tet_vertices;
+    TetVertexStore &vertex_store = MR.vertex_store;
     std::vector<std::array<int, 4>> &tets = MR.tets;
     std::vector<bool> &v_is_removed = MR.v_is_removed;
     std::vector<bool> &t_is_removed = MR.t_is_removed;
     std::vector<TetQuality> &tet_qualities = MR.tet_qualities;
-    int t_cnt = std::count(t_is_removed.begin(), t_is_removed.end(), false);
+    int t_cnt = MR.t_slots.liveCount();
     double tmp_time = 0;
     if (!args.smooth_open_boundary) {
-        InoutFiltering IOF(tet_vertices, tets, MR.is_surface_fs, v_is_removed, t_is_removed, tet_qualities, state);
+        InoutFiltering IOF(vertex_store, tets, MR.is_surface_fs, MR.surface_index, v_is_removed, t_is_removed, tet_qualities, state);
         igl::Timer igl_timer;
         igl_timer.start();
-        IOF.filter();
-        t_cnt = std::count(t_is_removed.begin(), t_is_removed.end(), false);
+        t_cnt = IOF.filter();
         tmp_time = igl_timer.getElapsedTime();
 
         ProgressHandler::Info("time = {}s", tmp_time);
@@ -144,7 +144,7 @@ void extractFinalTetmesh(MeshRefinement& MR,
     A_out.resize(t_cnt);
     for (int i = 0; i < v_ids.size(); i++) {
         for (int j = 0; j < 3; j++) {
-            V_out(i, + j) = tet_vertices[v_ids[i]].posf[j];
+            V_out(i, + j) = vertex_store.ptr(v_ids[i])[j];
         }
     }
     int cnt = 0;
@@ -164,7 +164,7 @@ void extractFinalTetmesh(MeshRefinement& MR,
     if (args.is_quiet) {
         return;
     }
-    printFinalQuality(tmp_time, tet_vertices, tets, t_is_removed, tet_qualities, v_ids, args, state);
+    printFinalQuality(tmp_time, vertex_store, tets, t_is_removed, tet_qualities, v_ids, args, state);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -177,6 +177,7 @@ double tetwild_stage_one_preprocess(
     State &state,
     GEO::Mesh &geo_sf_mesh,
     GEO::Mesh &geo_b_mesh,
+    EnvelopeGrid &envelope_grid,
     std::vector<Point_3> &m_vertices,
     std::vector<std::array<int, 3>> &m_faces)
 {
@@ -185,7 +186,7 @@ double tetwild_stage_one_preprocess(
     ProgressHandler::SetProgress(1.0f);
     ProgressHandler::Info("Preprocessing...");
     Preprocess pp(state);
-    if (!pp.init(VI, FI, geo_b_mesh, geo_sf_mesh, args)) {
+    if (!pp.init(VI, FI, geo_b_mesh, geo_sf_mesh, envelope_grid, args)) {
         //todo: output a empty tetmesh
         PyMesh::MshSaver mSaver(state.working_dir + state.postfix + ".msh", true);
         Eigen::VectorXd oV;
@@ -313,6 +314,7 @@ double tetwild_stage_one_tetra(
     const std::vector<int> &raw_e_tags,
     const std::vector<std::vector<int>> &raw_conn_e4v,
     std::vector<TetVertex> &tet_vertices,
+    TetVertexStore &vertex_store,
     std::vector<std::array<int, 4>> &tet_indices,
     std::vector<std::array<int, 4>> &is_surface_facet)
 {
@@ -321,13 +323,14 @@ double tetwild_stage_one_tetra(
     ProgressHandler::Info("Tetrehedralizing ...");
     SimpleTetrahedralization ST(state, MC);
     tet_vertices.clear();
+    vertex_store.clear();
     tet_indices.clear();
     is_surface_facet.clear();
-    ST.tetra(tet_vertices, tet_indices);
-    ST.labelSurface(m_f_tags, raw_e_tags, raw_conn_e4v, tet_vertices, tet_indices, is_surface_facet);
-    ST.labelBbox(tet_vertices, tet_indices);
+    ST.tetra(tet_vertices, vertex_store, tet_indices);
+    ST.labelSurface(m_f_tags, raw_e_tags, raw_conn_e4v, tet_vertices, vertex_store, tet_indices, is_surface_facet);
+    ST.labelBbox(tet_vertices, vertex_store, tet_indices);
     if (!state.is_mesh_closed)//if input is an open mesh
-        ST.labelBoundary(tet_vertices, tet_indices, is_surface_facet);
+        ST.labelBoundary(tet_vertices, vertex_store, tet_indices, is_surface_facet);
     ProgressHandler::Debug("# tet_vertices = {}", tet_vertices.size());
     ProgressHandler::Debug("# tets = {}", tet_indices.size());
     ProgressHandler::Info("Tetrahedralization done!");
@@ -346,7 +349,9 @@ void tetwild_stage_one(
     State &state,
     GEO::Mesh &geo_sf_mesh,
     GEO::Mesh &geo_b_mesh,
+    EnvelopeGrid &envelope_grid,
     std::vector<TetVertex> &tet_vertices,
+    TetVertexStore &vertex_store,
     std::vector<std::array<int, 4>> &tet_indices,
     std::vector<std::array<int, 4>> &is_surface_facet)
 {
@@ -357,7 +362,7 @@ void tetwild_stage_one(
     //preprocess
     std::vector<Point_3> m_vertices;
     std::vector<std::array<int, 3>> m_faces;
-    sum_time += tetwild_stage_one_preprocess(VI, FI, args, state, geo_sf_mesh, geo_b_mesh, m_vertices, m_faces);
+    sum_time += tetwild_stage_one_preprocess(VI, FI, args, state, geo_sf_mesh, geo_b_mesh, envelope_grid, m_vertices, m_faces);
 
     //delaunay tetrahedralization
     std::vector<Point_3> bsp_vertices;
@@ -382,7 +387,7 @@ void tetwild_stage_one(
     ProgressHandler::SetProgress(45.0f);
     //simple tetrahedralization
     sum_time += tetwild_stage_one_tetra(args, state, MC, m_f_tags, raw_e_tags, raw_conn_e4v,
-        tet_vertices, tet_indices, is_surface_facet);
+        tet_vertices, vertex_store, tet_indices, is_surface_facet);
 
     ProgressHandler::SetProgress(50.0f);
     ProgressHandler::Info("Total time for the first stage = {}s", sum_time);
@@ -393,7 +398,9 @@ void tetwild_stage_one(
 void tetwild_stage_two(const Args &args, State &state,
     GEO::Mesh &geo_sf_mesh,
     GEO::Mesh &geo_b_mesh,
+    const EnvelopeGrid &envelope_grid,
     std::vector<TetVertex> &tet_vertices,
+    TetVertexStore &vertex_store,
     std::vector<std::array<int, 4>> &tet_indices,
     std::vector<std::array<int, 4>> &is_surface_facet,
     Eigen::MatrixXd &VO,
@@ -403,8 +410,9 @@ void tetwild_stage_two(const Args &args, State &state,
     //init
     ProgressHandler::SetProgress(51.0f);
     ProgressHandler::Info("Refinement initializing...");
-    MeshRefinement MR(geo_sf_mesh, geo_b_mesh, args, state);
+    MeshRefinement MR(geo_sf_mesh, geo_b_mesh, envelope_grid, args, state);
     MR.tet_vertices = std::move(tet_vertices);
+    MR.vertex_store = std::move(vertex_store);
     MR.tets = std::move(tet_indices);
     MR.is_surface_fs = std::move(is_surface_facet);
     MR.prepareData();
@@ -432,17 +440,19 @@ void tetrahedralization(const Eigen::MatrixXd &VI, const Eigen::MatrixXi &FI,
     State state(args, VI);
     GEO::Mesh geo_sf_mesh;
     GEO::Mesh geo_b_mesh;
+    EnvelopeGrid envelope_grid;
     std::vector<TetVertex> tet_vertices;
+    TetVertexStore vertex_store;
     std::vector<std::array<int, 4>> tet_indices;
     std::vector<std::array<int, 4>> is_surface_facet;
 
     /// STAGE 1
-    tetwild_stage_one(VI, FI, args, state, geo_sf_mesh, geo_b_mesh,
-        tet_vertices, tet_indices, is_surface_facet);
+    tetwild_stage_one(VI, FI, args, state, geo_sf_mesh, geo_b_mesh, envelope_grid,
+        tet_vertices, vertex_store, tet_indices, is_surface_facet);
 
     /// STAGE 2
-    tetwild_stage_two(args, state, geo_sf_mesh, geo_b_mesh,
-        tet_vertices, tet_indices, is_surface_facet, VO, TO, AO);
+    tetwild_stage_two(args, state, geo_sf_mesh, geo_b_mesh, envelope_grid,
+        tet_vertices, vertex_store, tet_indices, is_surface_facet, VO, TO, AO);
 
     double total_time = igl_timer.getElapsedTime();
     ProgressHandler::Info("Total time for all stages = {}s", total_time);